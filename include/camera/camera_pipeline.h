@@ -4,12 +4,18 @@
  * Zero-copy preview via DMA-BUF + full-resolution JPEG capture
  */
 
+#include "camera/stabilizer.h"
+
 #include <cstdint>
 #include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <memory>
 #include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 namespace libcamera {
     class CameraManager;
@@ -24,9 +30,43 @@ namespace libcamera {
 namespace cinepi {
 
 class DrmDisplay;
+class EventLoop;
+
+// Per-frame metadata from libcamera.  sensor_ts_ns is SensorTimestamp
+// (CLOCK_BOOTTIME, start of exposure), matching the sensor sample rings.
+struct FrameTiming {
+    uint64_t sensor_ts_ns = 0;
+    uint32_t exposure_us = 0;
+    uint32_t frame_duration_us = 0;
+    uint32_t sequence = 0;
+};
 
 using CaptureCallback = std::function<void(const std::string& path, bool success)>;
 using FrameCallback = std::function<void(int dmabuf_fd, int width, int height, int stride, uint32_t format)>;
+// Shake-aware capture: rather than the next frame, wait up to max_wait_us
+// for one whose peak angular rate during exposure is at most max_dps, else
+// take the stillest frame seen.  shake() returns a frame's peak rate (deg/s,
+// <0 unknown) and whether the gyro history covers its whole exposure yet.
+struct SteadyCapture {
+    uint32_t max_wait_us = 0;     // 0: next frame
+    float max_dps = 0.0f;
+    std::function<float(const FrameTiming& t, bool* covered)> shake;
+};
+
+// How the last capture picked its frame
+struct CaptureSelection {
+    FrameTiming first;            // the frame a plain capture would have used
+    int frames = 0;               // frames considered
+    bool still = false;           // met max_dps; otherwise stillest on timeout
+    uint64_t flash_start_ns = 0;  // predicted exposure start the flash was aimed at (0 = none)
+};
+
+// Lights the flash over [on_ns, off_ns) (CLOCK_BOOTTIME); false if it
+// cannot be scheduled.  Called from the presenter thread.
+using FlashTrigger = std::function<bool(uint64_t on_ns, uint64_t off_ns)>;
+
+// Newest gyro sample with its rate averaged over window_ns
+using MotionSource = std::function<bool(uint64_t window_ns, GyroSample* out)>;
 
 class CameraPipeline {
 public:
@@ -46,18 +86,84 @@ public:
     void set_shutter(int us);
     void set_white_balance(int mode);
     void set_digital_zoom(float factor);  // 1.0 - 4.0
-
-    // Full-res capture
-    void capture_photo(const std::string& output_path, CaptureCallback cb);
+    float digital_zoom() const { return zoom_.load(); }
+
+    // Standby: cap the preview rate through FrameDurationLimits (0 = normal).
+    // Lands as the queued requests come back, CAMERA_BUF_COUNT frames on.
+    void set_frame_rate_limit(int fps) { fps_limit_ = fps; }
+    // Gyro stabilisation: every re-queued request gets a ScalerCrop shifted
+    // against the motion reported by motion().  Call before start_preview().
+    void set_stabilization(bool enabled, MotionSource motion);
+
+    // Full-res capture.  The next preview frame is copied and JPEG-encoded
+    // on the "encoder" thread; cb runs on the event loop if one is set.
+    // pressed_us (CLOCK_MONOTONIC) is the latency origin; 0 = now.
+    // With flash, the pulse is aimed at a later frame's predicted exposure
+    // window and that frame is the one captured (steady is ignored).
+    void capture_photo(const std::string& output_path, CaptureCallback cb,
+                       SteadyCapture steady = SteadyCapture(), uint64_t pressed_us = 0,
+                       bool flash = false);
+    void set_flash_trigger(FlashTrigger fire) { flash_fire_ = std::move(fire); }
+
+    // Two-stage shutter.  Half-press: lock AE/AWB at the current values,
+    // create and pre-allocate output_path, and prime the frame copy buffer
+    // and the JPEG encoder, so a capture_photo() to the same path only has
+    // to select the frame and write it.  release_capture() on half-press
+    // release unlocks AE/AWB and removes a prepared file left unused.
+    bool prepare_capture(const std::string& output_path);
+    void release_capture();
+    void set_event_loop(EventLoop* loop) { loop_ = loop; }
 
     // DMA-BUF frame callback for DRM display
     void set_frame_callback(FrameCallback cb);
 
+    // eventfd signalled once per completed preview frame (counter = frames).
+    // Lets the main event loop observe camera progress without polling.
+    int frame_event_fd() const { return frame_efd_; }
+
     std::string get_sensor_name() const;
 
+    // Timing of the newest preview frame, and of the frame the last
+    // capture_photo() was taken from.
+    FrameTiming last_frame_timing() const;
+    FrameTiming last_capture_timing() const;
+    CaptureSelection last_capture_selection() const;
+
+    // Memory held: libcamera preview DMA-BUFs, and frames copied for the
+    // JPEG encoder (queued + in progress).
+    uint64_t dmabuf_bytes() const { return dmabuf_bytes_; }
+    uint64_t encoder_bytes() const { return encoder_bytes_.load(); }
+
 private:
+    struct EncodeJob {
+        std::vector<uint8_t> pixels;
+        int width = 0, height = 0, stride = 0;
+        std::string path;
+        CaptureCallback cb;
+        uint64_t requested_us = 0;
+        int fd = -1;                // pre-allocated at half-press
+        bool prepared = false;      // two-stage capture
+        bool prime = false;         // no frame: set up the encoder only
+    };
+
+    struct Candidate {
+        std::vector<uint8_t> pixels;
+        FrameTiming timing;
+        float dps = -1.0f;
+    };
+
     void request_complete(libcamera::Request* request);
-    void configure_controls();
+    void configure_controls(libcamera::Request* request, const FrameTiming& timing);
+    void measure_residual(const libcamera::FrameBuffer* buffer);
+    void unmap_preview();
+    void queue_capture(const libcamera::FrameBuffer* buffer, const FrameTiming& timing);
+    bool flash_frame(const FrameTiming& timing);
+    bool copy_frame(const libcamera::FrameBuffer* buffer, std::vector<uint8_t>* out);
+    void drop(Candidate& c);
+    void submit_capture(Candidate c);
+    void fail_capture(std::unique_lock<std::mutex>& lk);
+    void discard_prepared();
+    void encoder_thread();
 
     std::unique_ptr<libcamera::CameraManager> cm_;
     std::shared_ptr<libcamera::Camera> camera_;
@@ -71,16 +177,66 @@ private:
     bool capturing_ = false;
     std::string capture_path_;
     CaptureCallback capture_cb_;
+    uint64_t capture_requested_us_ = 0;
+    uint64_t capture_pressed_us_ = 0;
+    bool capture_flash_ = false;
+    FlashTrigger flash_fire_;
+    int capture_fd_ = -1;               // prepared file this capture writes
+    bool capture_prepared_ = false;
+    std::string prepared_path_;         // half-press state
+    int prepared_fd_ = -1;
+    std::vector<uint8_t> prepared_pixels_;
+    SteadyCapture steady_;
+    CaptureSelection selection_;
+    std::deque<Candidate> pending_;     // copied, waiting for gyro coverage
+    Candidate best_;                    // stillest scored so far
+    uint64_t last_frame_us_ = 0;
     FrameCallback frame_cb_;
 
+    mutable std::mutex timing_mtx_;
+    FrameTiming frame_timing_;
+    FrameTiming capture_timing_;
+    CaptureSelection capture_selection_;
+
     // Current settings
     int iso_ = 100;
     int shutter_us_ = 8333;
     int wb_mode_ = 0;
-    float zoom_ = 1.0f;
+    std::atomic<float> zoom_{1.0f};
+
+    // AE/AWB lock: set by prepare/release, applied on the presenter thread
+    std::atomic<bool> ae_lock_{false};
+    int ae_lock_applied_ = -1;      // presenter thread, -1 = resend
+    float last_gain_ = 1.0f;
+    float last_colour_gains_[2] = {0.0f, 0.0f};
+
+    std::atomic<int> fps_limit_{0};
+    int fps_limit_applied_ = -1;    // presenter thread, -1 = resend
+
+    // EIS state, presenter thread only once streaming
+    bool eis_enabled_ = false;
+    MotionSource motion_;
+    Stabilizer eis_;
+    uint64_t last_sensor_ts_ns_ = 0;
+    uint64_t sensor_interval_ns_ = 0;
+    struct PlaneMap { int fd; void* addr; size_t len; };
+    std::vector<PlaneMap> preview_maps_;   // read-only, for residual jitter
 
     // DRM fourcc of the actual post-validate pixel format (set during init()).
     uint32_t preview_fourcc_ = 0;
+
+    int frame_efd_ = -1;
+
+    // JPEG encoder worker
+    EventLoop* loop_ = nullptr;
+    std::thread encoder_;
+    std::mutex enc_mtx_;
+    std::condition_variable enc_cv_;
+    std::deque<EncodeJob> enc_jobs_;
+    bool enc_stop_ = false;
+
+    uint64_t dmabuf_bytes_ = 0;
+    std::atomic<uint64_t> encoder_bytes_{0};
 };
 
 } // namespace cinepi
@@ -24,9 +24,19 @@ public:
     PhotoCapture();
     ~PhotoCapture();
 
-    // Encode raw buffer to JPEG file
+    // Encode raw buffer to JPEG file.  With fd >= 0 (from preallocate())
+    // the JPEG goes there instead; the file is trimmed to size and closed.
     static bool encode_jpeg(const uint8_t* rgb_data, int width, int height,
-                            int stride, int quality, const std::string& output_path);
+                            int stride, int quality, const std::string& output_path,
+                            int fd = -1);
+
+    // Set up the calling thread's compressor and output buffer for a
+    // width x height frame, so the next encode on it allocates nothing
+    static void prime_encoder(int width, int height);
+
+    // Create output_path (must not exist) with JPEG_PREALLOC_BYTES
+    // reserved; fd or -1
+    static int preallocate(const std::string& output_path);
 
     // Determine if flash should fire
     static bool should_flash(const CaptureParams& params);
@@ -0,0 +1,61 @@
+#pragma once
+/**
+ * CinePi Camera - Electronic Image Stabilisation
+ * Gives up EIS_MARGIN_PCT of the ScalerCrop window and shifts what is left
+ * against gyro-measured yaw/pitch.  Motion slower than EIS_FOLLOW_HZ is
+ * followed (pans).  A crop set now lands several frames later, so the shake
+ * is predicted to that frame's exposure as a sinusoid at the dominant
+ * frequency estimated from the gyro; once that horizon exceeds half a
+ * period the prediction is worthless and the correction backs off to zero.
+ * Roll cannot be undone by a translation and is left alone.
+ *
+ * Residual jitter is measured on the preview stream itself from
+ * frame-to-frame shifts of the row/column intensity profiles.
+ */
+
+#include "drivers/sensor_ring.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace cinepi {
+
+struct CropRect {
+    int x = 0, y = 0, w = 0, h = 0;
+};
+
+class Stabilizer {
+public:
+    // Crop for a request whose frame is mid-exposure at target_ns.
+    // g is the newest gyro sample; base is the zoom crop on the sensor.
+    CropRect crop(const CropRect& base, const GyroSample& g, uint64_t target_ns);
+
+    // Margin-reduced base crop with no correction (no gyro data yet).
+    static CropRect centred(const CropRect& base);
+
+    // Feed one packed RGB/XRGB preview frame (bpp 3 or 4, green at byte 1);
+    // updates the residual jitter estimate.
+    void measure(const uint8_t* px, int width, int height, int stride, int bpp);
+    float residual_px() const { return residual_px_; }
+
+    void reset();
+
+private:
+    struct Axis {
+        float s1 = 0, s2 = 0;       // double exponential smoothing: intended path
+        float rate_lp = 0;
+        float prev_rate_hp = 0;
+        float var_angle = 0, var_rate = 0, var_accel = 0;   // of the shake part
+        float shake(float angle, float rate, float alpha, float dt, float horizon);
+    };
+
+    Axis axis_[2];              // yaw -> x, pitch -> y
+    uint64_t last_target_ns_ = 0;
+
+    std::vector<int32_t> cols_, rows_, prev_cols_, prev_rows_;
+    float shift_mean_[2] = {};
+    float jitter_sq_ = 0.0f;
+    float residual_px_ = 0.0f;
+};
+
+} // namespace cinepi
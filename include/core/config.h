@@ -6,6 +6,7 @@
 
 #include <string>
 #include <mutex>
+#include <vector>
 #include <cstdint>
 
 namespace cinepi {
@@ -16,19 +17,49 @@ struct CameraSettings {
     int wb_mode       = 0;        // 0=Auto,1=Daylight,2=Cloudy,3=Tungsten
     bool grid_overlay = false;
     bool digital_level = false;
+    bool eis           = false;   // gyro stabilisation via ScalerCrop
     int flash_mode    = 0;        // 0=OFF, 1=ON, 2=AUTO
+    int steady_wait_ms = 0;       // shake-aware shutter: max delay, 0 = off
+    float steady_max_dps = 3.0f;  // still enough to fire
     float colour_temp = 0.5f;     // 0.0-1.0 normalized
 };
 
 struct DisplaySettings {
     int brightness     = 128;     // 0-255
+    bool auto_brightness = false; // scale brightness with BH1750 lux
     int standby_sec    = 10;      // 10,30,60,0(never)
     bool show_clock    = true;    // show clock/status overlay
 };
 
+struct DebugSettings {
+    bool trace            = false;  // record TRACE_SCOPE points from startup
+    int  trace_window_sec = 10;     // span written by the SIGUSR1 dump
+};
+
+// Scheduling plan for one named thread (see core/thread_registry.h).
+// `name` matches a thread name exactly or as a prefix ("encoder" → "encoder-1").
+struct ThreadPlanEntry {
+    std::string name;
+    uint32_t cpu_mask = 0;        // bit N = core N, 0 = not pinned
+    bool realtime     = false;    // SCHED_FIFO instead of SCHED_OTHER
+    int priority      = 0;        // FIFO priority (1-99), else nice value
+};
+
 struct AppConfig {
     CameraSettings camera;
     DisplaySettings display;
+    DebugSettings debug;
+    // Pi 3A+ default: frame presentation owns core 0, UI core 1,
+    // JPEG encoding runs on cores 2-3 behind everything else.  The GPIO
+    // output thread sleeps between flash/haptic edges and preempts all.
+    // I2C polling mostly waits on the bus; FIFO keeps its drains on time.
+    std::vector<ThreadPlanEntry> threads = {
+        {"presenter", 0x1, true,  20},
+        {"gpio-out",  0x1, true,  30},
+        {"ui",        0x2, false, -5},
+        {"i2c",       0xC, true,  10},
+        {"encoder",   0xC, false,  5},
+    };
     std::string photo_dir   = "/home/pi/photos";
     std::string config_path = "/home/pi/.cinepi_config.json";
     std::string version     = "1.0.0";
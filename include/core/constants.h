@@ -21,6 +21,9 @@ namespace cinepi {
 constexpr int DISPLAY_W         = 480;   // Portrait width  (matches LVGL canvas)
 constexpr int DISPLAY_H         = 800;   // Portrait height (matches LVGL canvas)
 constexpr int UI_BPP            = 32;    // ARGB8888 for overlay plane
+constexpr const char* SPLASH_RAW_PATH = "/home/pi/cinepi_app/assets/boot_logo.raw";  // scripts/png_to_raw.py
+constexpr int SPLASH_FADE_MS    = 400;   // splash → live preview cross-fade
+constexpr const char* ASSET_PACK_PATH = "/home/pi/cinepi_app/assets/ui_assets.pack";  // scripts/pack_assets.py
 
 // ─── Camera ─────────────────────────────────────────────────────────
 constexpr int PREVIEW_W         = 640;   // Sensor landscape output width
@@ -29,6 +32,14 @@ constexpr int PREVIEW_FPS       = 30;
 constexpr int CAPTURE_W         = 3280;
 constexpr int CAPTURE_H         = 2464;
 constexpr int CAMERA_BUF_COUNT  = 4;
+constexpr int CAMERA_MAX_FRAME_US = 250000;  // AE may stretch frames this far in the dark
+constexpr float CAMERA_HFOV_DEG = 62.2f; // IMX219 full-array horizontal field of view
+constexpr int EIS_MARGIN_PCT    = 10;    // crop width/height given up to stabilization
+constexpr float EIS_FOLLOW_HZ   = 1.0f;  // slower motion is treated as intentional
+constexpr int STEADY_PENDING_MAX = 4;    // frames held for scoring by the shake-aware shutter
+constexpr int FLASH_LEAD_US      = 3000;  // earliest a flash pulse is scheduled ahead of its edge
+constexpr int FLASH_PRE_US       = 300;   // LED on before the first row starts exposing
+constexpr int FLASH_MAX_ON_US    = 150000;  // LED thermal limit per pulse
 
 // ─── GPIO (BCM numbering) ──────────────────────────────────────────
 constexpr int GPIO_ENCODER_CLK  = 5;
@@ -36,17 +47,48 @@ constexpr int GPIO_ENCODER_DT   = 6;
 constexpr int GPIO_ENCODER_BTN  = 13;
 constexpr int GPIO_VIBRATION    = 18;
 constexpr int GPIO_SHUTTER_BTN  = 26;
+constexpr int GPIO_SHUTTER_HALF = 16;    // two-stage shutter, first contact (unwired = never held)
 constexpr int GPIO_LED_FLASH    = 27;
 constexpr const char* GPIO_CHIP = "/dev/gpiochip0";
+constexpr int GPIO_BUTTON_DEBOUNCE_US  = 10000;  // kernel (gpiolib) debounce
+constexpr int GPIO_ENCODER_DEBOUNCE_US = 1000;   // detents are ~5 ms apart spun fast
+constexpr float ENCODER_ACCEL_MIN_HZ    = 8.0f;   // detents/s below which 1 detent = 1 step
+constexpr float ENCODER_ACCEL_MAX_HZ    = 40.0f;  // full acceleration from here
+constexpr int   ENCODER_ACCEL_MAX_STEPS = 10;     // steps per detent at full speed
+constexpr float ENCODER_ZOOM_STEP       = 0.05f;  // digital zoom per step (1.0 - 4.0)
 
 // ─── I2C ────────────────────────────────────────────────────────────
 constexpr const char* I2C_DEV   = "/dev/i2c-1";
 constexpr uint8_t I2C_ADDR_GYRO  = 0x69;  // L3G4200D
+constexpr uint8_t I2C_ADDR_LSM6DS3 = 0x6A;  // or 0x6B (SA0 high)
+constexpr uint8_t I2C_ADDR_MPU6050 = 0x68;  // or 0x69 (AD0 high)
 constexpr uint8_t I2C_ADDR_LIGHT = 0x23;  // BH1750
 
 // ─── Backlight ──────────────────────────────────────────────────────
 constexpr const char* BACKLIGHT_BRIGHTNESS = "/sys/class/backlight/rpi_backlight/brightness";
 constexpr const char* BACKLIGHT_POWER      = "/sys/class/backlight/rpi_backlight/bl_power";
+constexpr const char* BACKLIGHT_MAX        = "/sys/class/backlight/rpi_backlight/max_brightness";
+constexpr int BACKLIGHT_MIN_LEVEL     = 10;     // lowest user/auto level (0-255)
+constexpr int BACKLIGHT_FADE_MS       = 150;    // slider changes
+constexpr int BACKLIGHT_WAKE_FADE_MS  = 300;    // unblank
+constexpr int BACKLIGHT_AUTO_FADE_MS  = 2000;   // ambient tracking
+constexpr int BACKLIGHT_TICK_MS       = 16;
+
+// ─── Standby ────────────────────────────────────────────────────────
+// Tiers follow display.standby_sec; the offsets below count from there
+constexpr int STANDBY_DIM_LEVEL      = 24;    // backlight while dimmed (0-255)
+constexpr int STANDBY_UI_PAUSE_SEC   = 5;     // then LVGL paused
+constexpr int STANDBY_CAMERA_LOW_SEC = 20;    // then panel off, preview at STANDBY_LOW_FPS
+constexpr int STANDBY_STOP_SEC       = 120;   // then camera stopped
+constexpr int STANDBY_LOW_FPS        = 5;
+constexpr float STANDBY_MOTION_DEG   = 5.0f;  // gyro movement that keeps the camera warm
+
+// ─── Telemetry ──────────────────────────────────────────────────────
+constexpr const char* METRICS_SOCKET = "/tmp/cinepi-metrics.sock";  // Prometheus text
+constexpr const char* TRACE_DUMP_DIR = "/tmp";                      // SIGUSR1 trace dumps
+constexpr const char* JANK_LOG_PATH  = "/tmp/cinepi-jank.bin";      // scripts/jank_dump.py
+constexpr int JANK_THRESHOLD_MS      = 50;
+constexpr long JANK_LOG_MAX_BYTES    = 1024 * 1024;                 // then rotated to .1
 
 // ─── Performance ────────────────────────────────────────────────────
 constexpr int LVGL_BUF_LINES    = 40;    // Number of lines in LVGL draw buffer
@@ -54,10 +96,13 @@ constexpr int TOUCH_READ_MS     = 30;
 constexpr int GYRO_READ_MS      = 100;
 constexpr int LIGHT_READ_MS     = 500;
 constexpr int BATTERY_READ_MS   = 5000;
+constexpr int SCREEN_IDLE_DESTROY_SEC = 30;   // hidden screens are rebuilt on next visit
+constexpr int UI_HEAP_PRESSURE_PCT    = 75;   // above this, hidden screens go at once
 
 // ─── Photo ──────────────────────────────────────────────────────────
 constexpr int GALLERY_THUMB_W   = 480;
 constexpr int GALLERY_THUMB_H   = 360;   // Aspect ratio preserved
 constexpr int JPEG_QUALITY      = 95;
+constexpr long JPEG_PREALLOC_BYTES = 256 * 1024;  // disk reserved per file at half-press
 
 } // namespace cinepi
@@ -0,0 +1,78 @@
+#pragma once
+/**
+ * CinePi Camera - Event Loop
+ * Single epoll reactor for driver fds, timerfds and cross-thread eventfds.
+ * Everything except the libcamera completion thread is dispatched from here.
+ */
+
+#include <cstdint>
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace cinepi {
+
+using FdHandler    = std::function<void(uint32_t events)>;
+using TimerHandler = std::function<void(uint64_t expirations)>;
+using LoopTask     = std::function<void()>;
+
+class EventLoop {
+public:
+    EventLoop();
+    ~EventLoop();
+
+    bool init();
+    void deinit();
+
+    // Watch an fd owned by a driver (EPOLLIN / EPOLLOUT / ...).
+    bool add_fd(int fd, uint32_t events, FdHandler cb);
+    void remove_fd(int fd);
+
+    // Periodic CLOCK_MONOTONIC timerfd owned by the loop.
+    // initial_ms < 0 means "first expiry after one period".
+    // Returns the timer fd (used as handle) or -1 on failure.
+    int  add_timer(int period_ms, TimerHandler cb, int initial_ms = -1);
+    bool set_timer(int timer_fd, int period_ms, int initial_ms = -1);
+    void remove_timer(int timer_fd);
+
+    // Run a task on the loop thread (safe from any thread).
+    void post(LoopTask task);
+
+    // Interrupt a blocking run_once() (async-signal-safe).
+    void wake();
+
+    // Wait up to timeout_ms (-1 = forever) and dispatch ready sources.
+    // Returns the number of sources dispatched.
+    int  run_once(int timeout_ms);
+
+    // Number of epoll_wait() returns since init (for wakeups/s reporting).
+    uint64_t wakeups() const { return wakeups_.load(std::memory_order_relaxed); }
+
+    // Time the last run_once() spent in handlers (excludes the wait).
+    uint64_t last_dispatch_us() const { return last_dispatch_us_; }
+
+private:
+    struct Source {
+        int       fd    = -1;
+        bool      owned = false;   // loop closes fd on removal (timers)
+        FdHandler cb;
+    };
+
+    void drain_posted();
+
+    int epoll_fd_ = -1;
+    int wake_fd_  = -1;            // eventfd for post()/wake()
+
+    std::map<int, std::shared_ptr<Source>> sources_;
+
+    std::mutex            post_mtx_;
+    std::vector<LoopTask> posted_;
+
+    std::atomic<uint64_t> wakeups_{0};
+    uint64_t              last_dispatch_us_ = 0;
+};
+
+} // namespace cinepi
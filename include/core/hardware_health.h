@@ -1,5 +1,7 @@
 /**
  * CinePi Camera - Hardware Health Monitor
+ * Status is recorded by the init graph as each driver comes up; the
+ * driver init is the probe, so no device is opened twice.
  */
 
 #pragma once
@@ -7,6 +9,7 @@
 #include <cstdint>
 #include <string>
 #include <map>
+#include <mutex>
 
 namespace cinepi {
 
@@ -31,7 +34,6 @@ public:
     HardwareHealth();
     ~HardwareHealth() = default;
 
-    bool init();
     bool is_available(HardwareComponent component) const;
     HardwareStatus get_status(HardwareComponent component) const;
     bool is_critical_ok() const;
@@ -41,14 +43,9 @@ public:
     void log_status() const;
 
 private:
+    mutable std::mutex mtx_;     // bring-up tasks report concurrently
     std::map<HardwareComponent, HardwareStatus> status_;
-    
-    bool check_camera();
-    bool check_display();
-    bool check_touch();
-    bool check_gpio();
-    bool check_i2c();
-    
+
     std::string component_name(HardwareComponent component) const;
 };
 
@@ -0,0 +1,61 @@
+#pragma once
+/**
+ * CinePi Camera - Init Graph
+ * Boot tasks with dependencies.  Each task starts on its own thread as
+ * soon as everything it depends on has finished, so independent hardware
+ * bring-ups overlap.  After run() the timeline and its critical path can
+ * be printed.
+ */
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace cinepi {
+
+class InitGraph {
+public:
+    // `name` must be a string literal; deps name tasks added before or
+    // after.  A task runs even if a dependency failed, fn decides what to
+    // do with a missing component.  fn returns false on failure.
+    void add(const char* name, std::vector<const char*> deps, std::function<bool()> fn);
+
+    // Run every task and wait for all of them.  False on an unknown
+    // dependency or a cycle (nothing is run then).
+    bool run();
+
+    bool ok(const char* name) const;
+
+    // Per-task start/end bars and the chain of tasks that bounded boot time.
+    void print_timeline() const;
+
+    // Logs and exports the time since exec (from /proc/self/stat, so at
+    // the kernel's clock-tick resolution).  Call once the UI is up.
+    static void report_ready();
+
+private:
+    struct Task {
+        const char*              name;
+        std::vector<const char*> dep_names;
+        std::function<bool()>    fn;
+        std::vector<int>         deps;
+        bool     done = false;
+        bool     ok = false;
+        uint64_t start_us = 0;
+        uint64_t end_us = 0;
+    };
+
+    int  find(const char* name) const;
+    bool resolve();
+    void run_task(int idx);
+
+    std::vector<Task>       tasks_;
+    std::mutex              mtx_;
+    std::condition_variable cv_;
+    uint64_t                t0_us_ = 0;
+    uint64_t                wall_us_ = 0;
+};
+
+} // namespace cinepi
@@ -0,0 +1,129 @@
+#pragma once
+/**
+ * CinePi Camera - Jank Detector
+ * Times each main-loop iteration by phase.  An iteration over budget is
+ * written to a compact binary log together with its context: per-phase
+ * exclusive times, page faults, scene, recent slow operations (gallery
+ * decode, config save) and the trace events of that frame.
+ *
+ * Phases are main-thread only; note() may be called from any thread.
+ */
+
+#include <cstdint>
+#include <mutex>
+
+namespace cinepi {
+
+// ─── Binary log format (little-endian, one record per janky frame) ──
+//   JankRecord, then n_phases × JankPhase, n_notes × JankNote,
+//   n_trace × JankTraceEvent.  `size` covers the whole record.
+constexpr uint32_t JANK_MAGIC = 0x314B4E4A;  // "JNK1"
+
+#pragma pack(push, 1)
+struct JankRecord {
+    uint32_t magic;
+    uint32_t size;
+    uint64_t start_us;        // CLOCK_MONOTONIC
+    uint32_t frame_us;
+    uint32_t minflt;          // page faults during the frame
+    uint32_t majflt;
+    uint8_t  scene;
+    char     scene_name[15];
+    uint8_t  n_phases;
+    uint8_t  n_notes;
+    uint16_t n_trace;
+};
+struct JankPhase {
+    char     name[24];
+    uint32_t exclusive_us;    // minus nested phases
+    uint32_t total_us;
+};
+struct JankNote {
+    char     what[16];
+    char     detail[48];
+    uint64_t ts_us;
+    uint32_t dur_us;
+};
+struct JankTraceEvent {
+    char     name[32];
+    uint64_t ts_us;
+    uint32_t dur_us;
+    int32_t  tid;
+};
+#pragma pack(pop)
+
+class JankDetector {
+public:
+    static constexpr int kMaxPhases = 16;
+    static constexpr int kMaxNotes  = 4;
+    static constexpr int kMaxTrace  = 256;
+
+    static JankDetector& instance();
+
+    void set_threshold_ms(int ms) { threshold_us_ = static_cast<uint64_t>(ms) * 1000; }
+    void set_log_path(const char* path) { log_path_ = path; }
+
+    void begin_frame();
+    void end_frame();
+
+    // Time already spent outside a scoped phase (e.g. event-loop dispatch).
+    void add_phase(const char* name, uint64_t us);
+
+    void set_scene(int id, const char* name);
+
+    // Remember a potentially slow operation for the next jank record.
+    void note(const char* what, const char* detail, uint64_t dur_us);
+
+    uint64_t jank_count() const { return jank_count_; }
+
+    // RAII phase; `name` must be a string literal.
+    class Phase {
+    public:
+        explicit Phase(const char* name);
+        ~Phase();
+        Phase(const Phase&) = delete;
+        Phase& operator=(const Phase&) = delete;
+    private:
+        int      idx_;
+        uint64_t start_;
+    };
+
+private:
+    JankDetector() = default;
+
+    struct PhaseSlot {
+        const char* name;
+        uint64_t    total_us;
+        uint64_t    child_us;
+    };
+
+    int  slot_for(const char* name);
+    void write_record(uint64_t frame_us, uint32_t minflt, uint32_t majflt);
+
+    uint64_t    threshold_us_ = 50000;
+    const char* log_path_ = nullptr;
+
+    bool      in_frame_ = false;
+    uint64_t  frame_start_ = 0;
+    long      minflt_start_ = 0;
+    long      majflt_start_ = 0;
+    PhaseSlot phases_[kMaxPhases] = {};
+    int       n_phases_ = 0;
+    int       stack_[kMaxPhases] = {};
+    int       depth_ = 0;
+
+    int         scene_ = 0;
+    const char* scene_name_ = "";
+
+    std::mutex mtx_;                 // guards notes_
+    JankNote   notes_[kMaxNotes] = {};
+    int        note_head_ = 0;
+
+    uint64_t jank_count_ = 0;
+};
+
+} // namespace cinepi
+
+#define JANK_CAT2(a, b) a##b
+#define JANK_CAT(a, b)  JANK_CAT2(a, b)
+#define JANK_PHASE(name) ::cinepi::JankDetector::Phase JANK_CAT(jank_phase_, __LINE__)(name)
@@ -0,0 +1,58 @@
+#pragma once
+/**
+ * CinePi Camera - Memory Accounting
+ * Per-subsystem memory breakdown against the systemd cgroup limit.
+ * Process totals come from /proc/self/smaps_rollup; subsystems register a
+ * callback that reports the bytes they currently hold.
+ */
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace cinepi {
+
+struct MemorySnapshot {
+    // /proc/self/smaps_rollup
+    uint64_t rss = 0;
+    uint64_t pss = 0;
+    uint64_t anon = 0;
+    uint64_t file = 0;            // Rss - Anonymous (mapped libraries, page cache)
+    uint64_t swap = 0;
+
+    // cgroup v2 memory.max / memory.current (v1 fallback); 0 = unknown
+    uint64_t cgroup_limit = 0;
+    uint64_t cgroup_current = 0;
+
+    struct Item { std::string name; uint64_t bytes; bool dmabuf; };
+    std::vector<Item> items;
+
+    uint64_t dmabuf_total() const;
+    // Bytes left before the cgroup OOM killer (0 when no limit is known).
+    uint64_t headroom() const;
+};
+
+class MemoryAccounting {
+public:
+    using Source = std::function<uint64_t()>;
+
+    static MemoryAccounting& instance();
+
+    // `dmabuf` marks kernel/CMA allocations (DRM dumb buffers, libcamera
+    // buffers); they are counted outside the process RSS.
+    void add_source(const std::string& name, Source fn, bool dmabuf = false);
+
+    MemorySnapshot sample() const;
+
+    // Log the breakdown and refresh the cinepi_memory_* metrics.
+    void report() const;
+
+private:
+    MemoryAccounting() = default;
+
+    struct Entry { std::string name; Source fn; bool dmabuf; };
+    std::vector<Entry> sources_;
+};
+
+} // namespace cinepi
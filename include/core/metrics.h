@@ -0,0 +1,130 @@
+#pragma once
+/**
+ * CinePi Camera - Metrics
+ * Counters, gauges and log-linear latency histograms.  Registration takes a
+ * lock once at startup; updates are lock-free atomics from any thread.
+ * MetricsServer exposes everything as Prometheus text on a Unix socket.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace cinepi {
+
+class EventLoop;
+
+class Counter {
+public:
+    void inc(uint64_t n = 1) { v_.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return v_.load(std::memory_order_relaxed); }
+private:
+    std::atomic<uint64_t> v_{0};
+};
+
+class Gauge {
+public:
+    void set(double v) { v_.store(v, std::memory_order_relaxed); }
+    void add(double d) {
+        double cur = v_.load(std::memory_order_relaxed);
+        while (!v_.compare_exchange_weak(cur, cur + d, std::memory_order_relaxed)) {}
+    }
+    double value() const { return v_.load(std::memory_order_relaxed); }
+private:
+    std::atomic<double> v_{0.0};
+};
+
+// HDR-style histogram over microseconds: 4 linear sub-buckets per power of
+// two (<= 25% relative error), 1 us .. ~16 s.  Values above go to an
+// overflow slot that only shows up under le="+Inf".
+class Histogram {
+public:
+    static constexpr int kSubBits = 2;
+    static constexpr int kSub     = 1 << kSubBits;
+    static constexpr int kMaxExp  = 24;
+    static constexpr int kBuckets = kSub + (kMaxExp - kSubBits) * kSub;
+
+    void record_us(uint64_t us);
+    uint64_t count() const { return count_.load(std::memory_order_relaxed); }
+    uint64_t sum_us() const { return sum_us_.load(std::memory_order_relaxed); }
+    uint64_t bucket(int i) const { return buckets_[i].load(std::memory_order_relaxed); }
+    uint64_t overflow() const { return buckets_[kBuckets].load(std::memory_order_relaxed); }
+
+    // Inclusive upper bound (us) of bucket i.
+    static uint64_t upper_bound_us(int i);
+
+private:
+    static int index_of(uint64_t us);
+
+    std::atomic<uint64_t> buckets_[kBuckets + 1] = {};   // [kBuckets] = overflow
+    std::atomic<uint64_t> count_{0};
+    std::atomic<uint64_t> sum_us_{0};
+};
+
+uint64_t metrics_now_us();
+
+// Records the lifetime of the scope into a histogram.
+class ScopedLatency {
+public:
+    explicit ScopedLatency(Histogram& h) : h_(h), start_(metrics_now_us()) {}
+    ~ScopedLatency() { h_.record_us(metrics_now_us() - start_); }
+private:
+    Histogram& h_;
+    uint64_t start_;
+};
+
+class Metrics {
+public:
+    static Metrics& instance();
+
+    // Names follow Prometheus conventions; counters and gauges may carry a
+    // label set in the name, e.g. "cinepi_i2c_errors_total{device=\"bh1750\"}".
+    // Returned references stay valid for the life of the process.
+    Counter&   counter(const std::string& name, const std::string& help);
+    Gauge&     gauge(const std::string& name, const std::string& help);
+    Histogram& histogram(const std::string& name, const std::string& help);
+
+    // Prometheus text exposition format 0.0.4.
+    std::string render() const;
+
+private:
+    Metrics() = default;
+
+    enum class Kind { Counter, Gauge, Histogram };
+    struct Entry {
+        std::string name;
+        std::string help;
+        Kind kind;
+        std::unique_ptr<Counter>   c;
+        std::unique_ptr<Gauge>     g;
+        std::unique_ptr<Histogram> h;
+    };
+
+    Entry* find(const std::string& name);
+
+    mutable std::mutex  mtx_;
+    std::vector<Entry>  entries_;
+};
+
+// Serves Metrics::render() to every connection on a Unix stream socket,
+// wrapped in a minimal HTTP/1.0 response so `curl --unix-socket` works.
+class MetricsServer {
+public:
+    MetricsServer();
+    ~MetricsServer();
+
+    bool init(EventLoop& loop, const char* path);
+    void deinit();
+
+private:
+    void on_accept();
+
+    EventLoop*  loop_ = nullptr;
+    int         listen_fd_ = -1;
+    std::string path_;
+};
+
+} // namespace cinepi
@@ -0,0 +1,60 @@
+#pragma once
+/**
+ * CinePi Camera - Thread Registry
+ * Named threads with a configurable CPU affinity / scheduling plan.
+ * The plan is applied when a thread registers; the registry reports
+ * per-thread CPU time and involuntary context switches.
+ */
+
+#include "core/config.h"
+
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <sys/types.h>
+
+namespace cinepi {
+
+class ThreadRegistry {
+public:
+    static ThreadRegistry& instance();
+
+    // Install the affinity/priority plan (from AppConfig::threads).
+    void set_plan(const std::vector<ThreadPlanEntry>& plan);
+
+    // Name the calling thread and apply its plan entry.  Threads created
+    // by libraries (libcamera) call this lazily from their first callback.
+    // The main thread is only tracked, never renamed or re-pinned.
+    void register_current(const std::string& name);
+    void unregister_current();
+
+    // std::thread that registers itself before running fn.
+    std::thread spawn(const std::string& name, std::function<void()> fn);
+
+    // Log one line per live thread: CPU time and involuntary switches,
+    // totals and delta since the previous report.
+    void report();
+
+private:
+    ThreadRegistry() = default;
+
+    struct Entry {
+        std::string name;
+        pid_t       tid = 0;
+        std::string sched;            // what was applied, for the report
+        uint64_t    last_cpu_ms = 0;
+        uint64_t    last_nvcsw  = 0;
+    };
+
+    const ThreadPlanEntry* find_plan(const std::string& name) const;
+    std::string apply(const ThreadPlanEntry& plan, pid_t tid);
+
+    std::mutex                   mtx_;
+    std::vector<ThreadPlanEntry> plan_;
+    std::vector<Entry>           threads_;
+};
+
+} // namespace cinepi
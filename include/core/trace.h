@@ -0,0 +1,96 @@
+#pragma once
+/**
+ * CinePi Camera - Trace Recorder
+ * Scoped trace points recorded into per-thread ring buffers and dumped as
+ * Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev).
+ *
+ * TRACE_SCOPE("name") costs one relaxed atomic load while tracing is
+ * disabled at runtime; building with -DCINEPI_TRACE=0 removes it entirely.
+ */
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#ifndef CINEPI_TRACE
+#define CINEPI_TRACE 1
+#endif
+
+namespace cinepi {
+
+class Tracer {
+public:
+    static Tracer& instance();
+
+    void set_enabled(bool on) { enabled_.store(on, std::memory_order_relaxed); }
+    bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+
+    // `name` must be a string literal (only the pointer is stored).
+    void record(const char* name, uint64_t start_us, uint64_t dur_us);
+
+    // Write the last window_sec seconds from every thread to path.
+    bool dump(const char* path, int window_sec);
+
+    struct Sample {
+        const char* name;
+        uint64_t    ts_us;
+        uint64_t    dur_us;
+        int         tid;
+    };
+    // Copy up to max events that started at or after since_us.
+    size_t collect(uint64_t since_us, size_t max, std::vector<Sample>& out);
+
+private:
+    Tracer() = default;
+
+    struct Event {
+        const char* name;
+        uint64_t    ts_us;
+        uint64_t    dur_us;
+    };
+
+    // Single-writer ring; the dump reads it best-effort while it is live.
+    struct Ring {
+        static constexpr uint32_t kSize = 4096;   // power of two
+        int                   tid = 0;
+        std::atomic<uint32_t> head{0};
+        Event                 events[kSize];
+    };
+
+    Ring* thread_ring();
+
+    std::atomic<bool>                  enabled_{false};
+    std::mutex                         rings_mtx_;
+    std::vector<std::unique_ptr<Ring>> rings_;
+};
+
+uint64_t trace_now_us();
+
+class TraceScope {
+public:
+    explicit TraceScope(const char* name)
+        : name_(Tracer::instance().enabled() ? name : nullptr),
+          start_(name_ ? trace_now_us() : 0) {}
+    ~TraceScope() {
+        if (name_) Tracer::instance().record(name_, start_, trace_now_us() - start_);
+    }
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+    const char* name_;
+    uint64_t    start_;
+};
+
+} // namespace cinepi
+
+#define CINEPI_TRACE_CAT2(a, b) a##b
+#define CINEPI_TRACE_CAT(a, b)  CINEPI_TRACE_CAT2(a, b)
+
+#if CINEPI_TRACE
+#define TRACE_SCOPE(name) ::cinepi::TraceScope CINEPI_TRACE_CAT(trace_scope_, __LINE__)(name)
+#else
+#define TRACE_SCOPE(name) ((void)0)
+#endif
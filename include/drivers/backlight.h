@@ -0,0 +1,72 @@
+#pragma once
+/**
+ * CinePi Camera - Backlight
+ * Single owner of the rpi_backlight sysfs attributes.  The fds stay open;
+ * level changes retarget a fade that a loop timer steps every
+ * BACKLIGHT_TICK_MS, writing only when the raw value changes, so a burst
+ * of slider events costs a handful of writes.  Fades are linear in
+ * perceived brightness (gamma 2.2), not in PWM duty.
+ *
+ * Levels are 0-255 as stored in display.brightness.  With auto mode the
+ * user level is scaled by ambient lux, re-evaluated only when the light
+ * has moved by more than a fixed fraction of a decade.
+ *
+ * Loop thread only.
+ */
+
+#include <cstdint>
+
+namespace cinepi {
+
+class EventLoop;
+
+class Backlight {
+public:
+    static Backlight& instance();
+
+    bool open();
+    void close();
+
+    // Fades need the loop; before attach() changes are written at once.
+    void attach(EventLoop& loop);
+    void detach();
+
+    // fade_ms < 0: BACKLIGHT_FADE_MS; 0: write at once
+    void set_level(int level, int fade_ms = -1);
+    void set_blank(bool blank);
+    void set_auto(bool on);
+    void update_ambient(float lux);
+
+    int level() const { return level_; }
+    bool is_blank() const { return blank_; }
+
+private:
+    Backlight() = default;
+
+    float target_perceived() const;
+    void retarget(int fade_ms);
+    void tick();
+    void write_level(float perceived);
+    bool write_attr(int fd, int value);
+
+    int bri_fd_ = -1;
+    int power_fd_ = -1;
+    int max_raw_ = 255;
+    int written_raw_ = -1;
+
+    EventLoop* loop_ = nullptr;
+    int timer_fd_ = -1;
+
+    int user_level_ = 128;
+    int level_ = 0;                 // last written, 0-255
+    bool blank_ = false;
+    bool auto_ = false;
+    float ambient_gain_ = 1.0f;
+    float anchor_log_lux_ = -1.0f;  // lux decade the gain was computed at
+
+    // Current fade in perceived brightness (0-1)
+    float from_ = 0.0f, to_ = 0.0f;
+    uint64_t fade_start_us_ = 0, fade_us_ = 0;
+};
+
+} // namespace cinepi
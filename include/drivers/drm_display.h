@@ -5,6 +5,11 @@
  * Zero-copy dual-plane architecture:
  *   PRIMARY  plane (z=0)  : libcamera DMA-BUF → DRM FB import, HW scaler.
  *   OVERLAY  plane (z=10) : LVGL ARGB8888 dumb buffer, double-buffered.
+ *
+ * Boot splash: the raw splash (scripts/png_to_raw.py) is copied into the
+ * mode-setting seed buffer, so it is on screen as soon as the mode is set.
+ * The first camera frame moves it to a spare overlay plane (z=5) whose
+ * plane alpha is faded out over SPLASH_FADE_MS.
  */
 
 #include <cstdint>
@@ -45,21 +50,39 @@ public:
     bool set_camera_dmabuf(int dmabuf_fd, int width, int height,
                            int stride, uint32_t drm_fourcc);
 
-    // Flip the UI double buffer (call once per LVGL vsync tick).
+    // Record a region LVGL has written into the back buffer.
+    void mark_ui_dirty(int x1, int y1, int x2, int y2);
+
+    // Flip the UI double buffer if anything was drawn since the last flip.
+    // The flushed region is then copied into the new back buffer so both
+    // buffers stay identical outside of LVGL's next partial redraw.
     bool commit();
 
     // Backlight.
     void set_blank(bool blank);
 
+    // Dispatch pending DRM events (vblank / page-flip) when the DRM fd is
+    // readable.  Called from the main event loop.
+    void handle_events();
+    uint64_t vblank_count() const { return vblank_count_; }
+
     int get_drm_fd()  const { return drm_fd_; }
     int get_mode_w()  const { return mode_w_; }
     int get_mode_h()  const { return mode_h_; }
+    int refresh_hz()  const { return refresh_hz_; }
+
+    // Dumb buffers owned by the display: UI double buffer + seed FB.
+    uint64_t dumb_bytes() const;
+    uint64_t flip_count() const { return flip_count_; }
 
 private:
     bool     find_crtc();
     bool     alloc_ui_bufs();
     void     discover_overlay_plane();
-    uint32_t find_plane_type(uint32_t drm_plane_type);
+    uint32_t find_plane_type(uint32_t drm_plane_type, uint32_t exclude = 0);
+    bool     load_splash(uint8_t *dst, uint32_t pitch);
+    void     discover_splash_plane();
+    void     step_splash_fade();
     CamFbEntry *get_or_import(int fd, int w, int h, int stride, uint32_t fourcc);
     bool     create_dumb(UiBuf &b, int w, int h, int bpp);
     void     destroy_dumb(UiBuf &b);
@@ -73,6 +96,7 @@ private:
     // Live mode dimensions (read from connector at init time).
     int      mode_w_        = 0;
     int      mode_h_        = 0;
+    int      refresh_hz_    = 60;
 
     // Discovered DRM plane IDs (0 = not found).
     uint32_t camera_plane_id_ = 0;
@@ -81,6 +105,14 @@ private:
     // Seed/blank FB to establish the mode via drmModeSetCrtc.
     uint32_t blank_fb_id_   = 0;
     uint32_t blank_gem_     = 0;
+    uint64_t blank_size_    = 0;
+
+    // Boot splash (lives in the seed FB) and its cross-fade plane.
+    enum class Splash { None, Shown, Fading };
+    Splash   splash_        = Splash::None;
+    uint32_t splash_plane_id_   = 0;
+    uint32_t splash_alpha_prop_ = 0;
+    uint64_t splash_fade_start_us_ = 0;
 
     // DMA-BUF → DRM FB registration cache.
     std::vector<CamFbEntry> cam_fb_cache_;
@@ -89,7 +121,14 @@ private:
     UiBuf    ui_bufs_[2];
     int      back_idx_      = 0;
 
+    // Bounding box of UI pixels flushed since the last commit().
+    bool     ui_dirty_      = false;
+    int      dirty_x1_ = 0, dirty_y1_ = 0, dirty_x2_ = 0, dirty_y2_ = 0;
+
     bool     initialized_   = false;
+
+    uint64_t vblank_count_  = 0;
+    uint64_t flip_count_    = 0;
 };
 
 } // namespace cinepi
@@ -2,20 +2,47 @@
 /**
  * CinePi Camera - GPIO Driver (libgpiod v2.x)
  * Handles shutter button, encoder, vibration motor, LED flash.
+ * Inputs are one line request with kernel debounce and edge detection;
+ * its fd goes into the event loop and process_events() dispatches the
+ * edge events with their kernel CLOCK_MONOTONIC timestamps.
+ * Outputs are switched by the "gpio-out" thread from a schedule of
+ * CLOCK_BOOTTIME edges, so the flash can be lined up with a frame's
+ * SensorTimestamp and haptic patterns never block the caller.
  */
 
+#include "drivers/quadrature.h"
+
 #include <cstdint>
 #include <atomic>
-#include <thread>
+#include <condition_variable>
 #include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 struct gpiod_chip;
 struct gpiod_line_request;
+struct gpiod_edge_event_buffer;
 
 namespace cinepi {
 
 using ButtonCallback = std::function<void()>;
-using EncoderCallback = std::function<void(int direction)>;  // +1 or -1
+using EncoderCallback = std::function<void(int steps)>;  // signed, accelerated
+// pressed_us: kernel timestamp of the press edge, CLOCK_MONOTONIC (metrics_now_us)
+using PressCallback = std::function<void(uint64_t pressed_us)>;
+// Shutter half-press contact closed (held) or opened, same clock
+using HalfPressCallback = std::function<void(bool held, uint64_t t_us)>;
+
+enum class Haptic { Shutter, Saved, Error };
+
+// One flash pulse: requested CLOCK_BOOTTIME edges and when the line was
+// actually switched (0 = not yet)
+struct FlashPulse {
+    uint64_t target_on_ns = 0;
+    uint64_t target_off_ns = 0;
+    uint64_t on_ns = 0;
+    uint64_t off_ns = 0;
+};
 
 class GpioDriver {
 public:
@@ -25,35 +52,67 @@ public:
     bool init();
     void deinit();
 
-    // Set callbacks
-    void on_shutter(ButtonCallback cb);
+    // Set callbacks (run on the event loop thread)
+    void on_shutter(PressCallback cb);
+    void on_shutter_half(HalfPressCallback cb);
     void on_encoder_button(ButtonCallback cb);
     void on_encoder_rotate(EncoderCallback cb);
 
     // Outputs
     void set_flash(bool on);
     void vibrate(int duration_ms);
+    void vibrate(Haptic pattern);     // replaces any pattern still playing
+
+    // Light the flash over [on_ns, off_ns) (CLOCK_BOOTTIME), replacing a
+    // pending pulse.  False without outputs or if on_ns has passed.
+    bool schedule_flash(uint64_t on_ns, uint64_t off_ns);
+    FlashPulse last_flash() const;
 
     // Last activity for standby
     uint64_t last_activity_ms() const;
 
+    // gpiod line-request fd for the event loop (-1 if no input lines).
+    int event_fd() const;
+    void process_events();
+
 private:
-    void poll_thread();
+    void on_edge(unsigned int line, bool active, uint64_t t_ns);
+    void set_output(unsigned int line, bool on);
+
+    struct OutputEdge {
+        uint64_t t_ns;              // CLOCK_BOOTTIME
+        unsigned int line;
+        bool on;
+    };
+    // Caller holds out_mtx_
+    void schedule(const OutputEdge& e);
+    void cancel(unsigned int line);
+    void output_thread();
 
     gpiod_chip* chip_ = nullptr;
-    gpiod_line_request* input_req_ = nullptr;   // Shutter, Enc CLK/DT, Enc Button
+    gpiod_line_request* input_req_ = nullptr;   // Shutter (full/half), Enc CLK/DT, Enc Button
     gpiod_line_request* output_req_ = nullptr;  // Flash LED, Vibration Motor
+    gpiod_edge_event_buffer* events_ = nullptr;
+
+    // Timed outputs, sorted by time
+    std::thread out_thread_;
+    mutable std::mutex out_mtx_;
+    std::condition_variable out_cv_;
+    std::vector<OutputEdge> out_edges_;
+    bool out_stop_ = false;
+    FlashPulse flash_;
 
-    std::thread thread_;
-    std::atomic<bool> running_{false};
     std::atomic<uint64_t> last_activity_{0};
 
-    ButtonCallback shutter_cb_;
+    PressCallback shutter_cb_;
+    HalfPressCallback shutter_half_cb_;
     ButtonCallback enc_btn_cb_;
     EncoderCallback enc_rot_cb_;
 
-    // Encoder state
-    int enc_last_clk_ = 1;
+    // Encoder contact levels (active = closed) and decoder
+    bool enc_clk_ = false;
+    bool enc_dt_ = false;
+    QuadratureDecoder encoder_;
 };
 
 } // namespace cinepi
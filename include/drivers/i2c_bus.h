@@ -0,0 +1,98 @@
+#pragma once
+/**
+ * CinePi Camera - I2C Bus
+ * One /dev/i2c-N fd shared by every sensor.  A register read is a single
+ * I2C_RDWR ioctl (register write, repeated start, read) instead of
+ * ioctl(I2C_SLAVE) + write + read.  Periodic reads run on absolute
+ * CLOCK_MONOTONIC deadlines from one timerfd; reads that fall due together
+ * go out as one combined transfer.  Errors and retries are counted per
+ * device (cinepi_i2c_*_total{device=...}).
+ *
+ * The wire is behind I2CTransport: /dev/i2c-N on the camera, or
+ * SimI2CBus (drivers/i2c_sim.h) on a build host.
+ */
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+struct i2c_msg;
+
+namespace cinepi {
+
+class EventLoop;
+class Counter;
+
+constexpr int I2C_NO_REG = -1;   // plain read, no register address phase
+
+// One combined transfer: messages separated by repeated starts, all or
+// nothing (the first NACK fails the whole transfer).
+class I2CTransport {
+public:
+    virtual ~I2CTransport() = default;
+    virtual bool transfer(i2c_msg* msgs, int n) = 0;
+};
+
+class I2CBus {
+public:
+    // Runs on the loop thread; data is valid only during the call.
+    using ReadDone = std::function<void(bool ok, const uint8_t* data, int len)>;
+
+    I2CBus();
+    ~I2CBus();
+
+    bool open(const char* path);
+    bool open(std::unique_ptr<I2CTransport> transport);
+    void close();
+    bool is_open() const { return transport_ != nullptr; }
+
+    // Register a device for transfers and accounting; returns its id.
+    int add_device(const char* name, uint8_t addr);
+
+    // Blocking transfers, retried up to I2C_MAX_RETRIES times.
+    bool read(int dev, int reg, uint8_t* buf, uint16_t len);
+    bool write(int dev, const uint8_t* data, uint16_t len);
+    bool write_reg(int dev, uint8_t reg, uint8_t val);
+    bool write_byte(int dev, uint8_t val);
+
+    // Read len bytes every period_ms.  Polls registered before start()
+    // share one time base, so multiples of each other line up and batch;
+    // stop() drops them.
+    void add_poll(int dev, int period_ms, int reg, uint16_t len, ReadDone done);
+    bool start(EventLoop& loop);
+    void stop();
+
+private:
+    struct Device {
+        const char* name;
+        uint8_t     addr;
+        Counter*    transfers;
+        Counter*    errors;
+        Counter*    retries;
+    };
+    struct Poll {
+        int      dev;
+        uint64_t period_us;
+        uint64_t due_us;
+        int      reg;
+        uint8_t  reg_byte;
+        std::vector<uint8_t> buf;
+        ReadDone done;
+    };
+
+    bool transfer(i2c_msg* msgs, int n) { return transport_ && transport_->transfer(msgs, n); }
+    bool transfer_retry(int dev, i2c_msg* msgs, int n);
+    void fill_msgs(Poll& p, i2c_msg* msgs, int* n);
+    void on_timer();
+    void arm();
+
+    std::unique_ptr<I2CTransport> transport_;
+    std::vector<Device> devices_;
+    std::vector<Poll> polls_;
+
+    EventLoop* loop_ = nullptr;
+    int timer_fd_ = -1;
+};
+
+} // namespace cinepi
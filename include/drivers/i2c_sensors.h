@@ -1,15 +1,39 @@
 #pragma once
 /**
  * CinePi Camera - I2C Sensor Drivers
- * BH1750 Light Sensor + L3G4200D Gyroscope
+ * BH1750 Light Sensor + IMU (L3G4200D, MPU-6050 or LSM6DS3, probed)
+ *
+ * Polling runs on its own "i2c" thread and EventLoop: a FIFO drain is a
+ * blocking transfer of several ms at 100 kHz, which must not stall the UI
+ * loop.  Results reach other threads only through the atomics and the
+ * SampleRings below.
  */
 
+#include "core/event_loop.h"
+#include "drivers/i2c_bus.h"
+#include "drivers/imu.h"
+#include "drivers/imu_fusion.h"
+#include "drivers/sensor_ring.h"
+
 #include <cstdint>
 #include <atomic>
 #include <thread>
 
 namespace cinepi {
 
+// Rotation during a time window, e.g. one frame's exposure.
+struct FrameMotion {
+    int   samples = 0;
+    bool  covered = false;       // ring holds samples across the whole window
+    float peak_dps = 0.0f;       // peak angular rate
+    float rms_dps = 0.0f;
+    float swept_deg = 0.0f;      // total rotation over the window (blur proxy)
+    float roll_deg = 0.0f;       // fused attitude at mid-window
+    float pitch_deg = 0.0f;
+};
+
+// cached_gyro(): fused attitude, gravity-referenced on parts with an
+// accelerometer; yaw is the integrated gyro.  read_gyro(): rates, deg/s.
 struct GyroData {
     float pitch = 0.0f;  // degrees
     float roll  = 0.0f;  // degrees
@@ -21,37 +45,81 @@ public:
     I2CSensors();
     ~I2CSensors();
 
-    bool init();
+    // transport: nullptr opens I2C_DEV; otherwise e.g. a SimI2CBus
+    bool init(std::unique_ptr<I2CTransport> transport = nullptr);
     void deinit();
 
-    // Light sensor (BH1750)
+    // Light sensor (BH1750); the cached value while polling owns the bus
     float read_lux();
 
-    // Gyroscope (L3G4200D)
+    // Newest bias-corrected gyro rates (from the FIFO history)
     GyroData read_gyro();
 
-    // Continuous background reading
-    void start_polling();
+    // Continuous background reading on the "i2c" thread, scheduled by the
+    // shared I2C bus.  No direct bus access from other threads meanwhile.
+    bool start_polling();
     void stop_polling();
+    const EventLoop& poll_loop() const { return poll_loop_; }
 
     // Cached values (thread-safe)
     float cached_lux() const { return lux_.load(); }
     GyroData cached_gyro() const;
 
-    // Activity detection (gyro movement)
+    // Activity detection: peak angular rate (deg/s) of the last FIFO burst
     bool has_movement(float threshold_deg = 5.0f) const;
 
+    // Gyro sample rate measured against CLOCK_MONOTONIC (0 until known)
+    float gyro_rate_hz() const {
+        float p = gyro_period_us_.load();
+        return p > 0 ? 1e6f / p : 0.0f;
+    }
+    bool gyro_calibrated() const { return gyro_cal_done_.load(); }
+
+    // History lookups by CLOCK_BOOTTIME ns (libcamera SensorTimestamp),
+    // served from the sample rings: no I2C traffic at capture time.
+    FrameMotion motion_during(uint64_t start_ns, uint64_t duration_ns) const;
+    float lux_at(uint64_t t_ns) const;
+    // Newest sample, with the rate averaged over the last window_ns
+    bool recent_gyro(uint64_t window_ns, GyroSample* out) const;
+
 private:
     bool init_bh1750();
-    bool init_l3g4200d();
-    void poll_thread();
+    bool start_light_measurement();
+    void calibrate_gyro(const ImuSample* samples, int n);
+    void on_gyro_fifo(const uint8_t* status);
+    void store_attitude();
+    void on_light(const uint8_t* buf);
 
-    int i2c_fd_ = -1;
+    I2CBus bus_;
+    int light_dev_ = -1;
     bool bh1750_ok_ = false;
-    bool l3g4200d_ok_ = false;
+    std::unique_ptr<ImuDriver> imu_;
+    uint64_t bh1750_ready_us_ = 0;   // current conversion done
+    uint64_t bh1750_meas_ns_ = 0;    // its mid-point, CLOCK_BOOTTIME
+    bool bh1750_lores_ = false;      // 4 lx mode while it is bright enough
+    bool polling_ = false;
+
+    EventLoop poll_loop_;
+    std::thread poll_thread_;
+    std::atomic<bool> poll_running_{false};
+
+    // Integrated angles and attitude filter (touched only on the i2c thread)
+    float pitch_acc_ = 0.0f;
+    float roll_acc_  = 0.0f;
+    float yaw_acc_   = 0.0f;
+    ImuFusion fusion_;
+
+    // FIFO timing and zero-rate bias (i2c thread)
+    uint64_t gyro_last_drain_us_ = 0;
+    std::atomic<float> gyro_period_us_{0.0f};   // smoothed sample period
+    float    gyro_bias_[3] = {};          // deg/s
+    std::atomic<bool> gyro_cal_done_{false};
+    int      gyro_cal_n_ = 0;
+    double   gyro_cal_sum_[3] = {};
+    double   gyro_cal_sq_[3] = {};
 
-    std::thread thread_;
-    std::atomic<bool> running_{false};
+    SampleRing<GyroSample, 1024> gyro_ring_;   // ~5 s at 200 Hz
+    SampleRing<LuxSample, 32>    lux_ring_;
 
     std::atomic<float> lux_{0.0f};
     std::atomic<float> gyro_pitch_{0.0f};
@@ -0,0 +1,128 @@
+#pragma once
+/**
+ * CinePi Camera - Simulated I2C Bus
+ * I2CTransport that answers for emulated BH1750 and L3G4200D chips, so
+ * I2CSensors (bring-up, FIFO drains, polling cadence, fusion) runs
+ * unmodified on a build host.  The chips run on CLOCK_MONOTONIC like the
+ * real ones: the gyro produces samples at its (deliberately imperfect)
+ * ODR into a 32-deep FIFO, the light sensor converts with datasheet
+ * timings.  Input comes from a SensorTrace, recorded or synthetic.
+ */
+
+#include "drivers/i2c_bus.h"
+
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace cinepi {
+
+// Angular rate and lux over time, interpolated linearly and looped.
+// CSV: t_s,x_dps,y_dps,z_dps,lux  (x/y/z as the L3G4200D axes: roll,
+// pitch, yaw); '#' lines are comments.
+class SensorTrace {
+public:
+    bool load_csv(const char* path);
+    // 2 s still (gyro calibration), then hand shake, a pan and lux steps
+    static SensorTrace synthetic(double seconds);
+
+    void sample(double t_s, float rate[3], float* lux) const;
+    double duration() const { return pts_.empty() ? 0.0 : pts_.back().t_s; }
+
+private:
+    struct Point { double t_s; float rate[3]; float lux; };
+    std::vector<Point> pts_;
+};
+
+class SimDevice {
+public:
+    explicit SimDevice(uint8_t addr) : addr_(addr) {}
+    virtual ~SimDevice() = default;
+    uint8_t addr() const { return addr_; }
+    // false = NACK
+    virtual bool write(const uint8_t* data, int len, uint64_t now_us) = 0;
+    virtual bool read(uint8_t* buf, int len, uint64_t now_us) = 0;
+
+    std::vector<uint64_t> access_us;   // start of every transfer, for cadence
+
+private:
+    uint8_t addr_;
+};
+
+class SimBH1750 : public SimDevice {
+public:
+    SimBH1750(uint8_t addr, const SensorTrace& trace, uint64_t t0_us);
+    bool write(const uint8_t* data, int len, uint64_t now_us) override;
+    bool read(uint8_t* buf, int len, uint64_t now_us) override;
+
+private:
+    void update(uint64_t now_us);
+
+    const SensorTrace& trace_;
+    uint64_t t0_us_;
+    bool powered_ = false;
+    bool measuring_ = false;
+    bool continuous_ = false;
+    bool lores_ = false;
+    uint64_t meas_start_us_ = 0;
+    uint16_t result_ = 0;
+};
+
+class SimL3G4200D : public SimDevice {
+public:
+    // odr_error: fractional deviation of the real ODR from nominal;
+    // bias/noise in deg/s
+    SimL3G4200D(uint8_t addr, const SensorTrace& trace, uint64_t t0_us,
+                float odr_error, float bias_dps, float noise_dps);
+    bool write(const uint8_t* data, int len, uint64_t now_us) override;
+    bool read(uint8_t* buf, int len, uint64_t now_us) override;
+
+    uint64_t samples_generated() const { return generated_; }
+    uint64_t samples_overwritten() const { return overwritten_; }
+
+private:
+    void update(uint64_t now_us);
+    uint8_t reg(uint8_t r) const;
+    bool fifo_enabled() const;
+
+    const SensorTrace& trace_;
+    uint64_t t0_us_;
+    float odr_error_, bias_dps_;
+    std::mt19937 rng_{1};
+    std::normal_distribution<float> noise_;
+
+    uint8_t regs_[0x40] = {};
+    uint8_t ptr_ = 0;
+    bool auto_inc_ = false;
+
+    int16_t fifo_[32][3] = {};
+    int fifo_head_ = 0, fifo_count_ = 0;
+    int16_t latest_[3] = {};
+    bool overrun_ = false;
+    uint64_t next_sample_us_ = 0;
+    uint64_t generated_ = 0, overwritten_ = 0;
+};
+
+class SimI2CBus : public I2CTransport {
+public:
+    explicit SimI2CBus(uint32_t bus_hz = 100000) : bus_hz_(bus_hz) {}
+
+    SimDevice* add(std::unique_ptr<SimDevice> dev);
+    bool transfer(i2c_msg* msgs, int n) override;
+
+    uint64_t transfers() const { return transfers_; }
+    uint64_t bytes() const { return bytes_; }
+    uint64_t nacks() const { return nacks_; }
+    // Wire time the transfers would take at bus_hz (start, address, ACKs)
+    uint64_t wire_us() const { return wire_bits_ * 1000000ULL / bus_hz_; }
+
+private:
+    SimDevice* find(uint16_t addr) const;
+
+    uint32_t bus_hz_;
+    std::vector<std::unique_ptr<SimDevice>> devices_;
+    uint64_t transfers_ = 0, bytes_ = 0, nacks_ = 0, wire_bits_ = 0;
+};
+
+} // namespace cinepi
@@ -0,0 +1,58 @@
+#pragma once
+/**
+ * CinePi Camera - IMU Drivers
+ * Gyro-only L3G4200D and gyro+accelerometer MPU-6050 / LSM6DS3 behind one
+ * interface.  Each part runs its hardware FIFO at ~200 Hz; I2CSensors polls
+ * the FIFO status block and drains the queued samples in one burst.
+ *
+ * Axes follow the L3G4200D board: x is the lens axis (roll), y pitch,
+ * z yaw, accelerometer reading +1 g on z when the camera is held level.
+ * Other parts must be mounted with the same orientation.
+ */
+
+#include <cstdint>
+#include <memory>
+
+namespace cinepi {
+
+class I2CBus;
+
+constexpr int IMU_MAX_BURST = 32;   // samples per drain (L3G4200D FIFO depth)
+
+struct ImuSample {
+    float gyro[3];    // deg/s, bias not removed
+    float accel[3];   // g; zero on gyro-only parts
+};
+
+class ImuDriver {
+public:
+    virtual ~ImuDriver() = default;
+
+    // First supported part that answers WHO_AM_I, configured and streaming
+    // into its FIFO; nullptr if none does.
+    static std::unique_ptr<ImuDriver> probe(I2CBus& bus);
+
+    virtual const char* name() const = 0;
+    virtual bool  has_accel() const = 0;
+    virtual float nominal_period_us() const = 0;
+
+    // FIFO status block for the bus poll (read every GYRO_READ_MS)
+    virtual uint8_t  status_reg() const = 0;
+    virtual uint16_t status_len() const = 0;
+
+    // Read the samples the status block reports, oldest first (at most
+    // IMU_MAX_BURST).  overrun: samples were lost since the last drain.
+    // Returns the count, -1 on a bus error.
+    virtual int drain(const uint8_t* status, ImuSample* out, bool* overrun) = 0;
+
+    int dev() const { return dev_; }
+
+protected:
+    ImuDriver(I2CBus& bus, int dev) : bus_(bus), dev_(dev) {}
+    virtual bool init() = 0;
+
+    I2CBus& bus_;
+    int     dev_;
+};
+
+} // namespace cinepi
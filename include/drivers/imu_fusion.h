@@ -0,0 +1,35 @@
+#pragma once
+/**
+ * CinePi Camera - IMU Fusion
+ * Mahony complementary filter on a unit quaternion, stepped once per FIFO
+ * sample.  The gyro carries the attitude between samples; when the
+ * accelerometer reads close to 1 g, the angle between measured and
+ * estimated gravity pulls roll and pitch back and trims the remaining gyro
+ * bias.  Yaw has no reference and drifts.  With no accelerometer this is
+ * plain gyro integration.
+ */
+
+namespace cinepi {
+
+class ImuFusion {
+public:
+    void reset();
+
+    // gyro: bias-corrected deg/s (x lens axis, y, z); accel: g, or nullptr
+    // for gyro-only parts; dt: seconds since the previous sample
+    void update(const float gyro_dps[3], const float* accel_g, float dt);
+
+    // Roll about the lens axis and pitch, degrees
+    void attitude(float* roll_deg, float* pitch_deg) const;
+    // Gravity has pulled the estimate in at least once
+    bool referenced() const { return aligned_; }
+
+private:
+    void align(const float a[3]);
+
+    float q_[4] = {1.0f, 0.0f, 0.0f, 0.0f};
+    float bias_[3] = {};   // rad/s, integral term
+    bool  aligned_ = false;
+};
+
+} // namespace cinepi
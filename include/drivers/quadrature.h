@@ -0,0 +1,47 @@
+#pragma once
+/**
+ * CinePi Camera - Quadrature Decoder
+ * Rotary encoder CLK/DT decoding from timestamped edge events.  A 16-entry
+ * table maps (previous, current) contact state to -1/0/+1 quarter steps.
+ * Transitions that reveal a lost edge (both contacts changed, or an edge
+ * that leaves the state unchanged) are counted, not guessed.  A detent is
+ * reported when the contacts return to rest (both open) with at least half
+ * a cycle of travel in one direction, so a bouncing contact costs nothing.
+ *
+ * Detents are then scaled by spin speed: below ENCODER_ACCEL_MIN_HZ one
+ * detent is one step, rising linearly to ENCODER_ACCEL_MAX_STEPS per
+ * detent at ENCODER_ACCEL_MAX_HZ.  Fractions carry over, so the total is
+ * smooth, and reversing direction drops straight back to single steps.
+ */
+
+#include <cstdint>
+
+namespace cinepi {
+
+class QuadratureDecoder {
+public:
+    // Contact levels (true = closed) as read when the decoder starts
+    void reset(bool a, bool b);
+
+    // New levels after an edge on either contact, t_ns from the edge event.
+    // Returns the signed, accelerated steps to apply (usually 0).
+    int update(bool a, bool b, uint64_t t_ns);
+
+    uint64_t detents() const { return detents_; }
+    uint64_t invalid() const { return invalid_; }
+
+private:
+    int steps_for_detent(int dir, uint64_t t_ns);
+
+    uint8_t  state_ = 0;         // (a << 1) | b
+    int      quarters_ = 0;      // signed travel since the last rest state
+    int      last_dir_ = 0;
+    uint64_t last_detent_ns_ = 0;
+    float    rate_hz_ = 0.0f;    // smoothed detent rate
+    float    carry_ = 0.0f;      // fractional steps not yet reported
+
+    uint64_t detents_ = 0;
+    uint64_t invalid_ = 0;
+};
+
+} // namespace cinepi
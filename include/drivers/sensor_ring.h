@@ -0,0 +1,90 @@
+#pragma once
+/**
+ * CinePi Camera - Sensor Sample Ring
+ * Fixed-size history of timestamped sensor samples.  Timestamps are
+ * CLOCK_BOOTTIME nanoseconds, the clock libcamera defines SensorTimestamp
+ * in, so samples can be matched to a frame's exposure window directly.
+ * Written on the event loop, read from the camera/encoder threads.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <mutex>
+
+namespace cinepi {
+
+inline uint64_t sensor_clock_ns() {
+    struct timespec ts;
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+}
+
+struct GyroSample {
+    uint64_t t_ns;
+    float rate[3];      // roll, pitch, yaw rate (deg/s), bias-corrected
+    float angle[3];     // integrated roll, pitch, yaw (deg)
+    float attitude[2];  // fused roll, pitch (deg), see drivers/imu_fusion.h
+};
+
+struct LuxSample {
+    uint64_t t_ns;
+    float lux;
+};
+
+template <typename T, size_t N>
+class SampleRing {
+    static_assert((N & (N - 1)) == 0, "ring size must be a power of two");
+public:
+    void push(const T& s) {
+        std::lock_guard<std::mutex> lk(mtx_);
+        buf_[head_ & (N - 1)] = s;
+        head_++;
+    }
+
+    // Calls fn(sample) for samples with from_ns <= t_ns <= to_ns, oldest
+    // first; returns how many.  The lock is held, so keep fn short.
+    template <typename Fn>
+    size_t visit(uint64_t from_ns, uint64_t to_ns, Fn fn) const {
+        std::lock_guard<std::mutex> lk(mtx_);
+        size_t count = head_ < N ? head_ : N;
+        size_t visited = 0;
+        for (size_t i = head_ - count; i < head_; i++) {
+            const T& s = buf_[i & (N - 1)];
+            if (s.t_ns < from_ns) continue;
+            if (s.t_ns > to_ns) break;
+            fn(s);
+            visited++;
+        }
+        return visited;
+    }
+
+    // Latest sample at or before t_ns.
+    bool at(uint64_t t_ns, T* out) const {
+        std::lock_guard<std::mutex> lk(mtx_);
+        size_t count = head_ < N ? head_ : N;
+        for (size_t i = head_; i > head_ - count; i--) {
+            const T& s = buf_[(i - 1) & (N - 1)];
+            if (s.t_ns <= t_ns) {
+                *out = s;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Oldest and newest timestamps held (0 when empty).
+    void span(uint64_t* oldest, uint64_t* newest) const {
+        std::lock_guard<std::mutex> lk(mtx_);
+        size_t count = head_ < N ? head_ : N;
+        *oldest = count ? buf_[(head_ - count) & (N - 1)].t_ns : 0;
+        *newest = count ? buf_[(head_ - 1) & (N - 1)].t_ns : 0;
+    }
+
+private:
+    mutable std::mutex mtx_;
+    T buf_[N] = {};
+    size_t head_ = 0;
+};
+
+} // namespace cinepi
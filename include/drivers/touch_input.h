@@ -6,8 +6,6 @@
 
 #include <cstdint>
 #include <atomic>
-#include <thread>
-#include <functional>
 #include <string>
 
 namespace cinepi {
@@ -26,6 +24,13 @@ public:
     bool init();
     void deinit();
 
+    // evdev fd for the event loop; call process_events() when readable.
+    int fd() const { return fd_; }
+
+    // Drain all pending input events (non-blocking).
+    // Returns true if any touch activity was seen.
+    bool process_events();
+
     // Get current touch state (thread-safe)
     TouchPoint read();
 
@@ -33,13 +38,10 @@ public:
     uint64_t last_activity_ms() const;
 
 private:
-    void reader_thread();
     std::string find_touch_device();
     bool query_abs_ranges();
 
     int fd_ = -1;
-    std::thread thread_;
-    std::atomic<bool> running_{false};
 
     int abs_min_x_ = 0;
     int abs_max_x_ = 799;
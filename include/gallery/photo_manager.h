@@ -2,8 +2,11 @@
 /**
  * CinePi Camera - Photo Manager
  * Coordinates capture flow: flash -> capture -> save -> vibrate.
+ * The flash pulse is timed by CameraPipeline against frame metadata.
+ * A half-press (two-stage shutter) locks AE/AWB and prepares the capture.
  */
 
+#include <cstdint>
 #include <string>
 #include <functional>
 
@@ -20,8 +23,9 @@ public:
 
     void init(CameraPipeline& cam, GpioDriver& gpio, I2CSensors* sensors);
 
-    // Trigger a capture (called from shutter button or UI)
-    void trigger_capture();
+    // Trigger a capture (called from shutter button or UI).  pressed_us is
+    // the button's edge timestamp, where capture latency is measured from.
+    void trigger_capture(uint64_t pressed_us = 0);
 
     // Get last captured file path
     const std::string& last_photo() const { return last_path_; }
@@ -31,6 +35,16 @@ public:
     void on_capture_done(DoneCallback cb);
 
 private:
+    // Shutter half-press contact: prepare on hold, release on let go
+    void half_press(bool held);
+
+    // Gyro/lux history over the captured frame's exposure window
+    void log_exposure_motion() const;
+    // Shake-aware shutter: delay added and blur avoided for the last shot
+    void log_steady_selection() const;
+    // Flash pulse edges vs the captured frame's actual exposure window
+    void log_flash_alignment() const;
+
     CameraPipeline* cam_ = nullptr;
     GpioDriver* gpio_ = nullptr;
     I2CSensors* sensors_ = nullptr;
@@ -38,6 +52,7 @@ private:
     std::string last_path_;
     DoneCallback done_cb_;
     bool capturing_ = false;
+    std::string prepared_path_;     // file readied by the held half-press
 };
 
 } // namespace cinepi
@@ -1,7 +1,8 @@
 #pragma once
 /**
  * CinePi Camera - Power Manager
- * Handles standby/wake based on idle detection.
+ * Tiered standby based on idle detection and gyro motion.  Each tier adds
+ * to the one before, so waking from a shallow tier only undoes a little.
  */
 
 #include <cstdint>
@@ -16,6 +17,14 @@ class GpioDriver;
 class I2CSensors;
 class LvglDriver;
 
+enum class PowerTier {
+    Active,
+    Dim,          // backlight at STANDBY_DIM_LEVEL
+    UiPaused,     // LVGL paused, live preview still on the dimmed panel
+    CameraLow,    // panel off, preview at STANDBY_LOW_FPS, CPU powersave
+    Stopped,      // camera stopped
+};
+
 class PowerManager {
 public:
     PowerManager();
@@ -25,10 +34,15 @@ public:
               TouchInput* touch, GpioDriver& gpio,
               I2CSensors* sensors, LvglDriver& lvgl);
 
-    // Call in main loop - checks idle timeout
+    // Call in main loop - moves between tiers on idle time and motion
     void update();
 
-    bool is_standby() const { return standby_.load(); }
+    // Call per completed camera frame: ends a pending wake measurement
+    void on_frame();
+
+    PowerTier tier() const { return tier_.load(); }
+    // LVGL paused: the main loop skips UI work
+    bool is_standby() const { return tier_.load() >= PowerTier::UiPaused; }
     void wake();
     void sleep();
 
@@ -36,6 +50,8 @@ public:
 
 private:
     uint64_t last_activity_ms() const;
+    void enter(PowerTier tier);
+    void step(PowerTier tier, bool down);
 
     DrmDisplay* display_ = nullptr;
     CameraPipeline* cam_ = nullptr;
@@ -44,9 +60,14 @@ private:
     I2CSensors* sensors_ = nullptr;
     LvglDriver* lvgl_ = nullptr;
 
-    std::atomic<bool> standby_{false};
+    std::atomic<PowerTier> tier_{PowerTier::Active};
     int timeout_sec_ = 10;
-    int saved_brightness_ = 128;
+    uint64_t last_motion_ms_ = 0;
+
+    // Wake to first frame (and, from CameraLow, to full rate)
+    PowerTier wake_from_ = PowerTier::Active;
+    uint64_t wake_us_ = 0;
+    bool wait_full_rate_ = false;
 };
 
 } // namespace cinepi
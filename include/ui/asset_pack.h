@@ -0,0 +1,97 @@
+#pragma once
+/**
+ * CinePi Camera - UI Asset Pack
+ * Glyph bitmaps, glyph/cmap/kerning tables and image data of the
+ * SquareLine UI, packed at build time by scripts/pack_assets.py and mmapped
+ * at startup.  The lv_font_t / lv_img_dsc_t symbols stay in the binary
+ * (generated ui_assets.c); load() points their tables into the mapping, so
+ * glyph pages are only faulted in when a glyph is first drawn.
+ * Images the screens show at a constant zoom/angle are also packed
+ * pre-transformed; apply_fixups() swaps them onto their widgets.
+ *
+ * Without the pack (or with -DCINEPI_ASSET_PACK=OFF, which links the font
+ * C files as before) fonts fall back to LV_FONT_DEFAULT.
+ */
+
+#include <cstddef>
+#include <cstdint>
+
+#ifndef CINEPI_ASSET_PACK
+#define CINEPI_ASSET_PACK 0
+#endif
+
+namespace cinepi {
+
+// ─── Pack format (little-endian, offsets from file start, 4-aligned) ──
+//   PackHeader, n_fonts × PackFont, n_images × PackImage, then the tables.
+constexpr uint32_t ASSET_PACK_MAGIC   = 0x4B504143;  // "CAPK"
+constexpr uint16_t ASSET_PACK_VERSION = 1;
+
+#pragma pack(push, 1)
+struct PackHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t n_fonts;
+    uint16_t n_images;
+    uint16_t reserved;
+    uint32_t crc;             // crc32 of everything after the header
+};
+struct PackFont {
+    char     name[32];
+    uint32_t bitmap_off;
+    uint32_t bitmap_size;
+    uint32_t glyph_off;       // lv_font_fmt_txt_glyph_dsc_t[glyph_cnt], used in place
+    uint32_t glyph_cnt;
+    uint32_t cmap_off;        // PackCmap[cmap_num]
+    uint16_t cmap_num;
+    uint16_t kern_scale;
+    uint32_t kern_ids_off;    // 0 = no kerning
+    uint32_t kern_values_off;
+    uint32_t kern_pair_cnt;
+    uint8_t  kern_ids_size;   // 0: uint8 glyph ids, 1: uint16
+    uint8_t  bpp;
+    uint8_t  bitmap_format;
+    uint8_t  reserved;
+};
+struct PackCmap {
+    uint32_t range_start;
+    uint16_t range_length;
+    uint16_t glyph_id_start;
+    uint32_t unicode_list_off;
+    uint32_t glyph_id_ofs_off;
+    uint16_t list_length;
+    uint8_t  type;            // lv_font_fmt_txt_cmap_type_t
+    uint8_t  reserved;
+};
+struct PackImage {
+    char     name[32];
+    uint32_t data_off;
+    uint32_t data_size;
+};
+#pragma pack(pop)
+
+class AssetPack {
+public:
+    static AssetPack& instance();
+
+    // Map the pack and bind fonts/images.  Call after lv_init() and
+    // before ui_init().
+    bool load(const char* path);
+
+    // Point statically zoomed/rotated image widgets at their pre-transformed
+    // variants (zoom 256, angle 0).  Call after a screen is created;
+    // widgets that do not exist or are already swapped are skipped.
+    int apply_fixups();
+
+    size_t   mapped_bytes() const { return size_; }
+    // Pack pages currently in the page cache (mincore), i.e. glyphs used so far.
+    uint64_t resident_bytes() const;
+
+private:
+    AssetPack() = default;
+
+    const uint8_t* map_  = nullptr;
+    size_t         size_ = 0;
+};
+
+} // namespace cinepi
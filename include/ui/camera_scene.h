@@ -4,6 +4,8 @@
  * Grid overlay and level indicator drawn on LVGL.
  */
 
+#include <cstdint>
+
 namespace cinepi {
 
 class CameraPipeline;
@@ -22,6 +24,10 @@ private:
 
     bool grid_visible_ = false;
     bool level_visible_ = false;
+
+    // Last values pushed to LVGL; unchanged values must not invalidate.
+    int      level_y_ = -1000;
+    uint32_t level_color_ = 0;
 };
 
 } // namespace cinepi
@@ -20,16 +20,23 @@ public:
     void init();
     void enter();
     void leave();
+    // Screen destroyed: drop widget pointers, recreated on next enter
+    void release();
 
     void load_photo_list();
     void show_current();
     void next();
     void prev();
+    // Move n photos (negative = back), clamped; decodes only the target
+    void step(int n);
     void delete_current();
 
     int count() const { return static_cast<int>(photos_.size()); }
     int index() const { return current_idx_; }
 
+    // Decoded image currently held for display.
+    size_t image_bytes() const;
+
 private:
     bool decode_jpeg_scaled(const std::string& path, int target_w,
                             uint8_t** out_buf, int* out_w, int* out_h);
@@ -4,6 +4,7 @@
  * Connects LVGL to DRM framebuffer and touch input.
  */
 
+#include <cstddef>
 #include <cstdint>
 
 // Forward-declare LVGL opaque types to avoid including lvgl.h in header
@@ -26,8 +27,26 @@ public:
     bool init(DrmDisplay& display, TouchInput* touch);
     void deinit();
 
-    // Call in main loop
-    void tick();
+    // Run due LVGL timers.  Returns ms until LVGL needs to run again
+    // (UINT32_MAX when nothing is scheduled, e.g. static screen or paused).
+    uint32_t tick();
+
+    // Touch activity seen on the evdev fd: read input on the next tick().
+    void notify_input();
+
+    // Panel refresh rate used while animations or gestures are running.
+    void set_panel_rate(int hz);
+
+    // True while an animation or touch gesture needs panel-rate refresh.
+    bool is_active() const { return active_; }
+
+    uint64_t tick_count() const { return tick_count_; }
+
+    // Memory: the two partial draw buffers, and the LV_MEM_SIZE heap
+    // (used / total, from lv_mem_monitor).
+    size_t draw_buf_bytes() const { return draw_buf_bytes_; }
+    size_t heap_used() const;
+    size_t heap_total() const;
 
     // Pause/resume rendering (for standby)
     void pause();
@@ -40,12 +59,26 @@ private:
     static void flush_cb(void* drv, const void* area, void* color_p);
     static void input_read_cb(void* drv, void* data);
 
+    void update_activity(uint64_t now);
+
     DrmDisplay* display_ = nullptr;
     TouchInput* touch_ = nullptr;
     bool paused_ = false;
     bool initialized_ = false;
 
+    // LVGL handles (opaque here, lv_disp_t* / lv_indev_t* in .cpp)
+    void* disp_ = nullptr;
+    void* indev_ = nullptr;
+
+    // Invalidation-driven pacing state
+    int      panel_period_ms_ = 16;
+    bool     active_ = false;
+    bool     input_polling_ = false;
+    uint64_t last_input_ms_ = 0;
+    uint64_t tick_count_ = 0;
+
     // LVGL draw buffers (allocated as lv_color_t in .cpp)
+    size_t draw_buf_bytes_ = 0;
     void* buf1_ = nullptr;
     void* buf2_ = nullptr;
 };
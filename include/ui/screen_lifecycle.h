@@ -0,0 +1,78 @@
+#pragma once
+/**
+ * CinePi Camera - Screen Lifecycle
+ * SquareLine screens are created on first navigation (_ui_screen_change
+ * builds a screen whose pointer is NULL) and destroyed again with their
+ * ui_*_screen_destroy() once hidden for SCREEN_IDLE_DESTROY_SEC, or at once
+ * while the LVGL heap is above UI_HEAP_PRESSURE_PCT.  Tracks how much LVGL
+ * heap each screen's build took.
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+struct _lv_obj_t;
+
+namespace cinepi {
+
+class LvglDriver;
+class Gauge;
+
+class ScreenLifecycle {
+public:
+    static ScreenLifecycle& instance();
+
+    // Theme and home screen only; replaces ui_init().
+    void init_home();
+
+    void set_lvgl(LvglDriver* lvgl) { lvgl_ = lvgl; }
+
+    // Register a screen.  Resident screens are never destroyed; on_destroy
+    // runs before the screen is deleted so scenes can drop widget pointers.
+    void add(const char* name, _lv_obj_t** obj, void (*destroy)(), bool resident,
+             std::function<void()> on_destroy = {});
+
+    // Once per UI step, before the LVGL tick.
+    void update(uint64_t now_us);
+
+    // Around the LVGL tick: SquareLine's click handlers build screens inside
+    // it, so the heap grown across it is the new screen's footprint.
+    void begin_tick();
+    void end_tick(uint64_t now_us);
+
+    // Around the scene enter() calls: the first enter after a build adds
+    // its widgets (settings list, gallery image) to that screen's footprint.
+    void begin_enter();
+    void end_enter(_lv_obj_t* screen);
+
+    void report() const;
+
+private:
+    ScreenLifecycle() = default;
+
+    struct Screen {
+        const char* name;
+        _lv_obj_t** obj;
+        void (*destroy)();
+        bool resident;
+        std::function<void()> on_destroy;
+        bool     live = false;
+        uint64_t last_active_us = 0;
+        size_t   heap_bytes = 0;     // LVGL heap taken by the last build
+        bool     entered = false;    // scene enter() counted since the build
+        uint32_t builds = 0;
+        Gauge*   heap_gauge = nullptr;
+    };
+
+    void destroy(Screen& s, const char* why);
+
+    LvglDriver* lvgl_ = nullptr;
+    std::vector<Screen> screens_;
+    size_t tick_heap_ = 0;       // LVGL heap at begin_tick()
+    size_t enter_heap_ = 0;      // LVGL heap at begin_enter()
+    size_t home_heap_ = 0;       // ui_main_screen_init() in init_home
+};
+
+} // namespace cinepi
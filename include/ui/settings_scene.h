@@ -14,6 +14,8 @@ public:
     void enter();
     void leave();
     void create_settings_ui();
+    // Screen destroyed: widgets are gone, rebuild on next enter
+    void release();
 
 private:
     bool initialized_ = false;
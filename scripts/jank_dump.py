@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+"""Decode the CinePi jank log (/tmp/cinepi-jank.bin).
+
+Layout matches include/core/jank_detector.h (packed, little-endian).
+Usage: jank_dump.py [log] [--trace]
+"""
+
+import struct
+import sys
+
+REC = struct.Struct("<IIQIII B15s BBH")
+PHASE = struct.Struct("<24sII")
+NOTE = struct.Struct("<16s48sQI")
+TRACE = struct.Struct("<32sQIi")
+MAGIC = 0x314B4E4A
+
+
+def cstr(b):
+    return b.split(b"\0", 1)[0].decode(errors="replace")
+
+
+def main():
+    args = [a for a in sys.argv[1:] if not a.startswith("--")]
+    show_trace = "--trace" in sys.argv
+    path = args[0] if args else "/tmp/cinepi-jank.bin"
+    data = open(path, "rb").read()
+
+    off = 0
+    while off + REC.size <= len(data):
+        (magic, size, start_us, frame_us, minflt, majflt,
+         scene, scene_name, n_phases, n_notes, n_trace) = REC.unpack_from(data, off)
+        if magic != MAGIC or size < REC.size:
+            print(f"bad record at offset {off}", file=sys.stderr)
+            break
+        p = off + REC.size
+
+        print(f"@{start_us / 1e6:.3f}s  {frame_us / 1000:.1f} ms  scene={cstr(scene_name)}"
+              f"  faults={minflt}/{majflt}")
+
+        phases = []
+        for _ in range(n_phases):
+            name, excl, total = PHASE.unpack_from(data, p)
+            p += PHASE.size
+            phases.append((excl, total, cstr(name)))
+        for excl, total, name in sorted(phases, reverse=True):
+            print(f"    {name:<24} {excl / 1000:8.2f} ms excl  {total / 1000:8.2f} ms total")
+
+        for _ in range(n_notes):
+            what, detail, ts_us, dur_us = NOTE.unpack_from(data, p)
+            p += NOTE.size
+            ago = (start_us - ts_us) / 1e6
+            print(f"    note {cstr(what)}: {cstr(detail)} {dur_us / 1000:.1f} ms, {ago:+.2f}s before")
+
+        for _ in range(n_trace):
+            name, ts_us, dur_us, tid = TRACE.unpack_from(data, p)
+            p += TRACE.size
+            if show_trace:
+                print(f"    trace tid {tid:<6} {cstr(name):<32} +{(ts_us - start_us) / 1000:7.2f} ms"
+                      f"  {dur_us / 1000:.2f} ms")
+        if n_trace and not show_trace:
+            print(f"    {n_trace} trace events (--trace to list)")
+
+        off += size
+
+
+if __name__ == "__main__":
+    main()
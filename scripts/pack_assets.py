@@ -0,0 +1,388 @@
+#!/usr/bin/env python3
+"""Pack SquareLine font/image C files into one mmap-able asset pack.
+
+Reads the lv_font_conv / lv_img_conv sources in UI/fonts and UI/images and
+writes two files:
+  --pack  the binary pack (layout: include/ui/asset_pack.h)
+  --c     a small C file with the lv_font_t / lv_img_dsc_t symbols the
+          screens reference; their tables are bound to the pack at runtime
+          by AssetPack::load().
+Prints the size of the data moved out of the binary.  Stdlib only.
+
+With --screens, images the screens only ever show at a fixed zoom/angle
+(lv_img_set_zoom / lv_img_set_angle right after creation) are resampled
+here into variants at their final size and orientation; the generated
+fixup table lets AssetPack::apply_fixups() swap them in with zoom 256 and
+angle 0, so LVGL blits them instead of transforming on every redraw.
+
+Usage: pack_assets.py --pack out.pack --c out.c UI/fonts/*.c [UI/images/*.c]
+                      [--lv-conf lv_conf.h] [--screens UI/screens/*.c]
+"""
+
+import argparse
+import math
+import re
+import struct
+import sys
+import zlib
+
+MAGIC = 0x4B504143  # "CAPK"
+VERSION = 1
+HEADER = struct.Struct("<IHHHHI")
+FONT = struct.Struct("<32sIIIIIHHIIIBBBB")
+CMAP = struct.Struct("<IHHIIHBB")
+IMAGE = struct.Struct("<32sII")
+
+CMAP_TYPES = {
+    "LV_FONT_FMT_TXT_CMAP_FORMAT0_FULL": 0,
+    "LV_FONT_FMT_TXT_CMAP_SPARSE_FULL": 1,
+    "LV_FONT_FMT_TXT_CMAP_FORMAT0_TINY": 2,
+    "LV_FONT_FMT_TXT_CMAP_SPARSE_TINY": 3,
+}
+C_TYPES = {"uint8_t": "B", "int8_t": "b", "uint16_t": "H", "int16_t": "h"}
+ZOOM_NONE = 256
+MAX_SUPERSAMPLE = 16
+
+
+def strip_comments(src):
+    return re.sub(r"/\*.*?\*/", "", src, flags=re.S)
+
+
+def c_array(src, name):
+    """Return (struct format char, values) of `<type> name[] = {...};`."""
+    m = re.search(r"(u?int(?:8|16)_t)\s+" + re.escape(name) + r"\[\]\s*=\s*\{(.*?)\};", src, re.S)
+    if not m:
+        raise ValueError(f"array {name} not found")
+    vals = [int(v, 0) for v in re.findall(r"-?(?:0x[0-9a-fA-F]+|\d+)", m.group(2))]
+    return C_TYPES[m.group(1)], vals
+
+
+def field(src, name, default=None):
+    m = re.search(r"\." + name + r"\s*=\s*([-&\w]+)", src)
+    if not m:
+        if default is None:
+            raise ValueError(f"field .{name} not found")
+        return default
+    return m.group(1)
+
+
+class Pack:
+    def __init__(self):
+        self.data = bytearray()
+
+    def add(self, blob, align=4):
+        while len(self.data) % align:
+            self.data.append(0)
+        off = len(self.data)
+        self.data += blob
+        return off
+
+
+def parse_font(path, pack, base):
+    src = strip_comments(open(path).read())
+    name = re.search(r"lv_font_t\s+(\w+)\s*=", src).group(1)
+    if field(src, "kern_classes", "0") != "0":
+        raise ValueError(f"{path}: kerning classes are not supported")
+
+    fmt, bitmap = c_array(src, "glyph_bitmap")
+    bitmap_off = pack.add(bytes(bitmap))
+
+    glyphs = re.findall(r"\{\.bitmap_index = (\d+), \.adv_w = (\d+), \.box_w = (\d+), "
+                        r"\.box_h = (\d+), \.ofs_x = (-?\d+), \.ofs_y = (-?\d+)\}", src)
+    gblob = bytearray()
+    for bi, adv, bw, bh, ox, oy in glyphs:
+        # lv_font_fmt_txt_glyph_dsc_t with LV_FONT_FMT_TXT_LARGE == 0
+        gblob += struct.pack("<IBBbb", int(bi) | (int(adv) << 20), int(bw), int(bh), int(ox), int(oy))
+    glyph_off = pack.add(gblob)
+
+    cmaps = re.findall(r"\.range_start = (\d+), \.range_length = (\d+), \.glyph_id_start = (\d+),\s*"
+                       r"\.unicode_list = (\w+), \.glyph_id_ofs_list = (\w+), "
+                       r"\.list_length = (\d+), \.type = (\w+)", src)
+    cblob = bytearray()
+    for start, length, gid, ulist, olist, llen, ctype in cmaps:
+        ulist_off = olist_off = 0
+        if ulist != "NULL":
+            f, vals = c_array(src, ulist)
+            ulist_off = base + pack.add(struct.pack("<%d%s" % (len(vals), f), *vals))
+        if olist != "NULL":
+            f, vals = c_array(src, olist)
+            olist_off = base + pack.add(struct.pack("<%d%s" % (len(vals), f), *vals))
+        cblob += CMAP.pack(int(start), int(length), int(gid), ulist_off, olist_off,
+                           int(llen), CMAP_TYPES[ctype], 0)
+    cmap_off = pack.add(cblob)
+
+    kern_ids_off = kern_vals_off = pair_cnt = ids_size = 0
+    if field(src, "kern_dsc", "NULL") != "NULL":
+        f, ids = c_array(src, "kern_pair_glyph_ids")
+        kern_ids_off = base + pack.add(struct.pack("<%d%s" % (len(ids), f), *ids))
+        f, vals = c_array(src, "kern_pair_values")
+        kern_vals_off = base + pack.add(struct.pack("<%db" % len(vals), *vals))
+        pair_cnt = int(field(src, "pair_cnt"))
+        ids_size = int(field(src, "glyph_ids_size"))
+
+    entry = FONT.pack(name.encode(), base + bitmap_off, len(bitmap), base + glyph_off, len(glyphs),
+                      base + cmap_off, len(cmaps), int(field(src, "kern_scale", "0")),
+                      kern_ids_off, kern_vals_off, pair_cnt, ids_size,
+                      int(field(src, "bpp")), int(field(src, "bitmap_format", "0")), 0)
+    meta = {
+        "name": name,
+        "line_height": field(src, "line_height"),
+        "base_line": field(src, "base_line"),
+        "subpx": field(src, "subpx", "LV_FONT_SUBPX_NONE"),
+        "underline_position": field(src, "underline_position", "0"),
+        "underline_thickness": field(src, "underline_thickness", "0"),
+    }
+    return entry, meta
+
+
+def parse_image(path, pack, base):
+    src = strip_comments(open(path).read())
+    m = re.search(r"lv_img_dsc_t\s+(\w+)\s*=\s*\{(.*?)\};", src, re.S)
+    name, body = m.group(1), m.group(2)
+    data_name = re.search(r"\.data\s*=\s*(\w+)", body).group(1)
+    _, data = c_array(src, data_name)
+    off = pack.add(bytes(data))
+    meta = {
+        "name": name,
+        "w": field(body, r"header\.w"),
+        "h": field(body, r"header\.h"),
+        "cf": field(body, r"header\.cf"),
+        "size": len(data),
+        "data": bytes(data),
+    }
+    return IMAGE.pack(name.encode(), base + off, len(data)), meta
+
+
+# ─── Static transforms ──────────────────────────────────────────────
+
+def color_format(lv_conf):
+    """(LV_COLOR_DEPTH, LV_COLOR_16_SWAP) from lv_conf.h."""
+    src = open(lv_conf).read() if lv_conf else ""
+    depth = re.search(r"#define\s+LV_COLOR_DEPTH\s+(\d+)", src)
+    swap = re.search(r"#define\s+LV_COLOR_16_SWAP\s+(\d+)", src)
+    return int(depth.group(1)) if depth else 16, bool(swap and int(swap.group(1)))
+
+
+def scan_screens(paths):
+    """Image widgets with a constant zoom/angle: [(obj, img, zoom, angle)]."""
+    found = []
+    for path in paths:
+        src = strip_comments(open(path).read())
+        for obj in re.findall(r"(\w+)\s*=\s*lv_img_create\(", src):
+            def call(fn, arg):
+                m = re.search(fn + r"\(\s*" + obj + r"\s*,\s*" + arg + r"\s*\)", src)
+                return m.group(1) if m else None
+            img = call("lv_img_set_src", r"&(\w+)")
+            zoom = int(call("lv_img_set_zoom", r"(\d+)") or ZOOM_NONE)
+            angle = int(call("lv_img_set_angle", r"(-?\d+)") or 0) % 3600
+            if not img or (zoom == ZOOM_NONE and angle == 0):
+                continue
+            # Only content-sized, centre-pivoted widgets keep their on-screen
+            # footprint when the object shrinks to the variant
+            content = all(call(fn, "(LV_SIZE_CONTENT)") for fn in ("lv_obj_set_width", "lv_obj_set_height"))
+            if not content or call("lv_img_set_pivot", r"([^)]*)"):
+                print(f"pack_assets: {obj}: fixed size or custom pivot, left to the runtime transform")
+                continue
+            found.append((obj, img, zoom, angle))
+    return found
+
+
+def decode(meta, depth, swap):
+    """Premultiplied float RGBA rows of an lv_img_conv image."""
+    w, h, cf, data = int(meta["w"]), int(meta["h"]), meta["cf"], meta["data"]
+    alpha = cf == "LV_IMG_CF_TRUE_COLOR_ALPHA"
+    if not alpha and cf != "LV_IMG_CF_TRUE_COLOR":
+        raise ValueError(f"{meta['name']}: cannot transform colour format {cf}")
+    px_size = (2 if depth == 16 else 4) + (1 if alpha and depth == 16 else 0)
+    pixels = []
+    for i in range(w * h):
+        p = data[i * px_size:(i + 1) * px_size]
+        if depth == 16:
+            c = (p[0] << 8 | p[1]) if swap else (p[1] << 8 | p[0])
+            r, g, b = (c >> 11) * 255 / 31, ((c >> 5) & 0x3F) * 255 / 63, (c & 0x1F) * 255 / 31
+            a = p[2] / 255 if alpha else 1.0
+        else:
+            b, g, r = p[0], p[1], p[2]
+            a = p[3] / 255 if alpha else 1.0
+        pixels.append((r * a, g * a, b * a, a))
+    return w, h, pixels
+
+
+def encode(pixels, depth, swap):
+    """TRUE_COLOR_ALPHA bytes from premultiplied float RGBA."""
+    out = bytearray()
+    for r, g, b, a in pixels:
+        if a > 0:
+            r, g, b = r / a, g / a, b / a
+        a8 = min(255, int(a * 255 + 0.5))
+        if depth == 16:
+            c = (min(31, int(r * 31 / 255 + 0.5)) << 11 | min(63, int(g * 63 / 255 + 0.5)) << 5
+                 | min(31, int(b * 31 / 255 + 0.5)))
+            out += bytes((c >> 8, c & 0xFF, a8) if swap else (c & 0xFF, c >> 8, a8))
+        else:
+            out += bytes((min(255, int(b + 0.5)), min(255, int(g + 0.5)), min(255, int(r + 0.5)), a8))
+    return bytes(out)
+
+
+def transform(meta, zoom, angle, depth, swap):
+    """Resample about the centre (LVGL's default pivot); returns (w, h, bytes).
+
+    Each output pixel is mapped back into the source on an n x n grid with
+    n ~ 1/scale, so a downscale averages every source pixel it covers (the
+    runtime path samples one point and aliases)."""
+    w, h, src = decode(meta, depth, swap)
+    scale = zoom / ZOOM_NONE
+    rad = math.radians(angle / 10)
+    cos, sin = math.cos(rad), math.sin(rad)
+    ow = max(1, round(abs(w * scale * cos) + abs(h * scale * sin)))
+    oh = max(1, round(abs(w * scale * sin) + abs(h * scale * cos)))
+    n = max(1, min(MAX_SUPERSAMPLE, math.ceil(1 / scale)))
+    offs = [(i + 0.5) / n for i in range(n)]
+    out = []
+    for oy in range(oh):
+        for ox in range(ow):
+            acc = [0.0, 0.0, 0.0, 0.0]
+            for sy in offs:
+                for sx in offs:
+                    dx, dy = ox + sx - ow / 2, oy + sy - oh / 2
+                    # inverse of LVGL's clockwise rotation, then unscale
+                    x = int(math.floor((dx * cos + dy * sin) / scale + w / 2))
+                    y = int(math.floor((-dx * sin + dy * cos) / scale + h / 2))
+                    if 0 <= x < w and 0 <= y < h:
+                        p = src[y * w + x]
+                        for k in range(4):
+                            acc[k] += p[k]
+            out.append(tuple(v / (n * n) for v in acc))
+    return ow, oh, encode(out, depth, swap)
+
+
+def add_variants(found, img_meta, pack, depth, swap):
+    """Append pre-transformed images; returns (entries, metas, fixups)."""
+    by_name = {m["name"]: m for m in img_meta}
+    made, entries, metas, fixups = {}, [], [], []
+    for obj, img, zoom, angle in found:
+        if img not in by_name:
+            print(f"pack_assets: {obj}: source {img} not in the image set, "
+                  f"left to the runtime transform")
+            continue
+        key = (img, zoom, angle)
+        if key not in made:
+            name = img + (f"_a{angle}" if angle else "") + (f"_z{zoom}" if zoom != ZOOM_NONE else "")
+            if len(name) > 31:
+                raise ValueError(f"variant name {name} exceeds the 31 character pack limit")
+            src = by_name[img]
+            vw, vh, data = transform(src, zoom, angle, depth, swap)
+            entries.append((name, pack.add(data), len(data)))
+            metas.append({"name": name, "w": str(vw), "h": str(vh),
+                          "cf": "LV_IMG_CF_TRUE_COLOR_ALPHA", "size": len(data)})
+            made[key] = name
+            print(f"pack_assets: {name}: {src['w']}x{src['h']} zoom {zoom} angle "
+                  f"{angle / 10:g} -> {vw}x{vh}")
+        fixups.append((obj, made[key]))
+    return entries, metas, fixups
+
+
+def write_c(path, fonts, images, fixups, crc):
+    out = ["/* Generated by scripts/pack_assets.py - do not edit.",
+           " * Font and image tables live in the asset pack and are bound by",
+           " * AssetPack::load(); until then fonts fall back to LV_FONT_DEFAULT. */",
+           "",
+           '#include "lvgl/lvgl.h"',
+           "",
+           "const uint32_t ui_asset_pack_crc = 0x%08x;" % crc,
+           ""]
+    for i, f in enumerate(fonts):
+        out += [f"static lv_font_fmt_txt_glyph_cache_t cache_{i};",
+                f"static lv_font_fmt_txt_dsc_t dsc_{i} = {{ .cache = &cache_{i} }};",
+                f"const lv_font_t {f['name']} = {{",
+                "    .get_glyph_dsc = lv_font_get_glyph_dsc_fmt_txt,",
+                "    .get_glyph_bitmap = lv_font_get_bitmap_fmt_txt,",
+                f"    .line_height = {f['line_height']},",
+                f"    .base_line = {f['base_line']},",
+                f"    .subpx = {f['subpx']},",
+                f"    .underline_position = {f['underline_position']},",
+                f"    .underline_thickness = {f['underline_thickness']},",
+                f"    .dsc = &dsc_{i},",
+                "    .fallback = LV_FONT_DEFAULT,",
+                "};",
+                ""]
+    for img in images:
+        out += [f"lv_img_dsc_t {img['name']} = {{",
+                "    .header.always_zero = 0,",
+                f"    .header.w = {img['w']},",
+                f"    .header.h = {img['h']},",
+                f"    .header.cf = {img['cf']},",
+                f"    .data_size = {img['size']},",
+                "    .data = NULL,",
+                "};",
+                ""]
+
+    def table(ctype, name, items):
+        return [f"{ctype} {name}[] = {{ " + (", ".join(items) if items else "NULL") + " };"]
+
+    out += table("lv_font_fmt_txt_dsc_t * const", "ui_asset_font_dsc",
+                 [f"&dsc_{i}" for i in range(len(fonts))])
+    out += table("const char * const", "ui_asset_font_names", [f'"{f["name"]}"' for f in fonts])
+    out += [f"const int ui_asset_font_count = {len(fonts)};", ""]
+    out += table("lv_img_dsc_t * const", "ui_asset_img_dsc", [f"&{m['name']}" for m in images])
+    out += table("const char * const", "ui_asset_img_names", [f'"{m["name"]}"' for m in images])
+    out += [f"const int ui_asset_img_count = {len(images)};", ""]
+    out += [f"extern lv_obj_t * {obj};" for obj in sorted({o for o, _ in fixups})]
+    out += table("lv_obj_t ** const", "ui_asset_fixup_obj", [f"&{o}" for o, _ in fixups])
+    out += table("lv_img_dsc_t * const", "ui_asset_fixup_img", [f"&{v}" for _, v in fixups])
+    out += [f"const int ui_asset_fixup_count = {len(fixups)};", ""]
+    open(path, "w").write("\n".join(out))
+
+
+def main():
+    ap = argparse.ArgumentParser()
+    ap.add_argument("--pack", required=True)
+    ap.add_argument("--c", required=True)
+    ap.add_argument("--lv-conf")
+    ap.add_argument("--screens", nargs="*", default=[])
+    ap.add_argument("sources", nargs="+")
+    args = ap.parse_args()
+
+    font_src = [s for s in args.sources if "lv_font_t" in open(s).read()]
+    img_src = [s for s in args.sources if s not in font_src]
+    found = scan_screens(args.screens)
+    img_names = {re.search(r"lv_img_dsc_t\s+(\w+)", open(s).read()).group(1) for s in img_src}
+    n_variants = len({(i, z, a) for _, i, z, a in found if i in img_names})
+
+    base = (HEADER.size + FONT.size * len(font_src)
+            + IMAGE.size * (len(img_src) + n_variants))
+    pack = Pack()
+    font_entries, font_meta, img_entries, img_meta = [], [], [], []
+    for path in font_src:
+        entry, meta = parse_font(path, pack, base)
+        font_entries.append(entry)
+        font_meta.append(meta)
+    for path in img_src:
+        entry, meta = parse_image(path, pack, base)
+        img_entries.append(entry)
+        img_meta.append(meta)
+    depth, swap = color_format(args.lv_conf)
+    variants, variant_meta, fixups = add_variants(found, img_meta, pack, depth, swap)
+    for name, off, size in variants:
+        img_entries.append(IMAGE.pack(name.encode(), base + off, size))
+    img_meta += variant_meta
+
+    body = b"".join(font_entries) + b"".join(img_entries) + bytes(pack.data)
+    crc = zlib.crc32(body) & 0xFFFFFFFF
+    header = HEADER.pack(MAGIC, VERSION, len(font_entries), len(img_entries), 0, crc)
+    with open(args.pack, "wb") as f:
+        f.write(header + body)
+    write_c(args.c, font_meta, img_meta, fixups, crc)
+
+    src_bytes = sum(len(open(s, "rb").read()) for s in args.sources)
+    print(f"pack_assets: {len(font_entries)} fonts, {len(img_entries)} images; "
+          f"{len(pack.data)} bytes of tables moved out of the binary into a "
+          f"{len(header) + len(body)} byte pack ({src_bytes} bytes of C sources); "
+          f"{len(fixups)} widgets pre-transformed")
+
+
+if __name__ == "__main__":
+    try:
+        main()
+    except ValueError as e:
+        sys.exit(f"pack_assets: {e}")
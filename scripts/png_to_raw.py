@@ -0,0 +1,100 @@
+#!/usr/bin/env python3
+"""Convert a PNG to the raw boot-splash framebuffer read by DrmDisplay.
+
+Output: 16-byte header (magic "CSPL", width, height, stride; u32 LE)
+followed by XRGB8888 pixels (B, G, R, 0xFF per pixel), so the display
+driver can copy rows straight into the scanout buffer without decoding.
+Alpha is composited over black.  Stdlib only (zlib).
+
+Usage: png_to_raw.py input.png output.raw
+"""
+
+import struct
+import sys
+import zlib
+
+MAGIC = 0x4C505343  # "CSPL"
+CHANNELS = {0: 1, 2: 3, 4: 2, 6: 4}  # grey, RGB, grey+alpha, RGBA
+
+
+def paeth(a, b, c):
+    p = a + b - c
+    pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+    if pa <= pb and pa <= pc:
+        return a
+    return b if pb <= pc else c
+
+
+def read_png(path):
+    data = open(path, "rb").read()
+    if data[:8] != b"\x89PNG\r\n\x1a\n":
+        sys.exit(f"{path}: not a PNG")
+
+    off, idat = 8, b""
+    while off < len(data):
+        length, kind = struct.unpack_from(">I4s", data, off)
+        body = data[off + 8:off + 8 + length]
+        if kind == b"IHDR":
+            width, height, depth, ctype, _, _, interlace = struct.unpack(">IIBBBBB", body)
+        elif kind == b"IDAT":
+            idat += body
+        elif kind == b"IEND":
+            break
+        off += 12 + length
+
+    if depth != 8 or ctype not in CHANNELS or interlace:
+        sys.exit(f"{path}: only 8-bit, non-interlaced grey/RGB(A) PNGs are supported")
+
+    bpp = CHANNELS[ctype]
+    row_len = width * bpp
+    raw = zlib.decompress(idat)
+    rows, prev, pos = [], bytearray(row_len), 0
+    for _ in range(height):
+        ftype = raw[pos]
+        line = bytearray(raw[pos + 1:pos + 1 + row_len])
+        pos += 1 + row_len
+        for i in range(row_len):
+            a = line[i - bpp] if i >= bpp else 0
+            b = prev[i]
+            c = prev[i - bpp] if i >= bpp else 0
+            if ftype == 1:
+                line[i] = (line[i] + a) & 0xFF
+            elif ftype == 2:
+                line[i] = (line[i] + b) & 0xFF
+            elif ftype == 3:
+                line[i] = (line[i] + ((a + b) >> 1)) & 0xFF
+            elif ftype == 4:
+                line[i] = (line[i] + paeth(a, b, c)) & 0xFF
+        rows.append(line)
+        prev = line
+    return width, height, ctype, rows
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__)
+    width, height, ctype, rows = read_png(sys.argv[1])
+    bpp = CHANNELS[ctype]
+
+    out = bytearray(struct.pack("<IIII", MAGIC, width, height, width * 4))
+    for line in rows:
+        px = bytearray(width * 4)
+        for x in range(width):
+            s = line[x * bpp:(x + 1) * bpp]
+            if ctype in (0, 4):
+                r = g = b = s[0]
+            else:
+                r, g, b = s[0], s[1], s[2]
+            alpha = s[-1] if ctype in (4, 6) else 255
+            px[x * 4 + 0] = b * alpha // 255
+            px[x * 4 + 1] = g * alpha // 255
+            px[x * 4 + 2] = r * alpha // 255
+            px[x * 4 + 3] = 0xFF
+        out += px
+
+    with open(sys.argv[2], "wb") as f:
+        f.write(out)
+
+
+if __name__ == "__main__":
+    main()
@@ -4,11 +4,22 @@
  */
 
 #include "camera/camera_pipeline.h"
+#include "camera/photo_capture.h"
 #include "core/constants.h"
+#include "core/event_loop.h"
+#include "core/metrics.h"
+#include "core/trace.h"
+#include "core/thread_registry.h"
+#include "drivers/sensor_ring.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
+#include <cerrno>
 #include <vector>
+#include <unistd.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
 
 #include <libcamera/libcamera.h>
 
@@ -16,6 +27,19 @@ using namespace libcamera;
 
 namespace cinepi {
 
+static Counter& g_frames = Metrics::instance().counter(
+    "cinepi_camera_frames_total", "Completed preview requests");
+static Histogram& g_frame_interval = Metrics::instance().histogram(
+    "cinepi_camera_frame_interval_seconds", "Time between completed preview requests");
+static Histogram& g_capture_latency = Metrics::instance().histogram(
+    "cinepi_capture_latency_seconds", "Shutter press (or request) to JPEG on disk, single-stage");
+static Histogram& g_capture_latency_prepared = Metrics::instance().histogram(
+    "cinepi_capture_latency_prepared_seconds", "Full press to JPEG on disk after a half-press prepared the capture");
+static Histogram& g_encode_time = Metrics::instance().histogram(
+    "cinepi_jpeg_encode_seconds", "JPEG encode + write time");
+static Gauge& g_encode_queue = Metrics::instance().gauge(
+    "cinepi_encoder_queue_depth", "Frames waiting for the JPEG encoder");
+
 CameraPipeline::CameraPipeline() = default;
 
 CameraPipeline::~CameraPipeline() {
@@ -23,6 +47,12 @@ CameraPipeline::~CameraPipeline() {
 }
 
 bool CameraPipeline::init() {
+    frame_efd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (frame_efd_ < 0) {
+        fprintf(stderr, "[Camera] eventfd failed: %s\n", strerror(errno));
+        return false;
+    }
+
     cm_ = std::make_unique<CameraManager>();
     if (cm_->start() != 0) {
         fprintf(stderr, "[Camera] CameraManager start failed\n");
@@ -101,6 +131,14 @@ bool CameraPipeline::init() {
         return false;
     }
 
+    dmabuf_bytes_ = 0;
+    for (const auto& buf : allocator_->buffers(preview_stream_)) {
+        for (const auto& plane : buf->planes()) dmabuf_bytes_ += plane.length;
+    }
+
+    enc_stop_ = false;
+    encoder_ = ThreadRegistry::instance().spawn("encoder", [this]() { encoder_thread(); });
+
     fprintf(stderr, "[Camera] Initialized: %dx%d %s, %zu buffers\n",
             stream_cfg.size.width, stream_cfg.size.height,
             stream_cfg.pixelFormat.toString().c_str(),
@@ -111,6 +149,17 @@ bool CameraPipeline::init() {
 
 void CameraPipeline::deinit() {
     stop_preview();
+    unmap_preview();
+    release_capture();
+
+    if (encoder_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lk(enc_mtx_);
+            enc_stop_ = true;
+        }
+        enc_cv_.notify_all();
+        encoder_.join();
+    }
 
     if (allocator_) {
         allocator_->free(preview_stream_);
@@ -126,6 +175,11 @@ void CameraPipeline::deinit() {
         cm_->stop();
         cm_.reset();
     }
+
+    if (frame_efd_ >= 0) {
+        close(frame_efd_);
+        frame_efd_ = -1;
+    }
 }
 
 bool CameraPipeline::start_preview() {
@@ -140,6 +194,10 @@ bool CameraPipeline::start_preview() {
     }
 
     // Queue all buffers
+    // The IPA keeps the last AE/AWB lock and FrameDurationLimits across
+    // stop/start, so resend whatever is current on the first request
+    ae_lock_applied_ = -1;
+    fps_limit_applied_ = -1;
     const auto& buffers = allocator_->buffers(preview_stream_);
     for (auto& buf : buffers) {
         std::unique_ptr<Request> request = camera_->createRequest();
@@ -148,7 +206,7 @@ bool CameraPipeline::start_preview() {
             continue;
         }
         request->addBuffer(preview_stream_, buf.get());
-        configure_controls();
+        configure_controls(request.get(), FrameTiming());
         int ret = camera_->queueRequest(request.get());
         if (ret != 0) {
             fprintf(stderr, "[Camera] Failed to queue request: %d\n", ret);
@@ -171,8 +229,21 @@ void CameraPipeline::stop_preview() {
 }
 
 void CameraPipeline::request_complete(Request* request) {
+    // libcamera owns this thread; apply the "presenter" plan on first use
+    static thread_local bool registered = false;
+    if (!registered) {
+        ThreadRegistry::instance().register_current("presenter");
+        registered = true;
+    }
+
     if (!running_) return;
     if (request->status() == Request::RequestCancelled) return;
+    TRACE_SCOPE("camera.request_complete");
+
+    uint64_t now_us = metrics_now_us();
+    if (last_frame_us_) g_frame_interval.record_us(now_us - last_frame_us_);
+    last_frame_us_ = now_us;
+    g_frames.inc();
 
     const auto& buffers = request->buffers();
     auto it = buffers.find(preview_stream_);
@@ -181,6 +252,27 @@ void CameraPipeline::request_complete(Request* request) {
     FrameBuffer* buffer = it->second;
     const auto& planes = buffer->planes();
 
+    FrameTiming timing;
+    timing.sequence = buffer->metadata().sequence;
+    const ControlList& meta = request->metadata();
+    if (auto ts = meta.get(controls::SensorTimestamp)) timing.sensor_ts_ns = static_cast<uint64_t>(*ts);
+    if (auto exp = meta.get(controls::ExposureTime)) timing.exposure_us = static_cast<uint32_t>(*exp);
+    if (auto fd = meta.get(controls::FrameDuration)) timing.frame_duration_us = static_cast<uint32_t>(*fd);
+    if (auto g = meta.get(controls::AnalogueGain)) last_gain_ = *g;
+    if (auto cg = meta.get(controls::ColourGains)) {
+        last_colour_gains_[0] = (*cg)[0];
+        last_colour_gains_[1] = (*cg)[1];
+    }
+    if (timing.sensor_ts_ns > last_sensor_ts_ns_ && last_sensor_ts_ns_) {
+        uint64_t dt = timing.sensor_ts_ns - last_sensor_ts_ns_;
+        if (dt < 200000000ULL) sensor_interval_ns_ = dt;   // ignore gaps (restart, drops)
+    }
+    last_sensor_ts_ns_ = timing.sensor_ts_ns;
+    {
+        std::lock_guard<std::mutex> lk(timing_mtx_);
+        frame_timing_ = timing;
+    }
+
     if (!planes.empty() && frame_cb_) {
         // Export DMA-BUF fd for zero-copy to DRM
         int fd = planes[0].fd.get();
@@ -194,16 +286,118 @@ void CameraPipeline::request_complete(Request* request) {
         frame_cb_(fd, w, h, stride, preview_fourcc_);
     }
 
+    queue_capture(buffer, timing);
+    if (eis_enabled_) measure_residual(buffer);
+
+    // Notify the main loop (one write, no allocation, never blocks)
+    if (frame_efd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t n = write(frame_efd_, &one, sizeof(one));
+        (void)n;
+    }
+
     // Re-queue the request
     request->reuse(Request::ReuseBuffers);
-    configure_controls();
+    configure_controls(request, timing);
     camera_->queueRequest(request);
 }
 
-void CameraPipeline::configure_controls() {
-    // Controls are applied per-request via libcamera ControlList
-    // For simplicity in the preview loop, we set them on the camera
-    // Note: actual implementation would set controls on each Request
+FrameTiming CameraPipeline::last_frame_timing() const {
+    std::lock_guard<std::mutex> lk(timing_mtx_);
+    return frame_timing_;
+}
+
+FrameTiming CameraPipeline::last_capture_timing() const {
+    std::lock_guard<std::mutex> lk(timing_mtx_);
+    return capture_timing_;
+}
+
+// Centred crop of the sensor array for a digital zoom factor
+static CropRect zoom_crop(float factor) {
+    CropRect c;
+    c.w = static_cast<int>(CAPTURE_W / factor);
+    c.h = static_cast<int>(CAPTURE_H / factor);
+    c.x = (CAPTURE_W - c.w) / 2;
+    c.y = (CAPTURE_H - c.h) / 2;
+    return c;
+}
+
+void CameraPipeline::configure_controls(Request* request, const FrameTiming& timing) {
+    CropRect crop = zoom_crop(zoom_.load());
+    if (eis_enabled_) {
+        GyroSample g;
+        if (timing.sensor_ts_ns && sensor_interval_ns_ && motion_ && motion_(sensor_interval_ns_, &g)) {
+            // This request is filled after the other CAMERA_BUF_COUNT - 1
+            // queued ones; aim the correction at the middle of its exposure.
+            uint64_t target_ns = timing.sensor_ts_ns + CAMERA_BUF_COUNT * sensor_interval_ns_
+                               + timing.exposure_us * 500ULL;
+            crop = eis_.crop(crop, g, target_ns);
+        } else {
+            crop = Stabilizer::centred(crop);
+        }
+    }
+    request->controls().set(controls::ScalerCrop, Rectangle(crop.x, crop.y, crop.w, crop.h));
+
+    // Controls are sticky in the IPA, so the lock is sent once per change.
+    // It lands CAMERA_BUF_COUNT frames later, well inside a half-press.
+    bool lock = ae_lock_.load();
+    if (static_cast<int>(lock) != ae_lock_applied_) {
+        ControlList& c = request->controls();
+        c.set(controls::AeEnable, !lock);
+        c.set(controls::AwbEnable, !lock);
+        if (lock) {
+            // Pin what the newest frame was taken with
+            if (timing.exposure_us) c.set(controls::ExposureTime, static_cast<int32_t>(timing.exposure_us));
+            c.set(controls::AnalogueGain, last_gain_);
+            if (last_colour_gains_[0] > 0.0f) {
+                c.set(controls::ColourGains,
+                      Span<const float, 2>({last_colour_gains_[0], last_colour_gains_[1]}));
+            }
+        }
+        ae_lock_applied_ = static_cast<int>(lock);
+    }
+
+    int fps = fps_limit_.load();
+    if (fps != fps_limit_applied_) {
+        int64_t min_us = 1000000 / (fps > 0 ? fps : PREVIEW_FPS);
+        int64_t max_us = fps > 0 ? min_us : CAMERA_MAX_FRAME_US;
+        request->controls().set(controls::FrameDurationLimits, Span<const int64_t, 2>({min_us, max_us}));
+        fps_limit_applied_ = fps;
+    }
+}
+
+void CameraPipeline::set_stabilization(bool enabled, MotionSource motion) {
+    if (running_) return;
+    eis_enabled_ = enabled && motion;
+    motion_ = std::move(motion);
+    eis_.reset();
+    fprintf(stderr, "[Camera] Stabilization %s\n", eis_enabled_ ? "on" : "off");
+}
+
+void CameraPipeline::measure_residual(const FrameBuffer* buffer) {
+    if (buffer->planes().empty()) return;
+    const auto& plane = buffer->planes()[0];
+    int fd = plane.fd.get();
+
+    // Buffers cycle through a fixed set, so each is mapped once
+    void* addr = nullptr;
+    for (const auto& m : preview_maps_) if (m.fd == fd) addr = m.addr;
+    if (!addr) {
+        size_t len = plane.offset + plane.length;
+        addr = mmap(nullptr, len, PROT_READ, MAP_SHARED, fd, 0);
+        if (addr == MAP_FAILED) return;
+        preview_maps_.push_back({fd, addr, len});
+    }
+
+    const auto& cfg = config_->at(0);
+    int bpp = (preview_fourcc_ == 0x34324752 || preview_fourcc_ == 0x34324742) ? 3 : 4;
+    eis_.measure(static_cast<const uint8_t*>(addr) + plane.offset, cfg.size.width,
+                 cfg.size.height, static_cast<int>(cfg.stride), bpp);
+}
+
+void CameraPipeline::unmap_preview() {
+    for (const auto& m : preview_maps_) munmap(m.addr, m.len);
+    preview_maps_.clear();
 }
 
 void CameraPipeline::set_iso(int iso) {
@@ -234,34 +428,295 @@ void CameraPipeline::set_white_balance(int mode) {
 void CameraPipeline::set_digital_zoom(float factor) {
     if (factor < 1.0f) factor = 1.0f;
     if (factor > 4.0f) factor = 4.0f;
+    // Applied as ScalerCrop on each re-queued request
     zoom_ = factor;
-
-    if (camera_ && running_) {
-        // Digital zoom via ScalerCrop
-        int full_w = CAPTURE_W;
-        int full_h = CAPTURE_H;
-        int crop_w = static_cast<int>(full_w / factor);
-        int crop_h = static_cast<int>(full_h / factor);
-        int x = (full_w - crop_w) / 2;
-        int y = (full_h - crop_h) / 2;
-
-        ControlList controls;
-        controls.set(controls::ScalerCrop,
-                     Rectangle(x, y, crop_w, crop_h));
-    }
 }
 
-void CameraPipeline::capture_photo(const std::string& output_path, CaptureCallback cb) {
+void CameraPipeline::capture_photo(const std::string& output_path, CaptureCallback cb,
+                                   SteadyCapture steady, uint64_t pressed_us, bool flash) {
     std::lock_guard<std::mutex> lk(capture_mtx_);
+    if (capturing_ && capture_fd_ >= 0) {
+        close(capture_fd_);                 // superseded before a frame was taken
+        unlink(capture_path_.c_str());
+    }
     capture_path_ = output_path;
     capture_cb_ = std::move(cb);
+    capture_requested_us_ = metrics_now_us();
+    capture_pressed_us_ = pressed_us ? pressed_us : capture_requested_us_;
+    steady_ = std::move(steady);
+    capture_flash_ = flash && flash_fire_;
+    capture_fd_ = -1;
+    capture_prepared_ = prepared_fd_ >= 0 && prepared_path_ == output_path;
+    if (capture_prepared_) {
+        capture_fd_ = prepared_fd_;
+        prepared_fd_ = -1;
+        prepared_path_.clear();
+    } else {
+        discard_prepared();
+    }
+    selection_ = CaptureSelection();
+    for (auto& p : pending_) drop(p);
+    pending_.clear();
+    drop(best_);
     capturing_ = true;
-    // In a real implementation, we'd switch to still capture mode
-    // or use a separate StillCapture stream configuration.
-    // For now, we capture from the preview stream and upscale.
+    // Still capture comes from the next preview frame; a dedicated
+    // StillCapture stream configuration is not set up yet.
     fprintf(stderr, "[Camera] Capture requested: %s\n", output_path.c_str());
 }
 
+bool CameraPipeline::prepare_capture(const std::string& output_path) {
+    if (!running_) return false;
+    ae_lock_ = true;
+
+    const auto& cfg = config_->at(0);
+    bool ok;
+    {
+        std::lock_guard<std::mutex> lk(capture_mtx_);
+        discard_prepared();
+        prepared_fd_ = PhotoCapture::preallocate(output_path);
+        if (prepared_fd_ >= 0) prepared_path_ = output_path;
+        ok = prepared_fd_ >= 0;
+        if (prepared_pixels_.empty()) {
+            // Written, not just reserved, so the pages are already faulted in
+            prepared_pixels_.assign(static_cast<size_t>(cfg.stride) * cfg.size.height, 0);
+            encoder_bytes_ += prepared_pixels_.size();
+        }
+    }
+
+    EncodeJob job;
+    job.prime = true;
+    job.width = cfg.size.width;
+    job.height = cfg.size.height;
+    {
+        std::lock_guard<std::mutex> lk(enc_mtx_);
+        enc_jobs_.push_back(std::move(job));
+    }
+    enc_cv_.notify_one();
+    return ok;
+}
+
+void CameraPipeline::release_capture() {
+    ae_lock_ = false;
+    std::lock_guard<std::mutex> lk(capture_mtx_);
+    discard_prepared();
+    encoder_bytes_ -= prepared_pixels_.size();
+    std::vector<uint8_t>().swap(prepared_pixels_);
+}
+
+// Caller holds capture_mtx_
+void CameraPipeline::discard_prepared() {
+    if (prepared_fd_ < 0) return;
+    close(prepared_fd_);
+    unlink(prepared_path_.c_str());
+    prepared_fd_ = -1;
+    prepared_path_.clear();
+}
+
+CaptureSelection CameraPipeline::last_capture_selection() const {
+    std::lock_guard<std::mutex> lk(timing_mtx_);
+    return capture_selection_;
+}
+
+// Copy out of the DMA-BUF so the request can be re-queued right away;
+// encoding a frame takes far longer than one frame interval.
+bool CameraPipeline::copy_frame(const FrameBuffer* buffer, std::vector<uint8_t>* out) {
+    const auto& plane = buffer->planes()[0];
+    const auto& cfg = config_->at(0);
+    size_t map_len = plane.offset + plane.length;
+    void* map = mmap(nullptr, map_len, PROT_READ, MAP_SHARED, plane.fd.get(), 0);
+    if (map == MAP_FAILED) {
+        fprintf(stderr, "[Camera] Capture mmap failed: %s\n", strerror(errno));
+        return false;
+    }
+    const uint8_t* src = static_cast<const uint8_t*>(map) + plane.offset;
+    out->assign(src, src + static_cast<size_t>(cfg.stride) * cfg.size.height);
+    munmap(map, map_len);
+    encoder_bytes_ += out->size();
+    return true;
+}
+
+void CameraPipeline::drop(Candidate& c) {
+    encoder_bytes_ -= c.pixels.size();
+    std::vector<uint8_t>().swap(c.pixels);
+}
+
+// Caller holds capture_mtx_
+void CameraPipeline::submit_capture(Candidate c) {
+    for (auto& p : pending_) drop(p);
+    pending_.clear();
+    drop(best_);
+    capturing_ = false;
+
+    EncodeJob job;
+    job.path = capture_path_;
+    job.cb = std::move(capture_cb_);
+    job.requested_us = capture_pressed_us_;
+    job.fd = capture_fd_;
+    job.prepared = capture_prepared_;
+    capture_fd_ = -1;
+    {
+        std::lock_guard<std::mutex> lk(timing_mtx_);
+        capture_timing_ = c.timing;
+        capture_selection_ = selection_;
+    }
+
+    const auto& cfg = config_->at(0);
+    job.width  = cfg.size.width;
+    job.height = cfg.size.height;
+    job.stride = static_cast<int>(cfg.stride);
+    job.pixels = std::move(c.pixels);
+
+    {
+        std::lock_guard<std::mutex> lk(enc_mtx_);
+        enc_jobs_.push_back(std::move(job));
+        g_encode_queue.set(static_cast<double>(enc_jobs_.size()));
+    }
+    enc_cv_.notify_one();
+}
+
+// Called with capture_mtx_ held; the callback runs without it
+void CameraPipeline::fail_capture(std::unique_lock<std::mutex>& lk) {
+    capturing_ = false;
+    if (capture_fd_ >= 0) {
+        close(capture_fd_);
+        unlink(capture_path_.c_str());
+        capture_fd_ = -1;
+    }
+    CaptureCallback cb = std::move(capture_cb_);
+    std::string path = capture_path_;
+    lk.unlock();
+    if (!cb) return;
+    // Same thread as a successful capture's callback, never the presenter
+    if (loop_) {
+        loop_->post([cb = std::move(cb), path = std::move(path)]() { cb(path, false); });
+    } else {
+        cb(path, false);
+    }
+}
+
+void CameraPipeline::queue_capture(const FrameBuffer* buffer, const FrameTiming& timing) {
+    if (buffer->planes().empty()) return;
+
+    // Held across the copy; only capture_photo() contends for it
+    std::unique_lock<std::mutex> lk(capture_mtx_);
+    if (!capturing_) return;
+    if (selection_.frames++ == 0) selection_.first = timing;
+    if (capture_flash_ && !flash_frame(timing)) return;
+
+    Candidate cand;
+    cand.timing = timing;
+    if (!prepared_pixels_.empty()) {
+        cand.pixels.swap(prepared_pixels_);     // primed at half-press
+        encoder_bytes_ -= cand.pixels.size();
+    }
+    bool copied = copy_frame(buffer, &cand.pixels);
+
+    if (capture_flash_ || steady_.max_wait_us == 0 || !steady_.shake) {
+        if (copied) submit_capture(std::move(cand));
+        else fail_capture(lk);
+        return;
+    }
+
+    if (copied) pending_.push_back(std::move(cand));
+    bool expired = metrics_now_us() - capture_requested_us_ >= steady_.max_wait_us;
+
+    // Score frames once the gyro history has caught up with their exposure
+    // (the FIFO is drained every GYRO_READ_MS, several frames behind)
+    while (!pending_.empty()) {
+        Candidate& p = pending_.front();
+        bool covered = false;
+        p.dps = steady_.shake(p.timing, &covered);
+        if (!covered && !expired && pending_.size() <= STEADY_PENDING_MAX) break;
+        if (p.dps >= 0.0f && p.dps <= steady_.max_dps) {
+            selection_.still = true;
+            submit_capture(std::move(p));
+            return;
+        }
+        if (best_.pixels.empty() || (p.dps >= 0.0f && (best_.dps < 0.0f || p.dps < best_.dps))) {
+            drop(best_);
+            best_ = std::move(p);
+        } else {
+            drop(p);
+        }
+        pending_.pop_front();
+    }
+
+    if (expired) {
+        if (!best_.pixels.empty()) submit_capture(std::move(best_));
+        else fail_capture(lk);
+    }
+}
+
+// Flash capture, capture_mtx_ held.  The first frame after the request
+// predicts the exposure start of the next frame far enough ahead to
+// schedule, from its SensorTimestamp and FrameDuration, and lights that
+// window.  Returns true for the frame to take.
+bool CameraPipeline::flash_frame(const FrameTiming& timing) {
+    uint64_t period_ns = timing.frame_duration_us ? timing.frame_duration_us * 1000ULL
+                                                  : sensor_interval_ns_;
+    if (selection_.flash_start_ns == 0) {
+        if (!timing.sensor_ts_ns || !period_ns) {
+            capture_flash_ = false;         // no timing to aim with: take it unlit
+            return true;
+        }
+        uint64_t earliest = sensor_clock_ns() + (FLASH_LEAD_US + FLASH_PRE_US) * 1000ULL;
+        uint64_t start = timing.sensor_ts_ns + period_ns;
+        while (start < earliest) start += period_ns;
+        // Rolling shutter: the last row starts up to a frame period after
+        // the first, so light the first row's start to the last row's end
+        uint64_t on = start - FLASH_PRE_US * 1000ULL;
+        uint64_t off = start + (timing.exposure_us * 1000ULL + period_ns);
+        off = std::min<uint64_t>(off, on + FLASH_MAX_ON_US * 1000ULL);
+        if (!flash_fire_(on, off)) {
+            capture_flash_ = false;
+            return true;
+        }
+        selection_.flash_start_ns = start;
+        return false;
+    }
+    // Skip to the lit frame; if it was dropped, the next one is closest
+    return timing.sensor_ts_ns + period_ns / 2 >= selection_.flash_start_ns;
+}
+
+void CameraPipeline::encoder_thread() {
+    for (;;) {
+        EncodeJob job;
+        {
+            std::unique_lock<std::mutex> lk(enc_mtx_);
+            enc_cv_.wait(lk, [this] { return enc_stop_ || !enc_jobs_.empty(); });
+            if (enc_jobs_.empty()) return;   // stop requested, queue drained
+            job = std::move(enc_jobs_.front());
+            enc_jobs_.pop_front();
+            g_encode_queue.set(static_cast<double>(enc_jobs_.size()));
+        }
+        if (job.prime) {
+            PhotoCapture::prime_encoder(job.width, job.height);
+            continue;
+        }
+
+        bool ok;
+        {
+            ScopedLatency t(g_encode_time);
+            ok = PhotoCapture::encode_jpeg(job.pixels.data(), job.width, job.height,
+                                           job.stride, JPEG_QUALITY, job.path, job.fd);
+        }
+        if (ok) {
+            uint64_t latency_us = metrics_now_us() - job.requested_us;
+            (job.prepared ? g_capture_latency_prepared : g_capture_latency).record_us(latency_us);
+            fprintf(stderr, "[Camera] Press to disk %.1f ms (%s)\n", latency_us / 1000.0,
+                    job.prepared ? "half-pressed" : "single-stage");
+        }
+        encoder_bytes_ -= job.pixels.size();
+        std::vector<uint8_t>().swap(job.pixels);
+        if (!job.cb) continue;
+        if (loop_) {
+            loop_->post([cb = std::move(job.cb), path = job.path, ok]() { cb(path, ok); });
+        } else {
+            job.cb(job.path, ok);
+        }
+    }
+}
+
 void CameraPipeline::set_frame_callback(FrameCallback cb) {
     frame_cb_ = std::move(cb);
 }
@@ -1,62 +1,135 @@
 /**
  * CinePi Camera - Photo Capture Helper
- * JPEG encoding via libjpeg-turbo
+ * JPEG encoding via libjpeg-turbo.  Each encoding thread keeps its
+ * compressor and a worst-case output buffer between frames.
  */
 
 #include "camera/photo_capture.h"
 #include "core/constants.h"
+#include "core/trace.h"
 
+#include <cerrno>
 #include <cstdio>
 #include <cstring>
 #include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
 #include <sys/stat.h>
 #include <turbojpeg.h>
 
 namespace cinepi {
 
+namespace {
+struct Compressor {
+    tjhandle handle = nullptr;
+    unsigned char* buf = nullptr;
+    unsigned long cap = 0;
+    ~Compressor() {
+        if (buf) tjFree(buf);
+        if (handle) tjDestroy(handle);
+    }
+};
+thread_local Compressor t_comp;
+
+// Compressor with room for the worst-case JPEG of a width x height frame
+Compressor* compressor(int width, int height) {
+    if (!t_comp.handle) t_comp.handle = tjInitCompress();
+    if (!t_comp.handle) {
+        fprintf(stderr, "[Capture] tjInitCompress failed\n");
+        return nullptr;
+    }
+    unsigned long need = tjBufSize(width, height, TJSAMP_420);
+    if (t_comp.cap < need) {
+        if (t_comp.buf) tjFree(t_comp.buf);
+        t_comp.buf = tjAlloc(static_cast<int>(need));
+        t_comp.cap = t_comp.buf ? need : 0;
+        if (!t_comp.buf) return nullptr;
+        memset(t_comp.buf, 0, need);     // fault the pages in now
+    }
+    return &t_comp;
+}
+
+bool write_all(int fd, const unsigned char* p, unsigned long n) {
+    while (n > 0) {
+        ssize_t w = write(fd, p, n);
+        if (w < 0 && errno == EINTR) continue;
+        if (w <= 0) return false;
+        p += w;
+        n -= static_cast<unsigned long>(w);
+    }
+    return true;
+}
+
+// A prepared fd belongs to a file this capture created (O_EXCL), so on
+// failure it is removed rather than left behind empty or truncated
+void remove_prepared(int fd, const std::string& path) {
+    if (fd < 0) return;
+    close(fd);
+    unlink(path.c_str());
+}
+} // namespace
+
 PhotoCapture::PhotoCapture() = default;
 PhotoCapture::~PhotoCapture() = default;
 
 bool PhotoCapture::encode_jpeg(const uint8_t* rgb_data, int width, int height,
-                                int stride, int quality, const std::string& output_path) {
-    tjhandle handle = tjInitCompress();
-    if (!handle) {
-        fprintf(stderr, "[Capture] tjInitCompress failed\n");
+                                int stride, int quality, const std::string& output_path,
+                                int fd) {
+    TRACE_SCOPE("capture.encode_jpeg");
+    Compressor* c = compressor(width, height);
+    if (!c) {
+        remove_prepared(fd, output_path);
         return false;
     }
 
-    unsigned char* jpeg_buf = nullptr;
-    unsigned long jpeg_size = 0;
-
-    int ret = tjCompress2(handle, rgb_data, width, stride, height,
+    unsigned char* jpeg_buf = c->buf;
+    unsigned long jpeg_size = c->cap;
+    int ret = tjCompress2(c->handle, rgb_data, width, stride, height,
                           TJPF_RGB, &jpeg_buf, &jpeg_size,
-                          TJSAMP_420, quality, TJFLAG_FASTDCT);
-
+                          TJSAMP_420, quality, TJFLAG_FASTDCT | TJFLAG_NOREALLOC);
     if (ret != 0) {
         fprintf(stderr, "[Capture] tjCompress2 failed: %s\n", tjGetErrorStr());
-        tjDestroy(handle);
+        remove_prepared(fd, output_path);
         return false;
     }
 
-    FILE* fp = fopen(output_path.c_str(), "wb");
-    if (!fp) {
+    bool prepared = fd >= 0;
+    if (fd < 0) fd = open(output_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
         fprintf(stderr, "[Capture] Cannot open %s for writing\n", output_path.c_str());
-        tjFree(jpeg_buf);
-        tjDestroy(handle);
         return false;
     }
-
-    fwrite(jpeg_buf, 1, jpeg_size, fp);
-    fclose(fp);
+    // A pre-allocated file may hold more reserved blocks than the JPEG needs
+    bool ok = write_all(fd, jpeg_buf, jpeg_size) && ftruncate(fd, jpeg_size) == 0;
+    if (!ok) {
+        fprintf(stderr, "[Capture] Write %s failed: %s\n", output_path.c_str(), strerror(errno));
+        if (prepared) remove_prepared(fd, output_path);
+        else close(fd);
+        return false;
+    }
+    close(fd);
 
     fprintf(stderr, "[Capture] Saved %s (%dx%d, %lu bytes)\n",
             output_path.c_str(), width, height, jpeg_size);
-
-    tjFree(jpeg_buf);
-    tjDestroy(handle);
     return true;
 }
 
+void PhotoCapture::prime_encoder(int width, int height) {
+    compressor(width, height);
+}
+
+int PhotoCapture::preallocate(const std::string& output_path) {
+    // Never an existing photo: an unused prepared file is unlinked later
+    int fd = open(output_path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        fprintf(stderr, "[Capture] Cannot create %s: %s\n", output_path.c_str(), strerror(errno));
+        return -1;
+    }
+    // Reserve blocks without changing the size; unsupported is harmless
+    fallocate(fd, FALLOC_FL_KEEP_SIZE, 0, JPEG_PREALLOC_BYTES);
+    return fd;
+}
+
 bool PhotoCapture::should_flash(const CaptureParams& params) {
     if (params.flash_mode == 1) return true;   // ON
     if (params.flash_mode == 0) return false;   // OFF
@@ -0,0 +1,157 @@
+/**
+ * CinePi Camera - Electronic Image Stabilisation
+ * The gyro axes are used as mounted on the CinePi board: yaw (z) moves the
+ * image horizontally, pitch (y) vertically.
+ */
+
+#include "camera/stabilizer.h"
+#include "core/constants.h"
+#include "core/metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace cinepi {
+
+static Gauge& g_residual = Metrics::instance().gauge(
+    "cinepi_eis_residual_px", "RMS frame-to-frame jitter left on the preview stream");
+static Gauge& g_correction = Metrics::instance().gauge(
+    "cinepi_eis_correction_px", "Current stabilisation shift of the crop, sensor pixels");
+static Counter& g_clamped = Metrics::instance().counter(
+    "cinepi_eis_clamped_total", "Requests whose correction hit the crop margin");
+
+static constexpr int   PROFILE_STEP = 4;      // preview pixels per profile sample
+static constexpr int   MAX_SHIFT    = 8;      // profile samples searched each way
+static constexpr float VAR_SMOOTHING = 0.05f; // per request, shake statistics
+
+static constexpr float kPi = static_cast<float>(M_PI);
+static const float kFocalPx = (CAPTURE_W / 2.0f) / std::tan(CAMERA_HFOV_DEG * kPi / 360.0f);
+
+CropRect Stabilizer::centred(const CropRect& base) {
+    CropRect c;
+    c.w = base.w * (100 - EIS_MARGIN_PCT) / 100;
+    c.h = base.h * (100 - EIS_MARGIN_PCT) / 100;
+    c.x = base.x + (base.w - c.w) / 2;
+    c.y = base.y + (base.h - c.h) / 2;
+    return c;
+}
+
+void Stabilizer::reset() {
+    last_target_ns_ = 0;
+    prev_cols_.clear();
+    prev_rows_.clear();
+}
+
+// Shake (deg) expected `horizon` seconds after this sample.  Brown's double
+// smoothing follows pans without the steady lag of a single low-pass.  The
+// frequency is the smaller of two estimates, rate/angle and accel/rate; gyro
+// noise inflates each in a different term.
+float Stabilizer::Axis::shake(float angle, float rate, float alpha, float dt, float horizon) {
+    if (dt <= 0.0f) {
+        s1 = s2 = angle;
+        rate_lp = rate;
+        prev_rate_hp = 0;
+        var_angle = var_rate = var_accel = 0;
+        return 0.0f;
+    }
+    s1 += alpha * (angle - s1);
+    s2 += alpha * (s1 - s2);
+    rate_lp += alpha * (rate - rate_lp);
+    float angle_hp = angle - (2 * s1 - s2);
+    float rate_hp = rate - rate_lp;
+    float accel = (rate_hp - prev_rate_hp) / dt;
+    prev_rate_hp = rate_hp;
+    var_angle += VAR_SMOOTHING * (angle_hp * angle_hp - var_angle);
+    var_rate  += VAR_SMOOTHING * (rate_hp * rate_hp - var_rate);
+    var_accel += VAR_SMOOTHING * (accel * accel - var_accel);
+    if (var_angle <= 0.0f || var_rate <= 0.0f) return 0.0f;
+
+    float w = std::min(std::sqrt(var_accel / var_rate), std::sqrt(var_rate / var_angle));
+    float phi = w * horizon;
+    if (w <= 0.0f || phi >= kPi) return 0.0f;
+    return std::cos(phi) * angle_hp + std::sin(phi) / w * rate_hp;
+}
+
+CropRect Stabilizer::crop(const CropRect& base, const GyroSample& g, uint64_t target_ns) {
+    CropRect c = centred(base);
+    const float angle[2] = {g.angle[2], g.angle[1]};
+    const float rate[2]  = {g.rate[2], g.rate[1]};
+
+    float dt = last_target_ns_ && target_ns > last_target_ns_
+             ? (target_ns - last_target_ns_) / 1e9f : 0.0f;
+    last_target_ns_ = target_ns;
+    float alpha = 1.0f - std::exp(-2.0f * kPi * EIS_FOLLOW_HZ * dt);
+    float horizon = target_ns > g.t_ns ? (target_ns - g.t_ns) / 1e9f : 0.0f;
+
+    const int max_off[2] = {(base.w - c.w) / 2, (base.h - c.h) / 2};
+    int off[2];
+    for (int a = 0; a < 2; a++) {
+        float shake = axis_[a].shake(angle[a], rate[a], alpha, dt, horizon);
+        float px = -kFocalPx * std::tan(shake * kPi / 180.0f);
+        if (std::fabs(px) > max_off[a]) {
+            px = std::copysign(static_cast<float>(max_off[a]), px);
+            g_clamped.inc();
+        }
+        off[a] = static_cast<int>(std::lround(px));
+    }
+    c.x += off[0];
+    c.y += off[1];
+    g_correction.set(std::sqrt(static_cast<double>(off[0]) * off[0] + off[1] * off[1]));
+    return c;
+}
+
+// Shift (in profile samples, sub-sample by parabola fit) that best aligns
+// cur to prev, searched over +-MAX_SHIFT.
+static float best_shift(const std::vector<int32_t>& prev, const std::vector<int32_t>& cur) {
+    const int n = static_cast<int>(cur.size());
+    int64_t sad[2 * MAX_SHIFT + 1];
+    int best = 0;
+    for (int s = -MAX_SHIFT; s <= MAX_SHIFT; s++) {
+        int64_t sum = 0;
+        for (int i = MAX_SHIFT; i < n - MAX_SHIFT; i++) sum += std::abs(cur[i] - prev[i - s]);
+        sad[s + MAX_SHIFT] = sum;
+        if (sum < sad[best + MAX_SHIFT]) best = s;
+    }
+    if (best == -MAX_SHIFT || best == MAX_SHIFT) return static_cast<float>(best);
+    float l = static_cast<float>(sad[best + MAX_SHIFT - 1]);
+    float m = static_cast<float>(sad[best + MAX_SHIFT]);
+    float r = static_cast<float>(sad[best + MAX_SHIFT + 1]);
+    float denom = l - 2 * m + r;
+    return best + (denom > 0 ? 0.5f * (l - r) / denom : 0.0f);
+}
+
+void Stabilizer::measure(const uint8_t* px, int width, int height, int stride, int bpp) {
+    const int nc = width / PROFILE_STEP, nr = height / PROFILE_STEP;
+    if (nc <= 2 * MAX_SHIFT || nr <= 2 * MAX_SHIFT) return;
+    cols_.assign(nc, 0);
+    rows_.assign(nr, 0);
+    // Green channel on a PROFILE_STEP grid: ~19k reads for 640x480
+    for (int r = 0; r < nr; r++) {
+        const uint8_t* line = px + static_cast<size_t>(r * PROFILE_STEP) * stride + 1;
+        for (int c = 0; c < nc; c++) {
+            int v = line[c * PROFILE_STEP * bpp];
+            cols_[c] += v;
+            rows_[r] += v;
+        }
+    }
+
+    if (prev_cols_.size() == cols_.size() && prev_rows_.size() == rows_.size()) {
+        float shift[2] = {best_shift(prev_cols_, cols_) * PROFILE_STEP,
+                          best_shift(prev_rows_, rows_) * PROFILE_STEP};
+        // Jitter is what is left after the slowly varying (panning) part
+        float sq = 0.0f;
+        for (int a = 0; a < 2; a++) {
+            shift_mean_[a] += 0.1f * (shift[a] - shift_mean_[a]);
+            float hp = shift[a] - shift_mean_[a];
+            sq += hp * hp;
+        }
+        jitter_sq_ += 0.05f * (sq - jitter_sq_);
+        residual_px_ = std::sqrt(jitter_sq_);
+        g_residual.set(residual_px_);
+    }
+    prev_cols_.swap(cols_);
+    prev_rows_.swap(rows_);
+}
+
+} // namespace cinepi
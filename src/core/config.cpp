@@ -4,6 +4,8 @@
  */
 
 #include "core/config.h"
+#include "core/jank_detector.h"
+#include "core/metrics.h"
 #include <fstream>
 #include <nlohmann/json.hpp>
 #include <cstdio>
@@ -39,15 +41,40 @@ bool ConfigManager::load(const std::string& path) {
             if (c.contains("wb_mode"))       config_.camera.wb_mode = c["wb_mode"];
             if (c.contains("grid_overlay"))  config_.camera.grid_overlay = c["grid_overlay"];
             if (c.contains("digital_level")) config_.camera.digital_level = c["digital_level"];
+            if (c.contains("eis"))           config_.camera.eis = c["eis"];
             if (c.contains("flash_mode"))    config_.camera.flash_mode = c["flash_mode"];
+            if (c.contains("steady_wait_ms")) config_.camera.steady_wait_ms = c["steady_wait_ms"];
+            if (c.contains("steady_max_dps")) config_.camera.steady_max_dps = c["steady_max_dps"];
             if (c.contains("colour_temp"))   config_.camera.colour_temp = c["colour_temp"];
         }
         if (j.contains("display")) {
             auto& d = j["display"];
             if (d.contains("brightness"))    config_.display.brightness = d["brightness"];
+            if (d.contains("auto_brightness")) config_.display.auto_brightness = d["auto_brightness"];
             if (d.contains("standby_sec"))   config_.display.standby_sec = d["standby_sec"];
             if (d.contains("show_clock"))    config_.display.show_clock = d["show_clock"];
         }
+        if (j.contains("debug")) {
+            auto& d = j["debug"];
+            if (d.contains("trace"))            config_.debug.trace = d["trace"];
+            if (d.contains("trace_window_sec")) config_.debug.trace_window_sec = d["trace_window_sec"];
+        }
+        if (j.contains("threads") && j["threads"].is_array()) {
+            config_.threads.clear();
+            for (auto& t : j["threads"]) {
+                ThreadPlanEntry e;
+                e.name = t.value("name", "");
+                if (e.name.empty()) continue;
+                if (t.contains("cpus")) {
+                    for (int cpu : t["cpus"]) {
+                        if (cpu >= 0 && cpu < 32) e.cpu_mask |= 1u << cpu;
+                    }
+                }
+                e.realtime = t.value("fifo", false);
+                e.priority = t.value("priority", 0);
+                config_.threads.push_back(e);
+            }
+        }
         if (j.contains("photo_dir")) {
             config_.photo_dir = j["photo_dir"].get<std::string>();
         }
@@ -62,6 +89,7 @@ bool ConfigManager::load(const std::string& path) {
 
 bool ConfigManager::save() {
     std::lock_guard<std::mutex> lk(mtx_);
+    uint64_t t0 = metrics_now_us();
 
     json j;
     j["camera"]["iso"]           = config_.camera.iso;
@@ -69,11 +97,29 @@ bool ConfigManager::save() {
     j["camera"]["wb_mode"]       = config_.camera.wb_mode;
     j["camera"]["grid_overlay"]  = config_.camera.grid_overlay;
     j["camera"]["digital_level"] = config_.camera.digital_level;
+    j["camera"]["eis"]           = config_.camera.eis;
     j["camera"]["flash_mode"]    = config_.camera.flash_mode;
+    j["camera"]["steady_wait_ms"] = config_.camera.steady_wait_ms;
+    j["camera"]["steady_max_dps"] = config_.camera.steady_max_dps;
     j["camera"]["colour_temp"]   = config_.camera.colour_temp;
     j["display"]["brightness"]   = config_.display.brightness;
+    j["display"]["auto_brightness"] = config_.display.auto_brightness;
     j["display"]["standby_sec"]  = config_.display.standby_sec;
     j["display"]["show_clock"]   = config_.display.show_clock;
+    j["debug"]["trace"]            = config_.debug.trace;
+    j["debug"]["trace_window_sec"] = config_.debug.trace_window_sec;
+    j["threads"]                 = json::array();
+    for (const auto& e : config_.threads) {
+        json t;
+        t["name"] = e.name;
+        t["cpus"] = json::array();
+        for (int cpu = 0; cpu < 32; cpu++) {
+            if (e.cpu_mask & (1u << cpu)) t["cpus"].push_back(cpu);
+        }
+        t["fifo"]     = e.realtime;
+        t["priority"] = e.priority;
+        j["threads"].push_back(t);
+    }
     j["photo_dir"]               = config_.photo_dir;
     j["version"]                 = config_.version;
 
@@ -84,6 +130,8 @@ bool ConfigManager::save() {
     }
     f << j.dump(2);
     f.close();
+    JankDetector::instance().note("config.save", config_.config_path.c_str(),
+                                  metrics_now_us() - t0);
     fprintf(stderr, "[Config] Saved to %s\n", config_.config_path.c_str());
     return true;
 }
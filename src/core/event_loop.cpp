@@ -0,0 +1,198 @@
+/**
+ * CinePi Camera - Event Loop
+ * epoll + timerfd + eventfd reactor.  One blocking epoll_wait() replaces the
+ * per-driver sleep-poll threads, so a static screen costs no wakeups beyond
+ * the timers that are actually armed.
+ */
+
+#include "core/event_loop.h"
+#include "core/metrics.h"
+
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+
+namespace cinepi {
+
+static constexpr int kMaxEvents = 16;
+
+static Counter& g_wakeups = Metrics::instance().counter(
+    "cinepi_loop_wakeups_total", "epoll_wait returns on the main loop");
+static Gauge& g_posted = Metrics::instance().gauge(
+    "cinepi_loop_posted_depth", "Cross-thread tasks waiting for the main loop");
+
+static void ms_to_timespec(int ms, struct timespec& ts) {
+    ts.tv_sec  = ms / 1000;
+    ts.tv_nsec = static_cast<long>(ms % 1000) * 1000000L;
+}
+
+EventLoop::EventLoop() = default;
+
+EventLoop::~EventLoop() {
+    deinit();
+}
+
+bool EventLoop::init() {
+    epoll_fd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd_ < 0) {
+        fprintf(stderr, "[Loop] epoll_create1 failed: %s\n", strerror(errno));
+        return false;
+    }
+
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        fprintf(stderr, "[Loop] eventfd failed: %s\n", strerror(errno));
+        close(epoll_fd_);
+        epoll_fd_ = -1;
+        return false;
+    }
+
+    add_fd(wake_fd_, EPOLLIN, [this](uint32_t) {
+        uint64_t v;
+        while (::read(wake_fd_, &v, sizeof(v)) == sizeof(v)) {}
+        drain_posted();
+    });
+
+    fprintf(stderr, "[Loop] Initialized (epoll fd=%d)\n", epoll_fd_);
+    return true;
+}
+
+void EventLoop::deinit() {
+    if (epoll_fd_ < 0) return;
+
+    for (auto& kv : sources_) {
+        if (kv.second->owned) close(kv.second->fd);
+    }
+    sources_.clear();
+
+    if (wake_fd_ >= 0) { close(wake_fd_); wake_fd_ = -1; }
+    close(epoll_fd_);
+    epoll_fd_ = -1;
+}
+
+bool EventLoop::add_fd(int fd, uint32_t events, FdHandler cb) {
+    if (epoll_fd_ < 0 || fd < 0) return false;
+
+    struct epoll_event ev = {};
+    ev.events  = events;
+    ev.data.fd = fd;
+    if (epoll_ctl(epoll_fd_, EPOLL_CTL_ADD, fd, &ev) != 0) {
+        fprintf(stderr, "[Loop] EPOLL_CTL_ADD fd=%d failed: %s\n", fd, strerror(errno));
+        return false;
+    }
+
+    auto src = std::make_shared<Source>();
+    src->fd = fd;
+    src->cb = std::move(cb);
+    sources_[fd] = std::move(src);
+    return true;
+}
+
+void EventLoop::remove_fd(int fd) {
+    auto it = sources_.find(fd);
+    if (it == sources_.end()) return;
+    epoll_ctl(epoll_fd_, EPOLL_CTL_DEL, fd, nullptr);
+    if (it->second->owned) close(fd);
+    sources_.erase(it);
+}
+
+int EventLoop::add_timer(int period_ms, TimerHandler cb, int initial_ms) {
+    int tfd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (tfd < 0) {
+        fprintf(stderr, "[Loop] timerfd_create failed: %s\n", strerror(errno));
+        return -1;
+    }
+
+    bool ok = add_fd(tfd, EPOLLIN, [tfd, cb = std::move(cb)](uint32_t) {
+        uint64_t expirations = 0;
+        if (::read(tfd, &expirations, sizeof(expirations)) != sizeof(expirations)) return;
+        cb(expirations);
+    });
+    if (!ok) {
+        close(tfd);
+        return -1;
+    }
+    sources_[tfd]->owned = true;
+
+    if (!set_timer(tfd, period_ms, initial_ms)) {
+        remove_fd(tfd);
+        return -1;
+    }
+    return tfd;
+}
+
+bool EventLoop::set_timer(int timer_fd, int period_ms, int initial_ms) {
+    struct itimerspec its = {};
+    ms_to_timespec(period_ms, its.it_interval);
+    ms_to_timespec(initial_ms < 0 ? period_ms : initial_ms, its.it_value);
+    // A zero it_value disarms the timer; use 1ns for "fire immediately".
+    if (its.it_value.tv_sec == 0 && its.it_value.tv_nsec == 0 && initial_ms == 0)
+        its.it_value.tv_nsec = 1;
+
+    if (timerfd_settime(timer_fd, 0, &its, nullptr) != 0) {
+        fprintf(stderr, "[Loop] timerfd_settime failed: %s\n", strerror(errno));
+        return false;
+    }
+    return true;
+}
+
+void EventLoop::remove_timer(int timer_fd) {
+    remove_fd(timer_fd);
+}
+
+void EventLoop::post(LoopTask task) {
+    {
+        std::lock_guard<std::mutex> lk(post_mtx_);
+        posted_.push_back(std::move(task));
+        g_posted.set(static_cast<double>(posted_.size()));
+    }
+    wake();
+}
+
+void EventLoop::wake() {
+    if (wake_fd_ < 0) return;
+    uint64_t one = 1;
+    ssize_t n = ::write(wake_fd_, &one, sizeof(one));
+    (void)n;  // EAGAIN only if the counter is saturated, loop wakes anyway
+}
+
+void EventLoop::drain_posted() {
+    std::vector<LoopTask> tasks;
+    {
+        std::lock_guard<std::mutex> lk(post_mtx_);
+        tasks.swap(posted_);
+        g_posted.set(0);
+    }
+    for (auto& t : tasks) t();
+}
+
+int EventLoop::run_once(int timeout_ms) {
+    if (epoll_fd_ < 0) return 0;
+
+    struct epoll_event events[kMaxEvents];
+    int n = epoll_wait(epoll_fd_, events, kMaxEvents, timeout_ms);
+    wakeups_.fetch_add(1, std::memory_order_relaxed);
+    g_wakeups.inc();
+    if (n < 0) {
+        if (errno != EINTR)
+            fprintf(stderr, "[Loop] epoll_wait failed: %s\n", strerror(errno));
+        return 0;
+    }
+
+    uint64_t t0 = metrics_now_us();
+    for (int i = 0; i < n; i++) {
+        // Look up by fd every time: a handler may have removed a later source.
+        auto it = sources_.find(events[i].data.fd);
+        if (it == sources_.end()) continue;
+        std::shared_ptr<Source> src = it->second;
+        src->cb(events[i].events);
+    }
+    last_dispatch_us_ = metrics_now_us() - t0;
+    return n;
+}
+
+} // namespace cinepi
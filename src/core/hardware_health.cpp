@@ -1,25 +1,6 @@
 #include "core/hardware_health.h"
-#include "core/constants.h"
 
 #include <cstdio>
-#include <cstring>
-#include <cerrno>
-#include <fcntl.h>
-#include <unistd.h>
-#include <sys/ioctl.h>
-#ifdef __linux__
-#include <linux/i2c-dev.h>
-#endif
-#ifdef LIBGPIOD_AVAILABLE
-#include <gpiod.h>
-#endif
-#ifdef LIBCAMERA_AVAILABLE
-#include <libcamera/libcamera.h>
-#endif
-#include <dirent.h>
-#ifdef __linux__
-#include <linux/input.h>
-#endif
 
 namespace cinepi {
 
@@ -33,154 +14,15 @@ HardwareHealth::HardwareHealth() {
     status_[HardwareComponent::Flash] = HardwareStatus::Failed;
 }
 
-bool HardwareHealth::init() {
-    fprintf(stderr, "\n[Hardware] Running diagnostics...\n");
-    
-    bool camera_ok = check_camera();
-    bool display_ok = check_display();
-    
-    check_touch();
-    check_gpio();
-    check_i2c();
-    
-    log_status();
-    
-    if (!camera_ok) {
-        fprintf(stderr, "[Hardware] CRITICAL: Camera not available\n");
-        return false;
-    }
-    
-    if (!display_ok) {
-        fprintf(stderr, "[Hardware] CRITICAL: Display not available\n");
-        return false;
-    }
-    
-    fprintf(stderr, "[Hardware] Diagnostics complete\n\n");
-    return true;
-}
-
-bool HardwareHealth::check_camera() {
-#ifdef LIBCAMERA_AVAILABLE
-    try {
-        using namespace libcamera;
-        auto cm = std::make_unique<CameraManager>();
-        if (!cm || cm->start() != 0) {
-            fprintf(stderr, "[Hardware] CameraManager start failed\n");
-            status_[HardwareComponent::Camera] = HardwareStatus::Failed;
-            return false;
-        }
-        
-        auto cameras = cm->cameras();
-        if (cameras.empty()) {
-            fprintf(stderr, "[Hardware] No cameras detected\n");
-            status_[HardwareComponent::Camera] = HardwareStatus::Failed;
-            cm->stop();
-            return false;
-        }
-        
-        fprintf(stderr, "[Hardware] Camera found: %s\n", cameras[0]->id().c_str());
-        status_[HardwareComponent::Camera] = HardwareStatus::OK;
-        cm->stop();
-        return true;
-    } catch (const std::exception& e) {
-        fprintf(stderr, "[Hardware] CRITICAL: Camera exception: %s\n", e.what());
-        status_[HardwareComponent::Camera] = HardwareStatus::Failed;
-        return false;
-    } catch (...) {
-        fprintf(stderr, "[Hardware] CRITICAL: Unknown camera exception\n");
-        status_[HardwareComponent::Camera] = HardwareStatus::Failed;
-        return false;
-    }
-#else
-    fprintf(stderr, "[Hardware] libcamera not available\n");
-    status_[HardwareComponent::Camera] = HardwareStatus::Failed;
-    return false;
-#endif
-}
-
-bool HardwareHealth::check_display() {
-    const char* drm_paths[] = {"/dev/dri/card1", "/dev/dri/card0"};
-    
-    for (auto path : drm_paths) {
-        int fd = open(path, O_RDWR | O_CLOEXEC);
-        if (fd >= 0) {
-            close(fd);
-            status_[HardwareComponent::Display] = HardwareStatus::OK;
-            return true;
-        }
-    }
-    
-    status_[HardwareComponent::Display] = HardwareStatus::Failed;
-    return false;
-}
-
-bool HardwareHealth::check_touch() {
-    // Simple check: just verify /dev/input exists and has event devices
-    DIR* dir = opendir("/dev/input");
-    if (!dir) {
-        fprintf(stderr, "[Hardware] /dev/input not found (touch disabled)\n");
-        status_[HardwareComponent::TouchInput] = HardwareStatus::Degraded;
-        return false;  // Not critical, app can run without touch
-    }
-    
-    bool found_event = false;
-    struct dirent* ent;
-    while ((ent = readdir(dir)) != nullptr) {
-        if (strncmp(ent->d_name, "event", 5) == 0) {
-            found_event = true;
-            break;
-        }
-    }
-    closedir(dir);
-    
-    if (found_event) {
-        fprintf(stderr, "[Hardware] Touch input device found\n");
-        status_[HardwareComponent::TouchInput] = HardwareStatus::OK;
-        return true;
-    } else {
-        fprintf(stderr, "[Hardware] No touch input devices found\n");
-        status_[HardwareComponent::TouchInput] = HardwareStatus::Degraded;
-        return false;  // Not critical
-    }
-}
-
-bool HardwareHealth::check_gpio() {
-#ifdef LIBGPIOD_AVAILABLE
-    gpiod_chip* chip = gpiod_chip_open(GPIO_CHIP);
-    if (!chip) {
-        status_[HardwareComponent::GPIOButtons] = HardwareStatus::Failed;
-        return false;
-    }
-    
-    status_[HardwareComponent::GPIOButtons] = HardwareStatus::OK;
-    gpiod_chip_close(chip);
-    return true;
-#else
-    fprintf(stderr, "[Hardware] libgpiod not available\n");
-    status_[HardwareComponent::GPIOButtons] = HardwareStatus::Failed;
-    return false;
-#endif
-}
-
-bool HardwareHealth::check_i2c() {
-    int i2c_fd = open(I2C_DEV, O_RDWR);
-    if (i2c_fd < 0) {
-        status_[HardwareComponent::I2CSensors] = HardwareStatus::Failed;
-        return false;
-    }
-    
-    close(i2c_fd);
-    status_[HardwareComponent::I2CSensors] = HardwareStatus::OK;
-    return true;
-}
-
 bool HardwareHealth::is_available(HardwareComponent component) const {
+    std::lock_guard<std::mutex> lk(mtx_);
     auto it = status_.find(component);
     if (it == status_.end()) return false;
     return it->second != HardwareStatus::Failed;
 }
 
 HardwareStatus HardwareHealth::get_status(HardwareComponent component) const {
+    std::lock_guard<std::mutex> lk(mtx_);
     auto it = status_.find(component);
     if (it == status_.end()) return HardwareStatus::Failed;
     return it->second;
@@ -241,6 +83,7 @@ std::string HardwareHealth::get_full_status() const {
 }
 
 void HardwareHealth::set_status(HardwareComponent component, HardwareStatus status) {
+    std::lock_guard<std::mutex> lk(mtx_);
     status_[component] = status;
 }
 
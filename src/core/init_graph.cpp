@@ -0,0 +1,204 @@
+/**
+ * CinePi Camera - Init Graph
+ * One thread per task, gated on a shared condition variable.  With a
+ * handful of boot tasks this is simpler than a pool and keeps each
+ * bring-up on a fresh, unpinned thread (libcamera's threads inherit the
+ * affinity of whoever creates them).
+ */
+
+#include "core/init_graph.h"
+#include "core/metrics.h"
+#include "core/thread_registry.h"
+#include "core/trace.h"
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+namespace cinepi {
+
+static Gauge& g_boot_seconds = Metrics::instance().gauge(
+    "cinepi_boot_init_seconds", "Wall time of the parallel hardware bring-up");
+static Gauge& g_ready_seconds = Metrics::instance().gauge(
+    "cinepi_boot_ready_seconds", "Exec to main loop start, including loading and static init");
+
+void InitGraph::add(const char* name, std::vector<const char*> deps, std::function<bool()> fn) {
+    Task t;
+    t.name = name;
+    t.dep_names = std::move(deps);
+    t.fn = std::move(fn);
+    tasks_.push_back(std::move(t));
+}
+
+int InitGraph::find(const char* name) const {
+    for (size_t i = 0; i < tasks_.size(); i++) {
+        if (strcmp(tasks_[i].name, name) == 0) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+bool InitGraph::ok(const char* name) const {
+    int idx = find(name);
+    return idx >= 0 && tasks_[idx].ok;
+}
+
+bool InitGraph::resolve() {
+    for (auto& t : tasks_) {
+        t.deps.clear();
+        for (const char* d : t.dep_names) {
+            int idx = find(d);
+            if (idx < 0) {
+                fprintf(stderr, "[Boot] Task '%s' depends on unknown '%s'\n", t.name, d);
+                return false;
+            }
+            t.deps.push_back(idx);
+        }
+    }
+
+    // Kahn's algorithm, only to reject cycles before any thread waits forever
+    std::vector<int> indeg(tasks_.size(), 0);
+    for (size_t i = 0; i < tasks_.size(); i++) indeg[i] = static_cast<int>(tasks_[i].deps.size());
+    std::vector<int> ready;
+    for (size_t i = 0; i < tasks_.size(); i++) if (indeg[i] == 0) ready.push_back(static_cast<int>(i));
+    size_t visited = 0;
+    while (!ready.empty()) {
+        int n = ready.back();
+        ready.pop_back();
+        visited++;
+        for (size_t i = 0; i < tasks_.size(); i++) {
+            for (int d : tasks_[i].deps) {
+                if (d == n && --indeg[i] == 0) ready.push_back(static_cast<int>(i));
+            }
+        }
+    }
+    if (visited != tasks_.size()) {
+        fprintf(stderr, "[Boot] Dependency cycle in init graph\n");
+        return false;
+    }
+    return true;
+}
+
+void InitGraph::run_task(int idx) {
+    Task& t = tasks_[idx];
+    {
+        std::unique_lock<std::mutex> lk(mtx_);
+        cv_.wait(lk, [this, &t]() {
+            for (int d : t.deps) if (!tasks_[d].done) return false;
+            return true;
+        });
+    }
+
+    uint64_t start = metrics_now_us();
+    bool ok = false;
+    try {
+        ok = t.fn();
+    } catch (const std::exception& e) {
+        fprintf(stderr, "[Boot] %s threw: %s\n", t.name, e.what());
+    } catch (...) {
+        fprintf(stderr, "[Boot] %s threw\n", t.name);
+    }
+    uint64_t end = metrics_now_us();
+    if (Tracer::instance().enabled()) Tracer::instance().record(t.name, start, end - start);
+
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        t.start_us = start - t0_us_;
+        t.end_us = end - t0_us_;
+        t.ok = ok;
+        t.done = true;
+    }
+    cv_.notify_all();
+}
+
+bool InitGraph::run() {
+    if (!resolve()) return false;
+
+    t0_us_ = metrics_now_us();
+    std::vector<std::thread> threads;
+    threads.reserve(tasks_.size());
+    for (size_t i = 0; i < tasks_.size(); i++) {
+        threads.push_back(ThreadRegistry::instance().spawn(
+            std::string("init:") + tasks_[i].name,
+            [this, i]() { run_task(static_cast<int>(i)); }));
+    }
+    for (auto& th : threads) th.join();
+
+    wall_us_ = metrics_now_us() - t0_us_;
+    g_boot_seconds.set(wall_us_ / 1e6);
+    return true;
+}
+
+void InitGraph::print_timeline() const {
+    constexpr int kBarWidth = 40;
+    const double scale = wall_us_ > 0 ? static_cast<double>(kBarWidth) / wall_us_ : 0.0;
+    uint64_t serial_us = 0;
+
+    fprintf(stderr, "[Boot] Init timeline (%.1f ms):\n", wall_us_ / 1000.0);
+    for (const auto& t : tasks_) {
+        char bar[kBarWidth + 1];
+        int from = static_cast<int>(t.start_us * scale);
+        int to = static_cast<int>(t.end_us * scale);
+        if (to == from && to < kBarWidth) to++;
+        for (int i = 0; i < kBarWidth; i++) bar[i] = (i >= from && i < to) ? '#' : '.';
+        bar[kBarWidth] = '\0';
+        fprintf(stderr, "[Boot]   %-8s %s %7.1f -> %7.1f ms  %s\n", t.name, bar,
+                t.start_us / 1000.0, t.end_us / 1000.0, t.ok ? "ok" : "FAILED");
+        serial_us += t.end_us - t.start_us;
+    }
+
+    // Walk back from the last task to finish through the dependency that
+    // released it; that chain is what bounded the boot time.
+    int cur = -1;
+    for (size_t i = 0; i < tasks_.size(); i++) {
+        if (cur < 0 || tasks_[i].end_us > tasks_[cur].end_us) cur = static_cast<int>(i);
+    }
+    std::vector<int> path;
+    while (cur >= 0) {
+        path.push_back(cur);
+        int prev = -1;
+        for (int d : tasks_[cur].deps) {
+            if (prev < 0 || tasks_[d].end_us > tasks_[prev].end_us) prev = d;
+        }
+        cur = prev;
+    }
+
+    std::string line;
+    for (auto it = path.rbegin(); it != path.rend(); ++it) {
+        const Task& t = tasks_[*it];
+        char part[64];
+        snprintf(part, sizeof(part), "%s%s %.1f ms", line.empty() ? "" : " -> ",
+                 t.name, (t.end_us - t.start_us) / 1000.0);
+        line += part;
+    }
+    fprintf(stderr, "[Boot] Critical path: %s\n", line.c_str());
+    fprintf(stderr, "[Boot] %.1f ms of work in %.1f ms wall\n",
+            serial_us / 1000.0, wall_us_ / 1000.0);
+}
+
+void InitGraph::report_ready() {
+    // Field 22, starttime, in clock ticks since boot; comm may hold spaces
+    FILE* fp = fopen("/proc/self/stat", "r");
+    if (!fp) return;
+    char buf[512];
+    size_t n = fread(buf, 1, sizeof(buf) - 1, fp);
+    fclose(fp);
+    buf[n] = '\0';
+    const char* p = strrchr(buf, ')');
+    unsigned long long start_ticks = 0;
+    if (!p || sscanf(p + 2, "%*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %*u %*u "
+                            "%*d %*d %*d %*d %*d %*d %llu", &start_ticks) != 1) {
+        return;
+    }
+
+    struct timespec ts;
+    clock_gettime(CLOCK_BOOTTIME, &ts);
+    double now_s = ts.tv_sec + ts.tv_nsec / 1e9;
+    double ready_s = now_s - static_cast<double>(start_ticks) / sysconf(_SC_CLK_TCK);
+    g_ready_seconds.set(ready_s);
+    fprintf(stderr, "[Boot] Ready %.0f ms after exec\n", ready_s * 1000.0);
+}
+
+} // namespace cinepi
@@ -0,0 +1,207 @@
+/**
+ * CinePi Camera - Jank Detector
+ * Phase bookkeeping is a fixed array on the main thread (no allocation on
+ * the hot path); the record is only assembled when a frame is over budget.
+ */
+
+#include "core/jank_detector.h"
+#include "core/constants.h"
+#include "core/metrics.h"
+#include "core/trace.h"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+namespace cinepi {
+
+static Counter& g_jank_frames = Metrics::instance().counter(
+    "cinepi_jank_frames_total", "Main-loop iterations over the jank threshold");
+
+static std::thread::id g_frame_thread;
+
+static void copy_str(char* dst, size_t len, const char* src) {
+    strncpy(dst, src ? src : "", len - 1);
+    dst[len - 1] = '\0';
+}
+
+JankDetector& JankDetector::instance() {
+    static JankDetector inst;
+    return inst;
+}
+
+void JankDetector::begin_frame() {
+    g_frame_thread = std::this_thread::get_id();
+    in_frame_ = true;
+    n_phases_ = 0;
+    depth_ = 0;
+    frame_start_ = metrics_now_us();
+
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    minflt_start_ = ru.ru_minflt;
+    majflt_start_ = ru.ru_majflt;
+}
+
+int JankDetector::slot_for(const char* name) {
+    for (int i = 0; i < n_phases_; i++) {
+        if (phases_[i].name == name) return i;
+    }
+    if (n_phases_ == kMaxPhases) return -1;
+    phases_[n_phases_] = PhaseSlot{name, 0, 0};
+    return n_phases_++;
+}
+
+void JankDetector::add_phase(const char* name, uint64_t us) {
+    if (!in_frame_) return;
+    int idx = slot_for(name);
+    if (idx < 0) return;
+    phases_[idx].total_us += us;
+    // Time before begin_frame() still counts towards the frame
+    frame_start_ -= us;
+}
+
+void JankDetector::set_scene(int id, const char* name) {
+    scene_ = id;
+    scene_name_ = name;
+}
+
+void JankDetector::note(const char* what, const char* detail, uint64_t dur_us) {
+    std::lock_guard<std::mutex> lk(mtx_);
+    JankNote& n = notes_[note_head_ % kMaxNotes];
+    copy_str(n.what, sizeof(n.what), what);
+    // Keep the tail of long paths, it carries the file name
+    size_t len = detail ? strlen(detail) : 0;
+    copy_str(n.detail, sizeof(n.detail),
+             len >= sizeof(n.detail) ? detail + len - (sizeof(n.detail) - 1) : detail);
+    n.ts_us = metrics_now_us();
+    n.dur_us = static_cast<uint32_t>(dur_us);
+    note_head_++;
+}
+
+JankDetector::Phase::Phase(const char* name) : idx_(-1), start_(0) {
+    JankDetector& d = instance();
+    if (!d.in_frame_ || std::this_thread::get_id() != g_frame_thread) return;
+    if (d.depth_ == kMaxPhases) return;
+    idx_ = d.slot_for(name);
+    if (idx_ < 0) return;
+    d.stack_[d.depth_++] = idx_;
+    start_ = metrics_now_us();
+}
+
+JankDetector::Phase::~Phase() {
+    if (idx_ < 0) return;
+    JankDetector& d = instance();
+    uint64_t dur = metrics_now_us() - start_;
+    d.phases_[idx_].total_us += dur;
+    d.depth_--;
+    if (d.depth_ > 0) d.phases_[d.stack_[d.depth_ - 1]].child_us += dur;
+}
+
+void JankDetector::end_frame() {
+    if (!in_frame_) return;
+    in_frame_ = false;
+
+    uint64_t frame_us = metrics_now_us() - frame_start_;
+    if (frame_us < threshold_us_) return;
+
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    uint32_t minflt = static_cast<uint32_t>(ru.ru_minflt - minflt_start_);
+    uint32_t majflt = static_cast<uint32_t>(ru.ru_majflt - majflt_start_);
+
+    // Attribute to the phase with the most exclusive time
+    int worst = -1;
+    uint64_t worst_us = 0;
+    for (int i = 0; i < n_phases_; i++) {
+        uint64_t excl = phases_[i].total_us - phases_[i].child_us;
+        if (excl > worst_us) { worst_us = excl; worst = i; }
+    }
+
+    jank_count_++;
+    g_jank_frames.inc();
+    fprintf(stderr, "[Jank] %.1f ms frame: %s %.1f ms (scene=%s, faults %u/%u)\n",
+            frame_us / 1000.0, worst >= 0 ? phases_[worst].name : "?", worst_us / 1000.0,
+            scene_name_, minflt, majflt);
+
+    write_record(frame_us, minflt, majflt);
+}
+
+void JankDetector::write_record(uint64_t frame_us, uint32_t minflt, uint32_t majflt) {
+    if (!log_path_) return;
+
+    JankRecord rec = {};
+    rec.magic = JANK_MAGIC;
+    rec.start_us = frame_start_;
+    rec.frame_us = static_cast<uint32_t>(frame_us);
+    rec.minflt = minflt;
+    rec.majflt = majflt;
+    rec.scene = static_cast<uint8_t>(scene_);
+    copy_str(rec.scene_name, sizeof(rec.scene_name), scene_name_);
+    rec.n_phases = static_cast<uint8_t>(n_phases_);
+
+    std::vector<JankNote> notes;
+    {
+        std::lock_guard<std::mutex> lk(mtx_);
+        int n = note_head_ < kMaxNotes ? note_head_ : kMaxNotes;
+        for (int i = note_head_ - n; i < note_head_; i++)
+            notes.push_back(notes_[i % kMaxNotes]);
+    }
+    rec.n_notes = static_cast<uint8_t>(notes.size());
+
+    std::vector<Tracer::Sample> trace;
+    if (Tracer::instance().enabled())
+        Tracer::instance().collect(frame_start_, kMaxTrace, trace);
+    rec.n_trace = static_cast<uint16_t>(trace.size());
+
+    rec.size = static_cast<uint32_t>(sizeof(JankRecord)
+             + rec.n_phases * sizeof(JankPhase)
+             + rec.n_notes * sizeof(JankNote)
+             + rec.n_trace * sizeof(JankTraceEvent));
+
+    std::vector<uint8_t> buf;
+    buf.reserve(rec.size);
+    auto append = [&buf](const void* p, size_t n) {
+        const uint8_t* b = static_cast<const uint8_t*>(p);
+        buf.insert(buf.end(), b, b + n);
+    };
+
+    append(&rec, sizeof(rec));
+    for (int i = 0; i < n_phases_; i++) {
+        JankPhase ph = {};
+        copy_str(ph.name, sizeof(ph.name), phases_[i].name);
+        ph.total_us = static_cast<uint32_t>(phases_[i].total_us);
+        ph.exclusive_us = static_cast<uint32_t>(phases_[i].total_us - phases_[i].child_us);
+        append(&ph, sizeof(ph));
+    }
+    for (const auto& n : notes) append(&n, sizeof(n));
+    for (const auto& s : trace) {
+        JankTraceEvent te = {};
+        copy_str(te.name, sizeof(te.name), s.name);
+        te.ts_us = s.ts_us;
+        te.dur_us = static_cast<uint32_t>(s.dur_us);
+        te.tid = s.tid;
+        append(&te, sizeof(te));
+    }
+
+    // Keep one previous generation so the log cannot fill /tmp
+    struct stat st;
+    if (stat(log_path_, &st) == 0 && st.st_size > JANK_LOG_MAX_BYTES) {
+        std::string old = std::string(log_path_) + ".1";
+        rename(log_path_, old.c_str());
+    }
+
+    int fd = open(log_path_, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd < 0) return;
+    ssize_t n = write(fd, buf.data(), buf.size());   // single append per record
+    (void)n;
+    close(fd);
+}
+
+} // namespace cinepi
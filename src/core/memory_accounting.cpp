@@ -0,0 +1,140 @@
+/**
+ * CinePi Camera - Memory Accounting
+ * smaps_rollup + cgroup memory files + registered subsystem sources.
+ */
+
+#include "core/memory_accounting.h"
+#include "core/metrics.h"
+
+#include <cstdio>
+#include <cstring>
+
+namespace cinepi {
+
+static constexpr uint64_t kMiB = 1024 * 1024;
+
+uint64_t MemorySnapshot::dmabuf_total() const {
+    uint64_t sum = 0;
+    for (const auto& it : items)
+        if (it.dmabuf) sum += it.bytes;
+    return sum;
+}
+
+uint64_t MemorySnapshot::headroom() const {
+    if (!cgroup_limit) return 0;
+    return cgroup_current < cgroup_limit ? cgroup_limit - cgroup_current : 0;
+}
+
+MemoryAccounting& MemoryAccounting::instance() {
+    static MemoryAccounting inst;
+    return inst;
+}
+
+void MemoryAccounting::add_source(const std::string& name, Source fn, bool dmabuf) {
+    sources_.push_back({name, std::move(fn), dmabuf});
+}
+
+static void read_smaps_rollup(MemorySnapshot& s) {
+    FILE* fp = fopen("/proc/self/smaps_rollup", "r");
+    if (!fp) return;
+
+    char line[128];
+    unsigned long long kb;
+    while (fgets(line, sizeof(line), fp)) {
+        if      (sscanf(line, "Rss: %llu kB", &kb) == 1)       s.rss  = kb * 1024;
+        else if (sscanf(line, "Pss: %llu kB", &kb) == 1)       s.pss  = kb * 1024;
+        else if (sscanf(line, "Anonymous: %llu kB", &kb) == 1) s.anon = kb * 1024;
+        else if (sscanf(line, "Swap: %llu kB", &kb) == 1)      s.swap = kb * 1024;
+    }
+    fclose(fp);
+    s.file = s.rss > s.anon ? s.rss - s.anon : 0;
+}
+
+static bool read_u64_file(const std::string& path, uint64_t& out) {
+    FILE* fp = fopen(path.c_str(), "r");
+    if (!fp) return false;
+    char buf[32] = {};
+    bool ok = fgets(buf, sizeof(buf), fp) != nullptr;
+    fclose(fp);
+    if (!ok || strncmp(buf, "max", 3) == 0) return false;   // v2 "max" = unlimited
+    unsigned long long v = 0;
+    if (sscanf(buf, "%llu", &v) != 1) return false;
+    out = v;
+    return true;
+}
+
+// systemd puts the service in its own cgroup; MemoryLimit= lands in
+// memory.max (v2) or memory.limit_in_bytes (v1).
+static void read_cgroup(MemorySnapshot& s) {
+    FILE* fp = fopen("/proc/self/cgroup", "r");
+    if (!fp) return;
+
+    char line[256];
+    std::string v2_path, v1_path;
+    while (fgets(line, sizeof(line), fp)) {
+        line[strcspn(line, "\n")] = '\0';
+        if (strncmp(line, "0::", 3) == 0) {
+            v2_path = line + 3;
+        } else if (const char* p = strstr(line, ":memory:")) {
+            v1_path = p + 8;
+        }
+    }
+    fclose(fp);
+
+    if (!v1_path.empty()) {
+        std::string dir = "/sys/fs/cgroup/memory" + v1_path;
+        uint64_t limit = 0;
+        // v1 reports "unlimited" as a huge page-aligned number
+        if (read_u64_file(dir + "/memory.limit_in_bytes", limit) && limit < (1ULL << 50))
+            s.cgroup_limit = limit;
+        read_u64_file(dir + "/memory.usage_in_bytes", s.cgroup_current);
+    } else if (!v2_path.empty()) {
+        std::string dir = "/sys/fs/cgroup" + v2_path;
+        read_u64_file(dir + "/memory.max", s.cgroup_limit);
+        read_u64_file(dir + "/memory.current", s.cgroup_current);
+    }
+}
+
+MemorySnapshot MemoryAccounting::sample() const {
+    MemorySnapshot s;
+    read_smaps_rollup(s);
+    read_cgroup(s);
+    for (const auto& src : sources_) {
+        s.items.push_back({src.name, src.fn ? src.fn() : 0, src.dmabuf});
+    }
+    return s;
+}
+
+void MemoryAccounting::report() const {
+    MemorySnapshot s = sample();
+    auto& m = Metrics::instance();
+    const char* help = "Memory by subsystem (process totals from smaps_rollup)";
+
+    fprintf(stderr, "[Memory] RSS %.1f MB (anon %.1f, file %.1f) PSS %.1f MB swap %.1f MB\n",
+            s.rss / double(kMiB), s.anon / double(kMiB), s.file / double(kMiB),
+            s.pss / double(kMiB), s.swap / double(kMiB));
+    m.gauge("cinepi_memory_bytes{kind=\"rss\"}", help).set(double(s.rss));
+    m.gauge("cinepi_memory_bytes{kind=\"pss\"}", help).set(double(s.pss));
+    m.gauge("cinepi_memory_bytes{kind=\"anon\"}", help).set(double(s.anon));
+    m.gauge("cinepi_memory_bytes{kind=\"swap\"}", help).set(double(s.swap));
+
+    for (const auto& it : s.items) {
+        fprintf(stderr, "[Memory]   %-18s %8.2f MB%s\n",
+                it.name.c_str(), it.bytes / double(kMiB), it.dmabuf ? "  (dmabuf)" : "");
+        m.gauge("cinepi_memory_bytes{kind=\"" + it.name + "\"}", help).set(double(it.bytes));
+    }
+
+    if (s.cgroup_limit) {
+        fprintf(stderr, "[Memory] cgroup %.1f / %.1f MB, headroom %.1f MB (dmabuf/CMA %.1f MB outside RSS)\n",
+                s.cgroup_current / double(kMiB), s.cgroup_limit / double(kMiB),
+                s.headroom() / double(kMiB), s.dmabuf_total() / double(kMiB));
+        m.gauge("cinepi_memory_bytes{kind=\"cgroup_limit\"}", help).set(double(s.cgroup_limit));
+        m.gauge("cinepi_memory_bytes{kind=\"cgroup_current\"}", help).set(double(s.cgroup_current));
+        m.gauge("cinepi_memory_bytes{kind=\"headroom\"}", help).set(double(s.headroom()));
+    } else {
+        fprintf(stderr, "[Memory] No cgroup memory limit found (dmabuf %.1f MB)\n",
+                s.dmabuf_total() / double(kMiB));
+    }
+}
+
+} // namespace cinepi
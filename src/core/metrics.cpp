@@ -0,0 +1,256 @@
+/**
+ * CinePi Camera - Metrics
+ * Lock-free metric updates, Prometheus text rendering and the Unix socket
+ * endpoint (served from the event loop, one short write per connection).
+ */
+
+#include "core/metrics.h"
+#include "core/event_loop.h"
+
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+namespace cinepi {
+
+// ─── Histogram ─────────────────────────────────────────────────────
+
+int Histogram::index_of(uint64_t us) {
+    if (us < static_cast<uint64_t>(kSub)) return static_cast<int>(us);
+    int msb = 63 - __builtin_clzll(us);
+    if (msb >= kMaxExp) return kBuckets;   // overflow slot, no finite bound
+    int sub = static_cast<int>((us >> (msb - kSubBits)) & (kSub - 1));
+    return kSub + (msb - kSubBits) * kSub + sub;
+}
+
+uint64_t Histogram::upper_bound_us(int i) {
+    if (i < kSub) return static_cast<uint64_t>(i);
+    int exp = (i - kSub) / kSub + kSubBits;
+    int sub = (i - kSub) % kSub;
+    return (static_cast<uint64_t>(kSub + sub + 1) << (exp - kSubBits)) - 1;
+}
+
+void Histogram::record_us(uint64_t us) {
+    buckets_[index_of(us)].fetch_add(1, std::memory_order_relaxed);
+    sum_us_.fetch_add(us, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+uint64_t metrics_now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+// ─── Registry ──────────────────────────────────────────────────────
+
+Metrics& Metrics::instance() {
+    static Metrics inst;
+    return inst;
+}
+
+Metrics::Entry* Metrics::find(const std::string& name) {
+    for (auto& e : entries_) {
+        if (e.name == name) return &e;
+    }
+    return nullptr;
+}
+
+Counter& Metrics::counter(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (Entry* e = find(name)) return *e->c;
+    Entry e{name, help, Kind::Counter, std::make_unique<Counter>(), nullptr, nullptr};
+    entries_.push_back(std::move(e));
+    return *entries_.back().c;
+}
+
+Gauge& Metrics::gauge(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (Entry* e = find(name)) return *e->g;
+    Entry e{name, help, Kind::Gauge, nullptr, std::make_unique<Gauge>(), nullptr};
+    entries_.push_back(std::move(e));
+    return *entries_.back().g;
+}
+
+Histogram& Metrics::histogram(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> lk(mtx_);
+    if (Entry* e = find(name)) return *e->h;
+    Entry e{name, help, Kind::Histogram, nullptr, nullptr, std::make_unique<Histogram>()};
+    entries_.push_back(std::move(e));
+    return *entries_.back().h;
+}
+
+static std::string base_name(const std::string& name) {
+    return name.substr(0, name.find('{'));
+}
+
+std::string Metrics::render() const {
+    std::lock_guard<std::mutex> lk(mtx_);
+    std::string out;
+    out.reserve(16384);
+    char line[256];
+
+    // Series of one family must be contiguous even if registered apart
+    std::vector<const Entry*> order;
+    std::vector<bool> done(entries_.size(), false);
+    for (size_t i = 0; i < entries_.size(); i++) {
+        if (done[i]) continue;
+        std::string base = base_name(entries_[i].name);
+        for (size_t j = i; j < entries_.size(); j++) {
+            if (!done[j] && base_name(entries_[j].name) == base) {
+                order.push_back(&entries_[j]);
+                done[j] = true;
+            }
+        }
+    }
+
+    std::string last_base;
+    for (const Entry* ep : order) {
+        const Entry& e = *ep;
+        std::string base = base_name(e.name);
+        if (base != last_base) {
+            const char* type = e.kind == Kind::Counter ? "counter"
+                             : e.kind == Kind::Gauge   ? "gauge" : "histogram";
+            out += "# HELP " + base + " " + e.help + "\n";
+            out += "# TYPE " + base + " " + type + "\n";
+            last_base = base;
+        }
+
+        switch (e.kind) {
+        case Kind::Counter:
+            snprintf(line, sizeof(line), "%s %llu\n", e.name.c_str(),
+                     (unsigned long long)e.c->value());
+            out += line;
+            break;
+        case Kind::Gauge:
+            snprintf(line, sizeof(line), "%s %.10g\n", e.name.c_str(), e.g->value());
+            out += line;
+            break;
+        case Kind::Histogram: {
+            const Histogram& h = *e.h;
+            int last = -1;
+            for (int i = 0; i < Histogram::kBuckets; i++)
+                if (h.bucket(i)) last = i;
+
+            // Buckets up to the highest populated one keep the text short;
+            // overflow values are only in +Inf (count)
+            uint64_t cum = 0;
+            for (int i = 0; i <= last; i++) {
+                cum += h.bucket(i);
+                snprintf(line, sizeof(line), "%s_bucket{le=\"%.6g\"} %llu\n", e.name.c_str(),
+                         Histogram::upper_bound_us(i) / 1e6, (unsigned long long)cum);
+                out += line;
+            }
+            snprintf(line, sizeof(line), "%s_bucket{le=\"+Inf\"} %llu\n%s_sum %.6f\n%s_count %llu\n",
+                     e.name.c_str(), (unsigned long long)h.count(),
+                     e.name.c_str(), h.sum_us() / 1e6,
+                     e.name.c_str(), (unsigned long long)h.count());
+            out += line;
+            break;
+        }
+        }
+    }
+    return out;
+}
+
+// ─── Unix socket endpoint ──────────────────────────────────────────
+
+MetricsServer::MetricsServer() = default;
+
+MetricsServer::~MetricsServer() {
+    deinit();
+}
+
+bool MetricsServer::init(EventLoop& loop, const char* path) {
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        fprintf(stderr, "[Metrics] Socket path too long: %s\n", path);
+        return false;
+    }
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+    listen_fd_ = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        fprintf(stderr, "[Metrics] socket failed: %s\n", strerror(errno));
+        return false;
+    }
+
+    unlink(path);  // stale socket from a previous run
+    if (bind(listen_fd_, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(listen_fd_, 4) != 0) {
+        fprintf(stderr, "[Metrics] bind/listen %s failed: %s\n", path, strerror(errno));
+        close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    if (!loop.add_fd(listen_fd_, EPOLLIN, [this](uint32_t) { on_accept(); })) {
+        close(listen_fd_);
+        listen_fd_ = -1;
+        unlink(path);
+        return false;
+    }
+
+    loop_ = &loop;
+    path_ = path;
+    fprintf(stderr, "[Metrics] Serving on %s\n", path);
+    return true;
+}
+
+void MetricsServer::deinit() {
+    if (listen_fd_ < 0) return;
+    if (loop_) loop_->remove_fd(listen_fd_);
+    close(listen_fd_);
+    unlink(path_.c_str());
+    listen_fd_ = -1;
+    loop_ = nullptr;
+}
+
+// Resident set size, refreshed per scrape.
+static void update_process_gauges() {
+    static Gauge& rss = Metrics::instance().gauge(
+        "cinepi_process_resident_bytes", "Resident set size from /proc/self/statm");
+
+    FILE* fp = fopen("/proc/self/statm", "r");
+    if (!fp) return;
+    unsigned long size = 0, resident = 0;
+    if (fscanf(fp, "%lu %lu", &size, &resident) == 2) {
+        rss.set(static_cast<double>(resident) * sysconf(_SC_PAGESIZE));
+    }
+    fclose(fp);
+}
+
+void MetricsServer::on_accept() {
+    for (;;) {
+        int fd = accept4(listen_fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) return;  // EAGAIN: backlog drained
+
+        update_process_gauges();
+        std::string body = Metrics::instance().render();
+
+        char header[128];
+        int hlen = snprintf(header, sizeof(header),
+                            "HTTP/1.0 200 OK\r\n"
+                            "Content-Type: text/plain; version=0.0.4\r\n"
+                            "Content-Length: %zu\r\n\r\n", body.size());
+        std::string reply(header, hlen);
+        reply += body;
+
+        // A few KB fits the socket buffer; a stalled reader just gets cut off
+        size_t off = 0;
+        while (off < reply.size()) {
+            ssize_t n = send(fd, reply.data() + off, reply.size() - off, MSG_NOSIGNAL | MSG_DONTWAIT);
+            if (n <= 0) break;
+            off += static_cast<size_t>(n);
+        }
+        close(fd);
+    }
+}
+
+} // namespace cinepi
@@ -0,0 +1,190 @@
+/**
+ * CinePi Camera - Thread Registry
+ * sched_setaffinity / sched_setscheduler per tid, stats from /proc/self/task.
+ */
+
+#include "core/thread_registry.h"
+
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <algorithm>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+
+namespace cinepi {
+
+static pid_t current_tid() {
+    return static_cast<pid_t>(syscall(SYS_gettid));
+}
+
+// utime + stime of one task in ms, false if the task is gone.
+static bool read_task_cpu(pid_t tid, uint64_t& cpu_ms) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/self/task/%d/stat", tid);
+    FILE* fp = fopen(path, "r");
+    if (!fp) return false;
+
+    char buf[512];
+    size_t n = fread(buf, 1, sizeof(buf) - 1, fp);
+    fclose(fp);
+    buf[n] = '\0';
+
+    // comm may contain spaces; fields resume after the last ')'
+    const char* p = strrchr(buf, ')');
+    if (!p) return false;
+
+    unsigned long utime = 0, stime = 0;
+    if (sscanf(p + 1, " %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu",
+               &utime, &stime) != 2)
+        return false;
+
+    static const long hz = sysconf(_SC_CLK_TCK);
+    cpu_ms = (static_cast<uint64_t>(utime) + stime) * 1000 / (hz > 0 ? hz : 100);
+    return true;
+}
+
+static uint64_t read_task_nvcsw(pid_t tid) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/self/task/%d/status", tid);
+    FILE* fp = fopen(path, "r");
+    if (!fp) return 0;
+
+    char line[128];
+    unsigned long long v = 0;
+    while (fgets(line, sizeof(line), fp)) {
+        if (sscanf(line, "nonvoluntary_ctxt_switches: %llu", &v) == 1) break;
+    }
+    fclose(fp);
+    return v;
+}
+
+ThreadRegistry& ThreadRegistry::instance() {
+    static ThreadRegistry inst;
+    return inst;
+}
+
+void ThreadRegistry::set_plan(const std::vector<ThreadPlanEntry>& plan) {
+    std::lock_guard<std::mutex> lk(mtx_);
+    plan_ = plan;
+}
+
+const ThreadPlanEntry* ThreadRegistry::find_plan(const std::string& name) const {
+    for (const auto& p : plan_) {
+        if (name.compare(0, p.name.size(), p.name) == 0) return &p;
+    }
+    return nullptr;
+}
+
+std::string ThreadRegistry::apply(const ThreadPlanEntry& plan, pid_t tid) {
+    char desc[64] = "";
+    int len = 0;
+
+    if (plan.cpu_mask) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu = 0; cpu < 32; cpu++) {
+            if (plan.cpu_mask & (1u << cpu)) CPU_SET(cpu, &set);
+        }
+        if (sched_setaffinity(tid, sizeof(set), &set) == 0) {
+            len += snprintf(desc + len, sizeof(desc) - len, "cpus=0x%x ", plan.cpu_mask);
+        } else {
+            fprintf(stderr, "[Threads] %s: affinity 0x%x failed: %s\n",
+                    plan.name.c_str(), plan.cpu_mask, strerror(errno));
+        }
+    }
+
+    if (plan.realtime) {
+        struct sched_param sp = {};
+        sp.sched_priority = plan.priority;
+        if (sched_setscheduler(tid, SCHED_FIFO, &sp) == 0) {
+            len += snprintf(desc + len, sizeof(desc) - len, "fifo/%d", plan.priority);
+        } else {
+            // Needs CAP_SYS_NICE (or RLIMIT_RTPRIO); keep running as SCHED_OTHER
+            fprintf(stderr, "[Threads] %s: SCHED_FIFO %d failed: %s\n",
+                    plan.name.c_str(), plan.priority, strerror(errno));
+        }
+    } else if (plan.priority != 0) {
+        if (setpriority(PRIO_PROCESS, tid, plan.priority) == 0) {
+            len += snprintf(desc + len, sizeof(desc) - len, "nice=%d", plan.priority);
+        } else {
+            fprintf(stderr, "[Threads] %s: nice %d failed: %s\n",
+                    plan.name.c_str(), plan.priority, strerror(errno));
+        }
+    }
+
+    return desc[0] ? std::string(desc) : std::string("default");
+}
+
+void ThreadRegistry::register_current(const std::string& name) {
+    pid_t tid = current_tid();
+
+    std::lock_guard<std::mutex> lk(mtx_);
+    for (const auto& e : threads_) {
+        if (e.tid == tid) return;
+    }
+
+    // The main thread's comm is the process name (ps, pidof, journal), and
+    // whatever it is pinned to every later thread inherits: stats only
+    bool main_thread = tid == getpid();
+    if (!main_thread) {
+        // Kernel comm is limited to 15 chars + NUL
+        pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+    }
+
+    Entry e;
+    e.name = name;
+    e.tid = tid;
+    const ThreadPlanEntry* plan = main_thread ? nullptr : find_plan(name);
+    e.sched = plan ? apply(*plan, tid) : std::string("default");
+    read_task_cpu(tid, e.last_cpu_ms);
+    e.last_nvcsw = read_task_nvcsw(tid);
+    threads_.push_back(e);
+
+    fprintf(stderr, "[Threads] %s (tid %d): %s\n", name.c_str(), tid, e.sched.c_str());
+}
+
+void ThreadRegistry::unregister_current() {
+    pid_t tid = current_tid();
+    std::lock_guard<std::mutex> lk(mtx_);
+    threads_.erase(std::remove_if(threads_.begin(), threads_.end(),
+                                  [tid](const Entry& e) { return e.tid == tid; }),
+                   threads_.end());
+}
+
+std::thread ThreadRegistry::spawn(const std::string& name, std::function<void()> fn) {
+    return std::thread([this, name, fn = std::move(fn)]() {
+        register_current(name);
+        fn();
+        unregister_current();
+    });
+}
+
+void ThreadRegistry::report() {
+    std::lock_guard<std::mutex> lk(mtx_);
+    for (auto it = threads_.begin(); it != threads_.end();) {
+        uint64_t cpu_ms = 0;
+        if (!read_task_cpu(it->tid, cpu_ms)) {
+            // Library thread exited without unregistering
+            it = threads_.erase(it);
+            continue;
+        }
+        uint64_t nvcsw = read_task_nvcsw(it->tid);
+
+        fprintf(stderr, "[Threads] %-10s tid %-5d %-16s cpu %6llu ms (+%llu) | invol %llu (+%llu)\n",
+                it->name.c_str(), it->tid, it->sched.c_str(),
+                (unsigned long long)cpu_ms,
+                (unsigned long long)(cpu_ms - it->last_cpu_ms),
+                (unsigned long long)nvcsw,
+                (unsigned long long)(nvcsw - it->last_nvcsw));
+
+        it->last_cpu_ms = cpu_ms;
+        it->last_nvcsw = nvcsw;
+        ++it;
+    }
+}
+
+} // namespace cinepi
@@ -0,0 +1,125 @@
+/**
+ * CinePi Camera - Trace Recorder
+ * Per-thread rings (registered once per thread under a mutex) and the
+ * trace-event JSON writer used by the SIGUSR1 handler.
+ */
+
+#include "core/trace.h"
+
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <unistd.h>
+#include <sys/syscall.h>
+
+namespace cinepi {
+
+uint64_t trace_now_us() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000ULL + ts.tv_nsec / 1000;
+}
+
+Tracer& Tracer::instance() {
+    static Tracer inst;
+    return inst;
+}
+
+Tracer::Ring* Tracer::thread_ring() {
+    static thread_local Ring* ring = nullptr;
+    if (ring) return ring;
+
+    auto r = std::make_unique<Ring>();
+    r->tid = static_cast<int>(syscall(SYS_gettid));
+    ring = r.get();
+
+    // Rings outlive their threads so a dump still shows exited workers
+    std::lock_guard<std::mutex> lk(rings_mtx_);
+    rings_.push_back(std::move(r));
+    return ring;
+}
+
+void Tracer::record(const char* name, uint64_t start_us, uint64_t dur_us) {
+    Ring* r = thread_ring();
+    uint32_t h = r->head.load(std::memory_order_relaxed);
+    r->events[h & (Ring::kSize - 1)] = Event{name, start_us, dur_us};
+    r->head.store(h + 1, std::memory_order_release);
+}
+
+size_t Tracer::collect(uint64_t since_us, size_t max, std::vector<Sample>& out) {
+    size_t added = 0;
+    std::lock_guard<std::mutex> lk(rings_mtx_);
+    for (const auto& r : rings_) {
+        uint32_t head = r->head.load(std::memory_order_acquire);
+        uint32_t count = head < Ring::kSize ? head : Ring::kSize;
+        // Newest first, so a busy thread cannot starve the others of slots
+        for (uint32_t i = head; i != head - count && added < max; i--) {
+            const Event& e = r->events[(i - 1) & (Ring::kSize - 1)];
+            // Events land at scope end, so an outer scope may precede its
+            // children in the ring: filter rather than stop at the first miss
+            if (!e.name || e.ts_us < since_us) continue;
+            out.push_back(Sample{e.name, e.ts_us, e.dur_us, r->tid});
+            added++;
+        }
+    }
+    return added;
+}
+
+static void read_thread_name(int tid, char* out, size_t len) {
+    char path[64];
+    snprintf(path, sizeof(path), "/proc/self/task/%d/comm", tid);
+    out[0] = '\0';
+    FILE* fp = fopen(path, "r");
+    if (fp) {
+        if (fgets(out, static_cast<int>(len), fp)) out[strcspn(out, "\n")] = '\0';
+        fclose(fp);
+    }
+    if (!out[0]) snprintf(out, len, "tid %d", tid);
+}
+
+bool Tracer::dump(const char* path, int window_sec) {
+    FILE* fp = fopen(path, "w");
+    if (!fp) {
+        fprintf(stderr, "[Trace] Cannot write %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    uint64_t now = trace_now_us();
+    uint64_t since = now > static_cast<uint64_t>(window_sec) * 1000000ULL
+                   ? now - static_cast<uint64_t>(window_sec) * 1000000ULL : 0;
+    int pid = static_cast<int>(getpid());
+    size_t written = 0;
+
+    fprintf(fp, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    bool first = true;
+
+    std::lock_guard<std::mutex> lk(rings_mtx_);
+    for (const auto& r : rings_) {
+        char tname[32];
+        read_thread_name(r->tid, tname, sizeof(tname));
+        fprintf(fp, "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":%d,\"tid\":%d,"
+                    "\"args\":{\"name\":\"%s\"}}",
+                first ? "" : ",\n", pid, r->tid, tname);
+        first = false;
+
+        uint32_t head = r->head.load(std::memory_order_acquire);
+        uint32_t count = head < Ring::kSize ? head : Ring::kSize;
+        for (uint32_t i = head - count; i != head; i++) {
+            const Event& e = r->events[i & (Ring::kSize - 1)];
+            if (!e.name || e.ts_us < since) continue;
+            fprintf(fp, ",\n{\"ph\":\"X\",\"name\":\"%s\",\"pid\":%d,\"tid\":%d,"
+                        "\"ts\":%llu,\"dur\":%llu}",
+                    e.name, pid, r->tid,
+                    (unsigned long long)e.ts_us, (unsigned long long)e.dur_us);
+            written++;
+        }
+    }
+
+    fprintf(fp, "\n]}\n");
+    fclose(fp);
+    fprintf(stderr, "[Trace] Wrote %zu events (last %ds) to %s\n", written, window_sec, path);
+    return true;
+}
+
+} // namespace cinepi
@@ -0,0 +1,175 @@
+/**
+ * CinePi Camera - Backlight
+ */
+
+#include "drivers/backlight.h"
+#include "core/constants.h"
+#include "core/event_loop.h"
+#include "core/metrics.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace cinepi {
+
+static Counter& g_requests = Metrics::instance().counter(
+    "cinepi_backlight_requests_total", "Backlight level changes requested");
+static Counter& g_writes = Metrics::instance().counter(
+    "cinepi_backlight_writes_total", "sysfs brightness writes after coalescing");
+static Gauge& g_level = Metrics::instance().gauge(
+    "cinepi_backlight_level", "Backlight level written (0-255)");
+
+static constexpr float GAMMA = 2.2f;
+// Ambient gain: 1.0 at ~300 lx (indoors), +-0.25 per decade of lux
+static constexpr float AMBIENT_REF_LOG_LUX  = 2.5f;
+static constexpr float AMBIENT_GAIN_PER_DEC = 0.25f;
+static constexpr float AMBIENT_GAIN_MIN     = 0.5f;
+static constexpr float AMBIENT_GAIN_MAX     = 1.5f;
+static constexpr float LUX_HYSTERESIS_DEC   = 0.15f;   // ~40% change in lux
+
+static float to_perceived(int level) {
+    return std::pow(std::clamp(level, 0, 255) / 255.0f, 1.0f / GAMMA);
+}
+
+Backlight& Backlight::instance() {
+    static Backlight inst;
+    return inst;
+}
+
+bool Backlight::open() {
+    if (bri_fd_ >= 0) return true;
+    bri_fd_ = ::open(BACKLIGHT_BRIGHTNESS, O_WRONLY | O_CLOEXEC);
+    if (bri_fd_ < 0) {
+        fprintf(stderr, "[Backlight] Cannot open %s: %s\n", BACKLIGHT_BRIGHTNESS, strerror(errno));
+        return false;
+    }
+    power_fd_ = ::open(BACKLIGHT_POWER, O_WRONLY | O_CLOEXEC);
+
+    int fd = ::open(BACKLIGHT_MAX, O_RDONLY | O_CLOEXEC);
+    if (fd >= 0) {
+        char buf[16] = {};
+        if (read(fd, buf, sizeof(buf) - 1) > 0 && atoi(buf) > 0) max_raw_ = atoi(buf);
+        ::close(fd);
+    }
+    written_raw_ = -1;
+    return true;
+}
+
+void Backlight::close() {
+    detach();
+    if (bri_fd_ >= 0) ::close(bri_fd_);
+    if (power_fd_ >= 0) ::close(power_fd_);
+    bri_fd_ = power_fd_ = -1;
+}
+
+void Backlight::attach(EventLoop& loop) {
+    if (loop_) return;
+    loop_ = &loop;
+    // Disarmed until a fade starts
+    timer_fd_ = loop.add_timer(BACKLIGHT_TICK_MS, [this](uint64_t) { tick(); });
+    if (timer_fd_ >= 0) loop.set_timer(timer_fd_, 0);
+}
+
+void Backlight::detach() {
+    if (loop_ && timer_fd_ >= 0) loop_->remove_timer(timer_fd_);
+    loop_ = nullptr;
+    timer_fd_ = -1;
+}
+
+bool Backlight::write_attr(int fd, int value) {
+    if (fd < 0) return false;
+    char buf[12];
+    int n = snprintf(buf, sizeof(buf), "%d", value);
+    return pwrite(fd, buf, n, 0) == n;
+}
+
+float Backlight::target_perceived() const {
+    float p = to_perceived(user_level_);
+    if (auto_) p *= ambient_gain_;
+    return std::clamp(p, to_perceived(BACKLIGHT_MIN_LEVEL), 1.0f);
+}
+
+void Backlight::set_level(int level, int fade_ms) {
+    g_requests.inc();
+    user_level_ = std::clamp(level, BACKLIGHT_MIN_LEVEL, 255);
+    if (!blank_) retarget(fade_ms < 0 ? BACKLIGHT_FADE_MS : fade_ms);
+}
+
+void Backlight::set_auto(bool on) {
+    if (auto_ == on) return;
+    auto_ = on;
+    anchor_log_lux_ = -1.0f;
+    if (!blank_) retarget(BACKLIGHT_AUTO_FADE_MS);
+}
+
+void Backlight::update_ambient(float lux) {
+    if (!auto_ || lux <= 0.0f) return;
+    float log_lux = std::log10(lux);
+    if (anchor_log_lux_ >= 0.0f && std::fabs(log_lux - anchor_log_lux_) < LUX_HYSTERESIS_DEC) return;
+    anchor_log_lux_ = log_lux;
+    ambient_gain_ = std::clamp(1.0f + AMBIENT_GAIN_PER_DEC * (log_lux - AMBIENT_REF_LOG_LUX),
+                               AMBIENT_GAIN_MIN, AMBIENT_GAIN_MAX);
+    if (!blank_) retarget(BACKLIGHT_AUTO_FADE_MS);
+}
+
+void Backlight::set_blank(bool blank) {
+    if (blank == blank_) return;
+    blank_ = blank;
+    if (blank) {
+        // Immediate: standby wants the panel dark now, not after a fade
+        fade_us_ = 0;
+        if (loop_ && timer_fd_ >= 0) loop_->set_timer(timer_fd_, 0);
+        write_level(0.0f);
+        write_attr(power_fd_, 4);   // FB_BLANK_POWERDOWN
+    } else {
+        write_attr(power_fd_, 0);
+        retarget(BACKLIGHT_WAKE_FADE_MS);
+    }
+}
+
+void Backlight::retarget(int fade_ms) {
+    uint64_t now = metrics_now_us();
+    // Start from where the current fade is now, so retargets stay smooth
+    float current = written_raw_ >= 0 ? std::pow(written_raw_ / static_cast<float>(max_raw_), 1.0f / GAMMA)
+                                      : 0.0f;
+    from_ = current;
+    to_ = target_perceived();
+    fade_start_us_ = now;
+    fade_us_ = static_cast<uint64_t>(std::max(fade_ms, 0)) * 1000;
+
+    if (fade_us_ == 0 || !loop_ || timer_fd_ < 0) {
+        fade_us_ = 0;
+        write_level(to_);
+        return;
+    }
+    loop_->set_timer(timer_fd_, BACKLIGHT_TICK_MS, 0);
+}
+
+void Backlight::tick() {
+    float t = fade_us_ ? static_cast<float>(metrics_now_us() - fade_start_us_) / fade_us_ : 1.0f;
+    if (t >= 1.0f) {
+        write_level(to_);
+        fade_us_ = 0;
+        if (loop_ && timer_fd_ >= 0) loop_->set_timer(timer_fd_, 0);
+        return;
+    }
+    write_level(from_ + (to_ - from_) * t);
+}
+
+void Backlight::write_level(float perceived) {
+    int raw = static_cast<int>(std::lround(max_raw_ * std::pow(perceived, GAMMA)));
+    if (raw == written_raw_) return;
+    if (!write_attr(bri_fd_, raw)) return;
+    written_raw_ = raw;
+    level_ = raw * 255 / max_raw_;
+    g_writes.inc();
+    g_level.set(level_);
+}
+
+} // namespace cinepi
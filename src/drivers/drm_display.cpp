@@ -30,8 +30,10 @@
  */
 
 #include "drivers/drm_display.h"
+#include "drivers/backlight.h"
+#include "core/metrics.h"
+#include "core/trace.h"
 #include "core/constants.h"
-#include "core/config.h"
 
 #include <cstring>
 #include <cstdio>
@@ -39,6 +41,7 @@
 #include <fcntl.h>
 #include <unistd.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 
 #include <xf86drm.h>
 #include <xf86drmMode.h>
@@ -46,24 +49,38 @@
 
 namespace cinepi {
 
+static Histogram& g_cam_present = Metrics::instance().histogram(
+    "cinepi_drm_camera_present_seconds", "drmModeSetPlane for a camera frame");
+static Histogram& g_ui_commit = Metrics::instance().histogram(
+    "cinepi_drm_ui_commit_seconds", "UI overlay flip + back-buffer sync");
+
+static constexpr uint32_t SPLASH_MAGIC = 0x4C505343;  // "CSPL", scripts/png_to_raw.py
+
 // ─── internal helper ─────────────────────────────────────────────────────────
 
-static void set_plane_zpos(int fd, uint32_t plane_id, uint64_t zpos)
+// Property id by name on a plane, 0 if the driver does not expose it.
+static uint32_t find_plane_prop(int fd, uint32_t plane_id, const char *name)
 {
     drmModeObjectProperties *props =
         drmModeObjectGetProperties(fd, plane_id, DRM_MODE_OBJECT_PLANE);
-    if (!props) return;
-    for (uint32_t i = 0; i < props->count_props; i++) {
+    if (!props) return 0;
+    uint32_t id = 0;
+    for (uint32_t i = 0; i < props->count_props && !id; i++) {
         drmModePropertyRes *p = drmModeGetProperty(fd, props->props[i]);
         if (p) {
-            if (strcmp(p->name, "zpos") == 0)
-                drmModeObjectSetProperty(fd, plane_id,
-                                         DRM_MODE_OBJECT_PLANE,
-                                         p->prop_id, zpos);
+            if (strcmp(p->name, name) == 0) id = p->prop_id;
             drmModeFreeProperty(p);
         }
     }
     drmModeFreeObjectProperties(props);
+    return id;
+}
+
+static void set_plane_zpos(int fd, uint32_t plane_id, uint64_t zpos)
+{
+    uint32_t prop = find_plane_prop(fd, plane_id, "zpos");
+    if (prop)
+        drmModeObjectSetProperty(fd, plane_id, DRM_MODE_OBJECT_PLANE, prop, zpos);
 }
 
 // ─── ctor / dtor ─────────────────────────────────────────────────────────────
@@ -75,6 +92,8 @@ DrmDisplay::~DrmDisplay() { deinit(); }
 
 bool DrmDisplay::init()
 {
+    uint64_t open_us = metrics_now_us();
+
     // Prefer card1 (DSI), fall back to card0
     const char *dev_paths[] = { "/dev/dri/card1", "/dev/dri/card0" };
     for (auto path : dev_paths) {
@@ -93,9 +112,13 @@ bool DrmDisplay::init()
     if (drmSetClientCap(drm_fd_, DRM_CLIENT_CAP_UNIVERSAL_PLANES, 1) != 0)
         fprintf(stderr, "[DRM] WARNING: universal planes not available\n");
 
-    if (!find_crtc())      return false;   // sets mode_w_, mode_h_
+    if (!find_crtc())      return false;   // sets mode_w_, mode_h_, shows splash
+    if (splash_ != Splash::None)
+        fprintf(stderr, "[DRM] splash on screen %.1f ms after open\n",
+                (metrics_now_us() - open_us) / 1000.0);
     if (!alloc_ui_bufs())  return false;   // double-buffered ARGB overlay
     discover_overlay_plane();              // ui_plane_id_
+    discover_splash_plane();               // splash_plane_id_ (cross-fade)
 
     initialized_ = true;
     fprintf(stderr,
@@ -127,6 +150,7 @@ void DrmDisplay::deinit()
         drm_mode_destroy_dumb dd{}; dd.handle = blank_gem_;
         drmIoctl(drm_fd_, DRM_IOCTL_MODE_DESTROY_DUMB, &dd);
         blank_gem_ = 0;
+        blank_size_ = 0;
     }
 
     close(drm_fd_);
@@ -153,10 +177,15 @@ bool DrmDisplay::set_camera_dmabuf(int dmabuf_fd, int width, int height,
                                     int stride, uint32_t drm_fourcc)
 {
     if (drm_fd_ < 0 || !camera_plane_id_) return false;
+    ScopedLatency present_timer(g_cam_present);
+    TRACE_SCOPE("drm.set_camera_dmabuf");
 
     CamFbEntry *e = get_or_import(dmabuf_fd, width, height, stride, drm_fourcc);
     if (!e) return false;
 
+    // Lift the splash above the primary plane before the camera replaces it
+    if (splash_ != Splash::None) step_splash_fade();
+
     // Hardware scaler: camera dimensions → full CRTC area.  Zero CPU cost.
     int ret = drmModeSetPlane(drm_fd_, camera_plane_id_, crtc_id_,
                                e->fb_id, 0,
@@ -176,9 +205,30 @@ bool DrmDisplay::set_camera_dmabuf(int dmabuf_fd, int width, int height,
 // ─── public: commit (flip UI overlay) ────────────────────────────────────────
 // Presents the BACK buffer and makes the old FRONT the new BACK.
 
+uint64_t DrmDisplay::dumb_bytes() const
+{
+    return ui_bufs_[0].size + ui_bufs_[1].size + blank_size_;
+}
+
+void DrmDisplay::mark_ui_dirty(int x1, int y1, int x2, int y2)
+{
+    if (!ui_dirty_) {
+        dirty_x1_ = x1; dirty_y1_ = y1; dirty_x2_ = x2; dirty_y2_ = y2;
+        ui_dirty_ = true;
+        return;
+    }
+    if (x1 < dirty_x1_) dirty_x1_ = x1;
+    if (y1 < dirty_y1_) dirty_y1_ = y1;
+    if (x2 > dirty_x2_) dirty_x2_ = x2;
+    if (y2 > dirty_y2_) dirty_y2_ = y2;
+}
+
 bool DrmDisplay::commit()
 {
     if (drm_fd_ < 0 || !ui_plane_id_) return true;
+    if (!ui_dirty_) return true;   // nothing drawn → keep scanning out front
+    ScopedLatency commit_timer(g_ui_commit);
+    TRACE_SCOPE("drm.commit");
 
     UiBuf &front = ui_bufs_[back_idx_];
 
@@ -199,6 +249,17 @@ bool DrmDisplay::commit()
 
     // Flip: the just-displayed buffer becomes the new back buffer for LVGL to draw into
     back_idx_ ^= 1;
+    flip_count_++;
+
+    // Bring the new back buffer up to date with what was just presented,
+    // otherwise the next partial flush would resurrect stale pixels.
+    UiBuf &back = ui_bufs_[back_idx_];
+    int row_bytes = (dirty_x2_ - dirty_x1_ + 1) * (UI_BPP / 8);
+    for (int y = dirty_y1_; y <= dirty_y2_; y++) {
+        size_t off = static_cast<size_t>(y) * front.pitch + dirty_x1_ * (UI_BPP / 8);
+        memcpy(back.map + off, front.map + off, row_bytes);
+    }
+    ui_dirty_ = false;
     return true;
 }
 
@@ -206,15 +267,23 @@ bool DrmDisplay::commit()
 
 void DrmDisplay::set_blank(bool blank)
 {
-    FILE *fp = fopen(BACKLIGHT_POWER, "w");
-    if (fp) { fprintf(fp, "%d", blank ? 4 : 0); fclose(fp); }
+    Backlight::instance().set_blank(blank);
+}
+
+// ─── public: DRM event dispatch ──────────────────────────────────────────────
+
+void DrmDisplay::handle_events()
+{
+    if (drm_fd_ < 0) return;
 
-    fp = fopen(BACKLIGHT_BRIGHTNESS, "w");
-    if (fp) {
-        int bri = blank ? 0 : ConfigManager::instance().get().display.brightness;
-        fprintf(fp, "%d", bri);
-        fclose(fp);
-    }
+    drmEventContext ctx{};
+    ctx.version = 2;
+    ctx.vblank_handler = [](int, unsigned int, unsigned int, unsigned int,
+                            void *user) {
+        static_cast<DrmDisplay *>(user)->vblank_count_++;
+    };
+    ctx.page_flip_handler = ctx.vblank_handler;
+    drmHandleEvent(drm_fd_, &ctx);
 }
 
 // ─── private: CRTC / mode setup ──────────────────────────────────────────────
@@ -252,6 +321,7 @@ bool DrmDisplay::find_crtc()
 
     mode_w_ = mode.hdisplay;
     mode_h_ = mode.vdisplay;
+    if (mode.vrefresh > 0) refresh_hz_ = mode.vrefresh;
     fprintf(stderr, "[DRM] connector %u (%s) → mode %dx%d@%dHz\n",
             conn->connector_id,
             conn->connector_type == DRM_MODE_CONNECTOR_DSI ? "DSI" : "other",
@@ -307,12 +377,17 @@ crtc_ok:
         return false;
     }
     blank_gem_ = cd.handle;
+    blank_size_ = cd.size;
 
-    // Zero-fill seed buffer
+    // Fill seed buffer with the boot splash, black if there is none
     drm_mode_map_dumb md{}; md.handle = cd.handle;
     if (drmIoctl(drm_fd_, DRM_IOCTL_MODE_MAP_DUMB, &md) == 0) {
         void *p = mmap(nullptr, cd.size, PROT_WRITE, MAP_SHARED, drm_fd_, md.offset);
-        if (p != MAP_FAILED) { memset(p, 0, cd.size); munmap(p, cd.size); }
+        if (p != MAP_FAILED) {
+            if (load_splash(static_cast<uint8_t *>(p), cd.pitch)) splash_ = Splash::Shown;
+            else memset(p, 0, cd.size);
+            munmap(p, cd.size);
+        }
     }
 
     // Register seed FB (XRGB8888 – alpha channel ignored by primary plane)
@@ -392,9 +467,98 @@ void DrmDisplay::discover_overlay_plane()
             ui_plane_id_, DISPLAY_W, DISPLAY_H);
 }
 
+// ─── private: boot splash ─────────────────────────────────────────────────────
+// Raw file from scripts/png_to_raw.py: {"CSPL", w, h, stride} + XRGB8888 rows.
+// mmap + row memcpy, no decoding on the boot path.
+
+bool DrmDisplay::load_splash(uint8_t *dst, uint32_t pitch)
+{
+    int fd = open(SPLASH_RAW_PATH, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return false;
+
+    struct stat st;
+    uint32_t hdr[4] = {};
+    if (fstat(fd, &st) != 0 || read(fd, hdr, sizeof(hdr)) != sizeof(hdr) ||
+        hdr[0] != SPLASH_MAGIC) {
+        fprintf(stderr, "[DRM] %s: not a splash file\n", SPLASH_RAW_PATH);
+        close(fd);
+        return false;
+    }
+    int w = static_cast<int>(hdr[1]), h = static_cast<int>(hdr[2]);
+    uint32_t stride = hdr[3];
+    if (w != mode_w_ || h != mode_h_ ||
+        static_cast<uint64_t>(st.st_size) < sizeof(hdr) + static_cast<uint64_t>(stride) * h) {
+        fprintf(stderr, "[DRM] splash is %dx%d, mode is %dx%d – skipped\n",
+                w, h, mode_w_, mode_h_);
+        close(fd);
+        return false;
+    }
+
+    void *m = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED) return false;
+
+    const uint8_t *src = static_cast<const uint8_t *>(m) + sizeof(hdr);
+    size_t row = static_cast<size_t>(w) * 4;
+    for (int y = 0; y < h; y++)
+        memcpy(dst + static_cast<size_t>(y) * pitch, src + static_cast<size_t>(y) * stride, row);
+    munmap(m, st.st_size);
+    return true;
+}
+
+void DrmDisplay::discover_splash_plane()
+{
+    if (splash_ == Splash::None) return;
+
+    // A second overlay with a plane-alpha property lets the splash fade;
+    // without one the first camera frame simply replaces it.
+    splash_plane_id_ = find_plane_type(DRM_PLANE_TYPE_OVERLAY, ui_plane_id_);
+    if (splash_plane_id_)
+        splash_alpha_prop_ = find_plane_prop(drm_fd_, splash_plane_id_, "alpha");
+    if (!splash_alpha_prop_) {
+        splash_plane_id_ = 0;
+        fprintf(stderr, "[DRM] no alpha-capable spare plane – splash will cut, not fade\n");
+        return;
+    }
+    set_plane_zpos(drm_fd_, splash_plane_id_, 5);
+}
+
+void DrmDisplay::step_splash_fade()
+{
+    if (!splash_plane_id_) { splash_ = Splash::None; return; }
+
+    uint64_t now = metrics_now_us();
+    if (splash_ == Splash::Shown) {
+        drmModeObjectSetProperty(drm_fd_, splash_plane_id_, DRM_MODE_OBJECT_PLANE,
+                                 splash_alpha_prop_, 0xFFFF);
+        if (drmModeSetPlane(drm_fd_, splash_plane_id_, crtc_id_, blank_fb_id_, 0,
+                            0, 0, mode_w_, mode_h_,
+                            0, 0, mode_w_ << 16, mode_h_ << 16) != 0) {
+            fprintf(stderr, "[DRM] SetPlane(splash) failed: %s\n", strerror(errno));
+            splash_ = Splash::None;
+            return;
+        }
+        splash_ = Splash::Fading;
+        splash_fade_start_us_ = now;
+        return;
+    }
+
+    uint64_t elapsed_ms = (now - splash_fade_start_us_) / 1000;
+    if (elapsed_ms >= static_cast<uint64_t>(SPLASH_FADE_MS)) {
+        drmModeSetPlane(drm_fd_, splash_plane_id_, crtc_id_, 0, 0,
+                        0, 0, 0, 0, 0, 0, 0, 0);
+        splash_ = Splash::None;
+        fprintf(stderr, "[DRM] splash faded out\n");
+        return;
+    }
+    uint64_t alpha = 0xFFFF - 0xFFFF * elapsed_ms / SPLASH_FADE_MS;
+    drmModeObjectSetProperty(drm_fd_, splash_plane_id_, DRM_MODE_OBJECT_PLANE,
+                             splash_alpha_prop_, alpha);
+}
+
 // ─── private: plane type query ────────────────────────────────────────────────
 
-uint32_t DrmDisplay::find_plane_type(uint32_t wanted_type)
+uint32_t DrmDisplay::find_plane_type(uint32_t wanted_type, uint32_t exclude)
 {
     drmModePlaneRes *pr = drmModeGetPlaneResources(drm_fd_);
     if (!pr) return 0;
@@ -405,7 +569,7 @@ uint32_t DrmDisplay::find_plane_type(uint32_t wanted_type)
         if (!pl) continue;
 
         // Must belong to our CRTC
-        if (!(pl->possible_crtcs & (1u << crtc_idx_))) {
+        if (!(pl->possible_crtcs & (1u << crtc_idx_)) || pl->plane_id == exclude) {
             drmModeFreePlane(pl); continue;
         }
 
@@ -1,17 +1,30 @@
 /**
  * CinePi Camera - GPIO Driver (libgpiod v2.x)
- * Shutter button (GPIO26), Rotary Encoder (GPIO5/6/13),
+ * Shutter button (GPIO26, half-press GPIO16), Rotary Encoder (GPIO5/6/13),
  * LED Flash (GPIO27), Vibration Motor (GPIO18)
- * 
+ *
  * NOTE: Uses libgpiod v2.x API which has significant changes from v1.x:
  * - Batch request of lines instead of individual line requests
  * - Different enum names and value representations
  * - Different function signatures for get/set
+ *
+ * Buttons and encoder contacts pull to ground, so inputs are requested
+ * active-low: ACTIVE / rising edge = pressed or contact closed.  Debounce
+ * is done by gpiolib (cdev debounce period), so every edge event read
+ * here is already clean.
+ *
+ * Flash and vibration edges are queued for the "gpio-out" thread, which
+ * sleeps until the earliest one is due.  Under its SCHED_FIFO plan there
+ * is no timer slack, so an edge lands within tens of microseconds.
  */
 
 #include "drivers/gpio_driver.h"
 #include "core/constants.h"
+#include "core/metrics.h"
+#include "core/thread_registry.h"
+#include "drivers/sensor_ring.h"
 
+#include <algorithm>
 #include <cstdio>
 #include <cstring>
 #include <cerrno>
@@ -21,11 +34,71 @@
 
 namespace cinepi {
 
+static constexpr int GPIO_EVENT_BATCH = 16;   // edge events read per wakeup
+
+static Counter& g_gpio_events = Metrics::instance().counter(
+    "cinepi_gpio_events_total", "Debounced GPIO edge events read from the line request");
+static Counter& g_encoder_invalid = Metrics::instance().counter(
+    "cinepi_encoder_invalid_total", "Encoder transitions that reveal a missed edge");
+static Histogram& g_gpio_latency = Metrics::instance().histogram(
+    "cinepi_gpio_event_latency_seconds", "Kernel edge timestamp to dispatch on the event loop");
+static Histogram& g_output_lateness = Metrics::instance().histogram(
+    "cinepi_gpio_output_lateness_seconds", "Scheduled output edge to line actually switched");
+
+// Haptic patterns: alternating on/off durations (ms), starting with on
+struct HapticPattern {
+    const int* ms;
+    int n;
+};
+static const int kShutterMs[] = {30};
+static const int kSavedMs[]   = {40, 60, 40};
+static const int kErrorMs[]   = {80, 60, 80, 60, 80};
+
+static HapticPattern pattern_for(Haptic h) {
+    switch (h) {
+    case Haptic::Shutter: return {kShutterMs, 1};
+    case Haptic::Saved:   return {kSavedMs, 3};
+    case Haptic::Error:   return {kErrorMs, 5};
+    }
+    return {kShutterMs, 1};
+}
+
 static uint64_t now_ms() {
     using namespace std::chrono;
     return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
 }
 
+// Adds one group of lines with shared settings to a line config
+static bool add_lines(gpiod_line_config* cfg, const unsigned int* lines, size_t n,
+                      gpiod_line_direction dir, unsigned long debounce_us) {
+    gpiod_line_settings* s = gpiod_line_settings_new();
+    if (!s) return false;
+    gpiod_line_settings_set_direction(s, dir);
+    if (dir == GPIOD_LINE_DIRECTION_INPUT) {
+        gpiod_line_settings_set_bias(s, GPIOD_LINE_BIAS_PULL_UP);
+        gpiod_line_settings_set_active_low(s, true);
+        gpiod_line_settings_set_edge_detection(s, GPIOD_LINE_EDGE_BOTH);
+        gpiod_line_settings_set_debounce_period_us(s, debounce_us);
+        // Same clock as metrics_now_us(), so presses compare with capture times
+        gpiod_line_settings_set_event_clock(s, GPIOD_LINE_CLOCK_MONOTONIC);
+    } else {
+        gpiod_line_settings_set_output_value(s, GPIOD_LINE_VALUE_INACTIVE);
+    }
+    bool ok = gpiod_line_config_add_line_settings(cfg, lines, n, s) == 0;
+    gpiod_line_settings_free(s);
+    return ok;
+}
+
+static gpiod_line_request* request(gpiod_chip* chip, gpiod_line_config* cfg) {
+    gpiod_request_config* rc = gpiod_request_config_new();
+    if (!rc) return nullptr;
+    gpiod_request_config_set_consumer(rc, "cinepi");
+    gpiod_request_config_set_event_buffer_size(rc, GPIO_EVENT_BATCH * 4);
+    gpiod_line_request* req = gpiod_chip_request_lines(chip, rc, cfg);
+    gpiod_request_config_free(rc);
+    return req;
+}
+
 GpioDriver::GpioDriver() = default;
 
 GpioDriver::~GpioDriver() {
@@ -33,25 +106,89 @@ GpioDriver::~GpioDriver() {
 }
 
 bool GpioDriver::init() {
-    // GPIO initialization - graceful degradation
-    // Buttons/Encoder are optional hardware; app continues without them
-    fprintf(stderr, "[GPIO] Skipping GPIO init (optional hardware)\n");
+    chip_ = gpiod_chip_open(GPIO_CHIP);
+    if (!chip_) {
+        fprintf(stderr, "[GPIO] Cannot open %s: %s\n", GPIO_CHIP, strerror(errno));
+        return false;
+    }
+
+    static const unsigned int buttons[] = {GPIO_SHUTTER_BTN, GPIO_SHUTTER_HALF, GPIO_ENCODER_BTN};
+    static const unsigned int encoder[] = {GPIO_ENCODER_CLK, GPIO_ENCODER_DT};
+    gpiod_line_config* in_cfg = gpiod_line_config_new();
+    if (in_cfg &&
+        add_lines(in_cfg, buttons, 3, GPIOD_LINE_DIRECTION_INPUT, GPIO_BUTTON_DEBOUNCE_US) &&
+        add_lines(in_cfg, encoder, 2, GPIOD_LINE_DIRECTION_INPUT, GPIO_ENCODER_DEBOUNCE_US)) {
+        input_req_ = request(chip_, in_cfg);
+    }
+    if (in_cfg) gpiod_line_config_free(in_cfg);
+    if (!input_req_) {
+        fprintf(stderr, "[GPIO] Input line request failed: %s\n", strerror(errno));
+        deinit();
+        return false;
+    }
+    events_ = gpiod_edge_event_buffer_new(GPIO_EVENT_BATCH);
+    enc_clk_ = gpiod_line_request_get_value(input_req_, GPIO_ENCODER_CLK) == GPIOD_LINE_VALUE_ACTIVE;
+    enc_dt_  = gpiod_line_request_get_value(input_req_, GPIO_ENCODER_DT) == GPIOD_LINE_VALUE_ACTIVE;
+    encoder_.reset(enc_clk_, enc_dt_);
+
+    // Outputs are optional: without them the buttons still work
+    static const unsigned int outputs[] = {GPIO_LED_FLASH, GPIO_VIBRATION};
+    gpiod_line_config* out_cfg = gpiod_line_config_new();
+    if (out_cfg && add_lines(out_cfg, outputs, 2, GPIOD_LINE_DIRECTION_OUTPUT, 0)) {
+        output_req_ = request(chip_, out_cfg);
+    }
+    if (out_cfg) gpiod_line_config_free(out_cfg);
+    if (!output_req_) {
+        fprintf(stderr, "[GPIO] Output line request failed: %s (no flash/vibration)\n", strerror(errno));
+    } else {
+        out_stop_ = false;
+        out_thread_ = ThreadRegistry::instance().spawn("gpio-out", [this]() { output_thread(); });
+    }
+
     last_activity_.store(now_ms());
-    running_ = true;
-    // Don't start thread if no GPIO hardware available
+    fprintf(stderr, "[GPIO] Inputs on %s (debounce %d/%d us), outputs %s\n", GPIO_CHIP,
+            GPIO_BUTTON_DEBOUNCE_US, GPIO_ENCODER_DEBOUNCE_US, output_req_ ? "ok" : "none");
     return true;
 }
 
 void GpioDriver::deinit() {
-    running_ = false;
-    if (thread_.joinable()) thread_.join();
-    // No resources to release - GPIO was optional
+    if (out_thread_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lk(out_mtx_);
+            out_stop_ = true;
+            out_edges_.clear();
+        }
+        out_cv_.notify_all();
+        out_thread_.join();
+    }
+    if (output_req_) {
+        set_output(GPIO_LED_FLASH, false);
+        set_output(GPIO_VIBRATION, false);
+        gpiod_line_request_release(output_req_);
+        output_req_ = nullptr;
+    }
+    if (input_req_) {
+        gpiod_line_request_release(input_req_);
+        input_req_ = nullptr;
+    }
+    if (events_) {
+        gpiod_edge_event_buffer_free(events_);
+        events_ = nullptr;
+    }
+    if (chip_) {
+        gpiod_chip_close(chip_);
+        chip_ = nullptr;
+    }
 }
 
-void GpioDriver::on_shutter(ButtonCallback cb) {
+void GpioDriver::on_shutter(PressCallback cb) {
     shutter_cb_ = std::move(cb);
 }
 
+void GpioDriver::on_shutter_half(HalfPressCallback cb) {
+    shutter_half_cb_ = std::move(cb);
+}
+
 void GpioDriver::on_encoder_button(ButtonCallback cb) {
     enc_btn_cb_ = std::move(cb);
 }
@@ -60,23 +197,144 @@ void GpioDriver::on_encoder_rotate(EncoderCallback cb) {
     enc_rot_cb_ = std::move(cb);
 }
 
+void GpioDriver::set_output(unsigned int line, bool on) {
+    if (!output_req_) return;
+    gpiod_line_request_set_value(output_req_, line,
+                                 on ? GPIOD_LINE_VALUE_ACTIVE : GPIOD_LINE_VALUE_INACTIVE);
+}
+
 void GpioDriver::set_flash(bool on) {
-    // Flash hardware not initialized
-    (void)on;  // suppress unused warning
+    set_output(GPIO_LED_FLASH, on);
 }
 
 void GpioDriver::vibrate(int duration_ms) {
-    // Vibration motor not initialized - optional hardware
-    (void)duration_ms;
+    if (!out_thread_.joinable() || duration_ms <= 0) return;
+    std::lock_guard<std::mutex> lk(out_mtx_);
+    // A new pulse while one is running just extends it
+    cancel(GPIO_VIBRATION);
+    uint64_t now = sensor_clock_ns();
+    schedule({now, GPIO_VIBRATION, true});
+    schedule({now + duration_ms * 1000000ULL, GPIO_VIBRATION, false});
+}
+
+void GpioDriver::vibrate(Haptic pattern) {
+    if (!out_thread_.joinable()) return;
+    HapticPattern p = pattern_for(pattern);
+    std::lock_guard<std::mutex> lk(out_mtx_);
+    cancel(GPIO_VIBRATION);
+    uint64_t t = sensor_clock_ns();
+    for (int i = 0; i < p.n; i++) {
+        schedule({t, GPIO_VIBRATION, i % 2 == 0});
+        t += p.ms[i] * 1000000ULL;
+    }
+    schedule({t, GPIO_VIBRATION, false});
+}
+
+bool GpioDriver::schedule_flash(uint64_t on_ns, uint64_t off_ns) {
+    if (!out_thread_.joinable() || off_ns <= on_ns || on_ns <= sensor_clock_ns()) return false;
+    std::lock_guard<std::mutex> lk(out_mtx_);
+    cancel(GPIO_LED_FLASH);
+    flash_ = FlashPulse();
+    flash_.target_on_ns = on_ns;
+    flash_.target_off_ns = off_ns;
+    schedule({on_ns, GPIO_LED_FLASH, true});
+    schedule({off_ns, GPIO_LED_FLASH, false});
+    return true;
+}
+
+FlashPulse GpioDriver::last_flash() const {
+    std::lock_guard<std::mutex> lk(out_mtx_);
+    return flash_;
+}
+
+void GpioDriver::schedule(const OutputEdge& e) {
+    auto it = std::upper_bound(out_edges_.begin(), out_edges_.end(), e,
+        [](const OutputEdge& a, const OutputEdge& b) { return a.t_ns < b.t_ns; });
+    bool earliest = it == out_edges_.begin();
+    out_edges_.insert(it, e);
+    if (earliest) out_cv_.notify_one();
+}
+
+// Drops pending edges for a line and leaves it off
+void GpioDriver::cancel(unsigned int line) {
+    out_edges_.erase(std::remove_if(out_edges_.begin(), out_edges_.end(),
+                                    [line](const OutputEdge& e) { return e.line == line; }),
+                     out_edges_.end());
+    set_output(line, false);
+}
+
+void GpioDriver::output_thread() {
+    std::unique_lock<std::mutex> lk(out_mtx_);
+    while (!out_stop_) {
+        if (out_edges_.empty()) {
+            out_cv_.wait(lk);
+            continue;
+        }
+        uint64_t now = sensor_clock_ns();
+        OutputEdge e = out_edges_.front();
+        if (e.t_ns > now) {
+            // Relative wait: the condvar clock is MONOTONIC, edges are BOOTTIME
+            out_cv_.wait_for(lk, std::chrono::nanoseconds(e.t_ns - now));
+            continue;
+        }
+        out_edges_.erase(out_edges_.begin());
+        set_output(e.line, e.on);
+        uint64_t done = sensor_clock_ns();
+        g_output_lateness.record_us((done - e.t_ns) / 1000);
+        if (e.line == GPIO_LED_FLASH) (e.on ? flash_.on_ns : flash_.off_ns) = done;
+    }
 }
 
 uint64_t GpioDriver::last_activity_ms() const {
     return last_activity_.load();
 }
 
-void GpioDriver::poll_thread() {
-    // GPIO poll thread - not started since hardware is optional
-    return;
+int GpioDriver::event_fd() const {
+    return input_req_ ? gpiod_line_request_get_fd(input_req_) : -1;
+}
+
+void GpioDriver::process_events() {
+    if (!input_req_ || !events_) return;
+    // The fd is level-triggered: a full batch leaves the rest for the next wakeup
+    int n = gpiod_line_request_read_edge_events(input_req_, events_, GPIO_EVENT_BATCH);
+    if (n <= 0) return;
+    g_gpio_events.inc(n);
+
+    uint64_t now_us = metrics_now_us();
+    for (int i = 0; i < n; i++) {
+        gpiod_edge_event* ev = gpiod_edge_event_buffer_get_event(events_, i);
+        uint64_t t_ns = gpiod_edge_event_get_timestamp_ns(ev);
+        if (now_us * 1000 > t_ns) g_gpio_latency.record_us(now_us - t_ns / 1000);
+        on_edge(gpiod_edge_event_get_line_offset(ev),
+                gpiod_edge_event_get_event_type(ev) == GPIOD_EDGE_EVENT_RISING_EDGE, t_ns);
+    }
+}
+
+void GpioDriver::on_edge(unsigned int line, bool active, uint64_t t_ns) {
+    last_activity_.store(t_ns / 1000000);
+
+    switch (line) {
+    case GPIO_SHUTTER_BTN:
+        if (active && shutter_cb_) shutter_cb_(t_ns / 1000);
+        break;
+    case GPIO_SHUTTER_HALF:
+        if (shutter_half_cb_) shutter_half_cb_(active, t_ns / 1000);
+        break;
+    case GPIO_ENCODER_BTN:
+        if (active && enc_btn_cb_) enc_btn_cb_();
+        break;
+    case GPIO_ENCODER_CLK:
+    case GPIO_ENCODER_DT: {
+        (line == GPIO_ENCODER_CLK ? enc_clk_ : enc_dt_) = active;
+        uint64_t invalid = encoder_.invalid();
+        int steps = encoder_.update(enc_clk_, enc_dt_, t_ns);
+        if (encoder_.invalid() != invalid) g_encoder_invalid.inc();
+        if (steps != 0 && enc_rot_cb_) enc_rot_cb_(steps);
+        break;
+    }
+    default:
+        break;
+    }
 }
 
 } // namespace cinepi
@@ -0,0 +1,233 @@
+/**
+ * CinePi Camera - I2C Bus
+ * A combined transfer aborts at the first NACK, so a failed batch is
+ * replayed per device to attribute the error and keep the others' data.
+ */
+
+#include "drivers/i2c_bus.h"
+#include "core/event_loop.h"
+#include "core/metrics.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <sys/timerfd.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+namespace cinepi {
+
+static constexpr int      I2C_MAX_RETRIES    = 2;
+static constexpr uint64_t I2C_BATCH_SLACK_US = 2000;   // run reads due this soon now
+static constexpr int      I2C_MAX_MSGS       = 42;     // I2C_RDWR_IOCTL_MAX_MSGS
+
+static Counter& g_batched = Metrics::instance().counter(
+    "cinepi_i2c_batched_total", "Poll reads that shared a combined I2C_RDWR transfer");
+
+// i2c-dev character device
+class I2CDevTransport : public I2CTransport {
+public:
+    explicit I2CDevTransport(int fd) : fd_(fd) {
+        unsigned long funcs = 0;
+        rdwr_ = ioctl(fd_, I2C_FUNCS, &funcs) == 0 && (funcs & I2C_FUNC_I2C);
+    }
+    ~I2CDevTransport() override { ::close(fd_); }
+
+    bool rdwr() const { return rdwr_; }
+
+    bool transfer(i2c_msg* msgs, int n) override {
+        if (rdwr_) {
+            struct i2c_rdwr_ioctl_data data = {msgs, static_cast<uint32_t>(n)};
+            return ioctl(fd_, I2C_RDWR, &data) == n;
+        }
+        // Legacy path: separate write and read, no repeated start
+        for (int i = 0; i < n; i++) {
+            if (ioctl(fd_, I2C_SLAVE, msgs[i].addr) < 0) return false;
+            ssize_t r = (msgs[i].flags & I2C_M_RD) ? ::read(fd_, msgs[i].buf, msgs[i].len)
+                                                   : ::write(fd_, msgs[i].buf, msgs[i].len);
+            if (r != msgs[i].len) return false;
+        }
+        return true;
+    }
+
+private:
+    int fd_;
+    bool rdwr_ = true;   // adapter supports I2C_RDWR (I2C_FUNC_I2C)
+};
+
+I2CBus::I2CBus() = default;
+
+I2CBus::~I2CBus() {
+    close();
+}
+
+bool I2CBus::open(const char* path) {
+    int fd = ::open(path, O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        fprintf(stderr, "[I2C] Failed to open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    auto dev = std::make_unique<I2CDevTransport>(fd);
+    if (!dev->rdwr()) fprintf(stderr, "[I2C] %s has no I2C_RDWR, using I2C_SLAVE transfers\n", path);
+    return open(std::move(dev));
+}
+
+bool I2CBus::open(std::unique_ptr<I2CTransport> transport) {
+    transport_ = std::move(transport);
+    return transport_ != nullptr;
+}
+
+void I2CBus::close() {
+    stop();
+    transport_.reset();
+}
+
+int I2CBus::add_device(const char* name, uint8_t addr) {
+    auto& m = Metrics::instance();
+    std::string label = std::string("{device=\"") + name + "\"}";
+    Device d;
+    d.name = name;
+    d.addr = addr;
+    d.transfers = &m.counter("cinepi_i2c_transfers_total" + label, "I2C transfers per device");
+    d.errors    = &m.counter("cinepi_i2c_errors_total" + label, "Failed I2C transfers per device");
+    d.retries   = &m.counter("cinepi_i2c_retries_total" + label, "Retried I2C transfers per device");
+    devices_.push_back(d);
+    return static_cast<int>(devices_.size()) - 1;
+}
+
+bool I2CBus::transfer_retry(int dev, i2c_msg* msgs, int n) {
+    Device& d = devices_[dev];
+    for (int attempt = 0; attempt <= I2C_MAX_RETRIES; attempt++) {
+        if (attempt > 0) d.retries->inc();
+        if (transfer(msgs, n)) {
+            d.transfers->inc();
+            return true;
+        }
+    }
+    d.errors->inc();
+    return false;
+}
+
+bool I2CBus::read(int dev, int reg, uint8_t* buf, uint16_t len) {
+    uint8_t r = static_cast<uint8_t>(reg);
+    i2c_msg msgs[2];
+    int n = 0;
+    if (reg != I2C_NO_REG) msgs[n++] = {devices_[dev].addr, 0, 1, &r};
+    msgs[n++] = {devices_[dev].addr, I2C_M_RD, len, buf};
+    return transfer_retry(dev, msgs, n);
+}
+
+bool I2CBus::write(int dev, const uint8_t* data, uint16_t len) {
+    i2c_msg msg = {devices_[dev].addr, 0, len, const_cast<uint8_t*>(data)};
+    return transfer_retry(dev, &msg, 1);
+}
+
+bool I2CBus::write_reg(int dev, uint8_t reg, uint8_t val) {
+    uint8_t buf[2] = {reg, val};
+    return write(dev, buf, 2);
+}
+
+bool I2CBus::write_byte(int dev, uint8_t val) {
+    return write(dev, &val, 1);
+}
+
+void I2CBus::add_poll(int dev, int period_ms, int reg, uint16_t len, ReadDone done) {
+    Poll p;
+    p.dev = dev;
+    p.period_us = static_cast<uint64_t>(period_ms) * 1000;
+    p.due_us = 0;
+    p.reg = reg;
+    p.reg_byte = static_cast<uint8_t>(reg);
+    p.buf.resize(len);
+    p.done = std::move(done);
+    polls_.push_back(std::move(p));
+}
+
+bool I2CBus::start(EventLoop& loop) {
+    if (loop_ || polls_.empty()) return loop_ != nullptr;
+    timer_fd_ = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    if (timer_fd_ < 0) return false;
+
+    uint64_t t0 = metrics_now_us();
+    for (auto& p : polls_) p.due_us = t0 + p.period_us;
+    if (!loop.add_fd(timer_fd_, EPOLLIN, [this](uint32_t) { on_timer(); })) {
+        ::close(timer_fd_);
+        timer_fd_ = -1;
+        return false;
+    }
+    loop_ = &loop;
+    arm();
+    return true;
+}
+
+void I2CBus::stop() {
+    if (!loop_) return;
+    loop_->remove_fd(timer_fd_);
+    ::close(timer_fd_);
+    timer_fd_ = -1;
+    loop_ = nullptr;
+    polls_.clear();   // re-registered before the next start()
+}
+
+void I2CBus::arm() {
+    uint64_t next = UINT64_MAX;
+    for (const auto& p : polls_) next = std::min(next, p.due_us);
+    // metrics_now_us() is CLOCK_MONOTONIC, so deadlines are absolute times
+    struct itimerspec its = {};
+    its.it_value.tv_sec = static_cast<time_t>(next / 1000000);
+    its.it_value.tv_nsec = static_cast<long>(next % 1000000) * 1000;
+    timerfd_settime(timer_fd_, TFD_TIMER_ABSTIME, &its, nullptr);
+}
+
+void I2CBus::fill_msgs(Poll& p, i2c_msg* msgs, int* n) {
+    uint8_t addr = devices_[p.dev].addr;
+    if (p.reg != I2C_NO_REG) msgs[(*n)++] = {addr, 0, 1, &p.reg_byte};
+    msgs[(*n)++] = {addr, I2C_M_RD, static_cast<uint16_t>(p.buf.size()), p.buf.data()};
+}
+
+void I2CBus::on_timer() {
+    uint64_t expirations;
+    while (::read(timer_fd_, &expirations, sizeof(expirations)) == sizeof(expirations)) {}
+
+    uint64_t now = metrics_now_us();
+    std::vector<Poll*> due;
+    i2c_msg msgs[I2C_MAX_MSGS];
+    int n = 0;
+    for (auto& p : polls_) {
+        if (p.due_us > now + I2C_BATCH_SLACK_US || n + 2 > I2C_MAX_MSGS) continue;
+        fill_msgs(p, msgs, &n);
+        due.push_back(&p);
+    }
+
+    std::vector<bool> ok(due.size(), false);
+    if (due.size() > 1 && transfer(msgs, n)) {
+        g_batched.inc(due.size());
+        for (size_t i = 0; i < due.size(); i++) {
+            devices_[due[i]->dev].transfers->inc();
+            ok[i] = true;
+        }
+    } else {
+        for (size_t i = 0; i < due.size(); i++) {
+            i2c_msg one[2];
+            int m = 0;
+            fill_msgs(*due[i], one, &m);
+            ok[i] = transfer_retry(due[i]->dev, one, m);
+        }
+    }
+
+    for (size_t i = 0; i < due.size(); i++) {
+        Poll& p = *due[i];
+        // Next deadline stays on the original grid; missed slots are skipped
+        do p.due_us += p.period_us; while (p.due_us <= now);
+        p.done(ok[i], p.buf.data(), static_cast<int>(p.buf.size()));
+    }
+    if (loop_) arm();
+}
+
+} // namespace cinepi
@@ -1,51 +1,44 @@
 /**
  * CinePi Camera - I2C Sensor Drivers
- * BH1750 Light Sensor (0x23) + L3G4200D Gyroscope (0x69)
+ * BH1750 Light Sensor (0x23) + IMU (drivers/imu.h) on the shared I2CBus
  */
 
 #include "drivers/i2c_sensors.h"
 #include "core/constants.h"
+#include "core/metrics.h"
+#include "core/thread_registry.h"
 
+#include <algorithm>
 #include <cstdio>
-#include <cstring>
-#include <cerrno>
 #include <cmath>
-#include <fcntl.h>
-#include <unistd.h>
-#include <sys/ioctl.h>
-#include <linux/i2c-dev.h>
 
 namespace cinepi {
 
 // ─── BH1750 registers ──────────────────────────────────────────────
 static constexpr uint8_t BH1750_POWER_ON       = 0x01;
-static constexpr uint8_t BH1750_CONT_HIRES     = 0x10;  // 1 lx resolution, 120ms
-
-// ─── L3G4200D registers ────────────────────────────────────────────
-static constexpr uint8_t L3G_WHO_AM_I          = 0x0F;
-static constexpr uint8_t L3G_CTRL_REG1         = 0x20;
-static constexpr uint8_t L3G_CTRL_REG4         = 0x23;
-static constexpr uint8_t L3G_OUT_X_L           = 0x28;
-static constexpr float   L3G_SENSITIVITY_250   = 8.75f / 1000.0f;  // deg/s per digit at 250dps
-
-static bool i2c_write_byte(int fd, uint8_t addr, uint8_t val) {
-    if (ioctl(fd, I2C_SLAVE, addr) < 0) return false;
-    return write(fd, &val, 1) == 1;
-}
-
-static bool i2c_write_reg(int fd, uint8_t addr, uint8_t reg, uint8_t val) {
-    if (ioctl(fd, I2C_SLAVE, addr) < 0) return false;
-    uint8_t buf[2] = {reg, val};
-    return write(fd, buf, 2) == 2;
-}
-
-static int i2c_read_bytes(int fd, uint8_t addr, uint8_t reg, uint8_t* buf, int len) {
-    if (ioctl(fd, I2C_SLAVE, addr) < 0) return -1;
-    // Set register address with auto-increment (bit 7 for L3G4200D)
-    uint8_t r = reg | 0x80;
-    if (write(fd, &r, 1) != 1) return -1;
-    return read(fd, buf, len);
-}
+static constexpr uint8_t BH1750_ONCE_HIRES     = 0x20;  // 1 lx resolution, 120ms, then power down
+static constexpr uint8_t BH1750_ONCE_LORES     = 0x23;  // 4 lx resolution, 16ms, then power down
+static constexpr uint64_t BH1750_HIRES_MEAS_US = 180000; // worst-case conversion times
+static constexpr uint64_t BH1750_LORES_MEAS_US = 24000;
+// A 4 lx step is under 2-4% above these; only the dark end (flash decision) needs H-res
+static constexpr float   BH1750_LORES_ABOVE_LUX = 200.0f;
+static constexpr float   BH1750_HIRES_BELOW_LUX = 100.0f;
+static_assert(BH1750_HIRES_MEAS_US < LIGHT_READ_MS * 1000ULL,
+              "one-shot conversion must finish before the next light poll");
+
+// Every supported IMU runs at ~200 Hz
+static constexpr float   GYRO_NOMINAL_PERIOD_US = 5000.0f;
+
+// Zero-rate bias is averaged over the first second the camera is held still
+static constexpr int     GYRO_CAL_SAMPLES      = 200;
+static constexpr float   GYRO_CAL_MAX_STD_DPS  = 1.0f;
+
+static Counter& g_gyro_samples = Metrics::instance().counter(
+    "cinepi_gyro_samples_total", "Gyro samples drained from the IMU FIFO");
+static Counter& g_gyro_overruns = Metrics::instance().counter(
+    "cinepi_gyro_fifo_overruns_total", "FIFO drains that found samples overwritten");
+static Gauge& g_gyro_rate = Metrics::instance().gauge(
+    "cinepi_gyro_rate_hz", "Gyro output data rate measured against CLOCK_MONOTONIC");
 
 I2CSensors::I2CSensors() = default;
 
@@ -53,89 +46,64 @@ I2CSensors::~I2CSensors() {
     deinit();
 }
 
-bool I2CSensors::init() {
-    i2c_fd_ = open(I2C_DEV, O_RDWR);
-    if (i2c_fd_ < 0) {
-        fprintf(stderr, "[I2C] Failed to open %s: %s\n", I2C_DEV, strerror(errno));
-        return false;
-    }
+bool I2CSensors::init(std::unique_ptr<I2CTransport> transport) {
+    if (!(transport ? bus_.open(std::move(transport)) : bus_.open(I2C_DEV))) return false;
+    light_dev_ = bus_.add_device("bh1750", I2C_ADDR_LIGHT);
 
     bh1750_ok_ = init_bh1750();
-    l3g4200d_ok_ = init_l3g4200d();
+    imu_ = ImuDriver::probe(bus_);
+    gyro_last_drain_us_ = metrics_now_us();
 
-    fprintf(stderr, "[I2C] BH1750=%s, L3G4200D=%s\n",
+    fprintf(stderr, "[I2C] BH1750=%s, IMU=%s\n",
             bh1750_ok_ ? "ok" : "fail",
-            l3g4200d_ok_ ? "ok" : "fail");
+            imu_ ? imu_->name() : "none");
 
-    return bh1750_ok_ || l3g4200d_ok_;
+    return bh1750_ok_ || imu_;
 }
 
 bool I2CSensors::init_bh1750() {
-    if (!i2c_write_byte(i2c_fd_, I2C_ADDR_LIGHT, BH1750_POWER_ON)) return false;
-    usleep(10000);
-    if (!i2c_write_byte(i2c_fd_, I2C_ADDR_LIGHT, BH1750_CONT_HIRES)) return false;
-    usleep(180000);  // Wait for first measurement
-    return true;
+    if (!bus_.write_byte(light_dev_, BH1750_POWER_ON)) return false;
+    // Don't block boot on the first conversion; reads before it return the cache
+    return start_light_measurement();
 }
 
-bool I2CSensors::init_l3g4200d() {
-    // Check WHO_AM_I
-    if (ioctl(i2c_fd_, I2C_SLAVE, I2C_ADDR_GYRO) < 0) return false;
-    uint8_t who = 0;
-    uint8_t reg = L3G_WHO_AM_I;
-    if (write(i2c_fd_, &reg, 1) != 1) return false;
-    if (read(i2c_fd_, &who, 1) != 1) return false;
-    if (who != 0xD3) {
-        fprintf(stderr, "[I2C] L3G4200D WHO_AM_I=0x%02X (expected 0xD3)\n", who);
-        return false;
-    }
-
-    // CTRL_REG1: normal mode, all axes enabled, 100Hz ODR
-    i2c_write_reg(i2c_fd_, I2C_ADDR_GYRO, L3G_CTRL_REG1, 0x0F);
-    // CTRL_REG4: 250 dps full scale
-    i2c_write_reg(i2c_fd_, I2C_ADDR_GYRO, L3G_CTRL_REG4, 0x00);
-
+// One-shot conversions: the BH1750 powers down after each, and is only
+// re-armed when the previous result has been read (every LIGHT_READ_MS).
+bool I2CSensors::start_light_measurement() {
+    uint8_t cmd = bh1750_lores_ ? BH1750_ONCE_LORES : BH1750_ONCE_HIRES;
+    uint64_t meas_us = bh1750_lores_ ? BH1750_LORES_MEAS_US : BH1750_HIRES_MEAS_US;
+    if (!bus_.write_byte(light_dev_, cmd)) return false;
+    bh1750_ready_us_ = metrics_now_us() + meas_us;
+    // Stamp the sample at mid-conversion rather than when it is collected
+    bh1750_meas_ns_ = sensor_clock_ns() + meas_us * 500;
     return true;
 }
 
 void I2CSensors::deinit() {
     stop_polling();
-    if (i2c_fd_ >= 0) {
-        close(i2c_fd_);
-        i2c_fd_ = -1;
-    }
+    imu_.reset();
+    bus_.close();
 }
 
 float I2CSensors::read_lux() {
-    if (!bh1750_ok_ || i2c_fd_ < 0) return 0.0f;
-
-    if (ioctl(i2c_fd_, I2C_SLAVE, I2C_ADDR_LIGHT) < 0) return 0.0f;
+    if (!bh1750_ok_ || !bus_.is_open()) return 0.0f;
+    if (polling_ || metrics_now_us() < bh1750_ready_us_) return lux_.load();
 
     uint8_t buf[2] = {};
-    if (read(i2c_fd_, buf, 2) != 2) return 0.0f;
+    if (!bus_.read(light_dev_, I2C_NO_REG, buf, 2)) return 0.0f;
 
     uint16_t raw = (buf[0] << 8) | buf[1];
     return raw / 1.2f;  // BH1750 conversion factor
 }
 
 GyroData I2CSensors::read_gyro() {
+    // Rates of the newest FIFO sample; the FIFO itself belongs to the poll
     GyroData data = {};
-    if (!l3g4200d_ok_ || i2c_fd_ < 0) return data;
-
-    uint8_t buf[6] = {};
-    if (i2c_read_bytes(i2c_fd_, I2C_ADDR_GYRO, L3G_OUT_X_L, buf, 6) != 6) {
-        return data;
-    }
-
-    int16_t raw_x = (int16_t)(buf[1] << 8 | buf[0]);
-    int16_t raw_y = (int16_t)(buf[3] << 8 | buf[2]);
-    int16_t raw_z = (int16_t)(buf[5] << 8 | buf[4]);
-
-    // Convert to degrees/sec, then integrate (simple approximation)
-    data.roll  = raw_x * L3G_SENSITIVITY_250;
-    data.pitch = raw_y * L3G_SENSITIVITY_250;
-    data.yaw   = raw_z * L3G_SENSITIVITY_250;
-
+    GyroSample g;
+    if (!gyro_ring_.at(UINT64_MAX, &g)) return data;
+    data.roll  = g.rate[0];
+    data.pitch = g.rate[1];
+    data.yaw   = g.rate[2];
     return data;
 }
 
@@ -151,50 +119,217 @@ bool I2CSensors::has_movement(float threshold_deg) const {
     return gyro_delta_.load() > threshold_deg;
 }
 
-void I2CSensors::start_polling() {
-    if (running_) return;
-    running_ = true;
-    thread_ = std::thread(&I2CSensors::poll_thread, this);
+bool I2CSensors::start_polling() {
+    if (polling_) return true;
+    if (!poll_loop_.init()) return false;
+
+    // Both periods share the bus time base: every fifth gyro read and the
+    // light read go out in one I2C_RDWR transfer.
+    if (imu_) {
+        bus_.add_poll(imu_->dev(), GYRO_READ_MS, imu_->status_reg(), imu_->status_len(),
+                      [this](bool ok, const uint8_t* data, int) { if (ok) on_gyro_fifo(data); });
+    }
+    if (bh1750_ok_) {
+        bus_.add_poll(light_dev_, LIGHT_READ_MS, I2C_NO_REG, 2,
+                      [this](bool ok, const uint8_t* data, int) { if (ok) on_light(data); });
+    }
+    if (!bus_.start(poll_loop_)) {
+        poll_loop_.deinit();
+        return false;
+    }
+
+    poll_running_ = true;
+    poll_thread_ = ThreadRegistry::instance().spawn("i2c", [this]() {
+        while (poll_running_.load()) poll_loop_.run_once(-1);
+    });
+    polling_ = true;
+    return true;
 }
 
 void I2CSensors::stop_polling() {
-    running_ = false;
-    if (thread_.joinable()) thread_.join();
-}
-
-void I2CSensors::poll_thread() {
-    int light_counter = 0;
-    float pitch_acc = 0, roll_acc = 0, yaw_acc = 0;
-
-    while (running_) {
-        // Read gyro every ~100ms
-        if (l3g4200d_ok_) {
-            GyroData g = read_gyro();
-            // Simple complementary filter / integration
-            float dt = 0.1f;  // 100ms
-            pitch_acc += g.pitch * dt;
-            roll_acc  += g.roll  * dt;
-            yaw_acc   += g.yaw   * dt;
-
-            gyro_pitch_.store(pitch_acc);
-            gyro_roll_.store(roll_acc);
-            gyro_yaw_.store(yaw_acc);
-
-            // Movement detection: magnitude of angular velocity
-            float delta = std::sqrt(g.pitch * g.pitch + g.roll * g.roll + g.yaw * g.yaw);
-            gyro_delta_.store(delta);
+    if (!polling_) return;
+    poll_running_ = false;
+    poll_loop_.wake();
+    if (poll_thread_.joinable()) poll_thread_.join();
+    bus_.stop();
+    poll_loop_.deinit();
+    polling_ = false;
+}
+
+void I2CSensors::calibrate_gyro(const ImuSample* samples, int n) {
+    for (int i = 0; i < n; i++) {
+        for (int a = 0; a < 3; a++) {
+            gyro_cal_sum_[a] += samples[i].gyro[a];
+            gyro_cal_sq_[a]  += static_cast<double>(samples[i].gyro[a]) * samples[i].gyro[a];
         }
+    }
+    gyro_cal_n_ += n;
+    if (gyro_cal_n_ < GYRO_CAL_SAMPLES) return;
+
+    float mean[3];
+    float max_std = 0.0f;
+    for (int a = 0; a < 3; a++) {
+        double m = gyro_cal_sum_[a] / gyro_cal_n_;
+        double var = gyro_cal_sq_[a] / gyro_cal_n_ - m * m;
+        max_std = std::max(max_std, static_cast<float>(std::sqrt(std::max(var, 0.0))));
+        mean[a] = static_cast<float>(m);
+    }
+    int count = gyro_cal_n_;
+    gyro_cal_n_ = 0;
+    for (int a = 0; a < 3; a++) gyro_cal_sum_[a] = gyro_cal_sq_[a] = 0.0;
+    if (max_std > GYRO_CAL_MAX_STD_DPS) {
+        // Moving: keep the previous bias and start over
+        return;
+    }
+
+    for (int a = 0; a < 3; a++) gyro_bias_[a] = mean[a];
+    gyro_cal_done_ = true;
+    fprintf(stderr, "[I2C] Gyro bias %.2f/%.2f/%.2f dps from %d samples (noise %.2f dps)\n",
+            gyro_bias_[0], gyro_bias_[1], gyro_bias_[2], count, max_std);
+}
 
-        // Read light every ~500ms
-        light_counter++;
-        if (light_counter >= 5 && bh1750_ok_) {
-            light_counter = 0;
-            float lux = read_lux();
-            lux_.store(lux);
+void I2CSensors::on_gyro_fifo(const uint8_t* status) {
+    ImuSample samples[IMU_MAX_BURST];
+    bool overrun = false;
+    int n = imu_->drain(status, samples, &overrun);
+    uint64_t now = metrics_now_us();
+    uint64_t now_ns = sensor_clock_ns();
+    if (overrun) g_gyro_overruns.inc();
+    if (n <= 0) {
+        // An overrun resets the FIFO and hands back nothing; the next
+        // drain's interval starts from the reset
+        if (overrun) gyro_last_drain_us_ = now;
+        return;
+    }
+    g_gyro_samples.inc(n);
+
+    // Sample period from CLOCK_MONOTONIC: the gyro's ODR is only nominal.
+    // After an overrun the gap is unknown, so those samples are stretched
+    // over the whole interval instead of updating the estimate.
+    const float nominal = imu_->nominal_period_us();
+    float elapsed = static_cast<float>(now - gyro_last_drain_us_);
+    gyro_last_drain_us_ = now;
+    float dt_us;
+    if (overrun) {
+        dt_us = elapsed / n;
+    } else {
+        float measured = std::min(std::max(elapsed / n, nominal * 0.8f), nominal * 1.2f);
+        float period = gyro_period_us_.load();
+        period = period > 0 ? period * 0.95f + measured * 0.05f : measured;
+        gyro_period_us_.store(period);
+        dt_us = period;
+        g_gyro_rate.set(1e6 / period);
+    }
+
+    float dt = dt_us / 1e6f;
+    const bool accel = imu_->has_accel();
+    if (!gyro_cal_done_) {
+        calibrate_gyro(samples, n);
+        // Held still for calibration: gravity alone already gives the level
+        if (accel) {
+            static const float zero[3] = {};
+            for (int i = 0; i < n; i++) fusion_.update(zero, samples[i].accel, dt);
+            store_attitude();
         }
+        return;
+    }
+
+    float peak = 0.0f;
+    for (int i = 0; i < n; i++) {
+        float rate[3];
+        for (int a = 0; a < 3; a++) rate[a] = samples[i].gyro[a] - gyro_bias_[a];
+        roll_acc_  += rate[0] * dt;
+        pitch_acc_ += rate[1] * dt;
+        yaw_acc_   += rate[2] * dt;
+        peak = std::max(peak, std::sqrt(rate[0] * rate[0] + rate[1] * rate[1] + rate[2] * rate[2]));
+        fusion_.update(rate, accel ? samples[i].accel : nullptr, dt);
+
+        // The newest FIFO entry was sampled just before the drain
+        GyroSample gs;
+        gs.t_ns = now_ns - static_cast<uint64_t>((n - 1 - i) * dt_us * 1000.0f);
+        std::copy(rate, rate + 3, gs.rate);
+        gs.angle[0] = roll_acc_;
+        gs.angle[1] = pitch_acc_;
+        gs.angle[2] = yaw_acc_;
+        fusion_.attitude(&gs.attitude[0], &gs.attitude[1]);
+        gyro_ring_.push(gs);
+    }
+
+    store_attitude();
+    gyro_yaw_.store(yaw_acc_);
 
-        usleep(100000);  // 100ms
+    // Movement detection: peak angular velocity over the burst
+    gyro_delta_.store(peak);
+}
+
+void I2CSensors::store_attitude() {
+    float roll, pitch;
+    fusion_.attitude(&roll, &pitch);
+    gyro_roll_.store(roll);
+    gyro_pitch_.store(pitch);
+}
+
+void I2CSensors::on_light(const uint8_t* buf) {
+    if (metrics_now_us() >= bh1750_ready_us_) {
+        uint16_t raw = (buf[0] << 8) | buf[1];
+        float lux = raw / 1.2f;  // BH1750 conversion factor (both resolutions)
+        lux_.store(lux);
+        lux_ring_.push({bh1750_meas_ns_, lux});
+
+        if (bh1750_lores_ && lux < BH1750_HIRES_BELOW_LUX) bh1750_lores_ = false;
+        else if (!bh1750_lores_ && lux > BH1750_LORES_ABOVE_LUX) bh1750_lores_ = true;
+    }
+    start_light_measurement();
+}
+
+FrameMotion I2CSensors::motion_during(uint64_t start_ns, uint64_t duration_ns) const {
+    FrameMotion m;
+    uint64_t end_ns = start_ns + duration_ns;
+    float sum_sq = 0.0f;
+    uint64_t prev_t = 0;
+    // Windows shorter than a sample period still get the sample around them
+    const uint64_t pad_ns = static_cast<uint64_t>(GYRO_NOMINAL_PERIOD_US * 1000.0f);
+    m.samples = static_cast<int>(gyro_ring_.visit(start_ns, end_ns + pad_ns,
+        [&](const GyroSample& s) {
+            float mag = std::sqrt(s.rate[0] * s.rate[0] + s.rate[1] * s.rate[1] +
+                                  s.rate[2] * s.rate[2]);
+            m.peak_dps = std::max(m.peak_dps, mag);
+            sum_sq += mag * mag;
+            uint64_t t0 = std::max(prev_t ? prev_t : s.t_ns - pad_ns, start_ns);
+            uint64_t t1 = std::min(s.t_ns, end_ns);
+            if (t1 > t0) m.swept_deg += mag * (t1 - t0) / 1e9f;
+            prev_t = s.t_ns;
+        }));
+    if (m.samples > 0) m.rms_dps = std::sqrt(sum_sq / m.samples);
+
+    uint64_t oldest = 0, newest = 0;
+    gyro_ring_.span(&oldest, &newest);
+    m.covered = m.samples > 0 && oldest <= start_ns && newest + pad_ns >= end_ns;
+
+    GyroSample mid;
+    if (gyro_ring_.at(start_ns + duration_ns / 2, &mid)) {
+        m.roll_deg = mid.attitude[0];
+        m.pitch_deg = mid.attitude[1];
+    }
+    return m;
+}
+
+bool I2CSensors::recent_gyro(uint64_t window_ns, GyroSample* out) const {
+    if (!gyro_ring_.at(UINT64_MAX, out)) return false;
+    float sum[3] = {};
+    size_t n = gyro_ring_.visit(out->t_ns - std::min(window_ns, out->t_ns), out->t_ns,
+        [&](const GyroSample& s) {
+            for (int i = 0; i < 3; i++) sum[i] += s.rate[i];
+        });
+    if (n > 0) {
+        for (int i = 0; i < 3; i++) out->rate[i] = sum[i] / n;
     }
+    return true;
+}
+
+float I2CSensors::lux_at(uint64_t t_ns) const {
+    LuxSample s;
+    return lux_ring_.at(t_ns, &s) ? s.lux : lux_.load();
 }
 
 } // namespace cinepi
@@ -0,0 +1,286 @@
+/**
+ * CinePi Camera - Simulated I2C Bus
+ * Register behaviour follows the BH1750FVI and L3G4200D datasheets as far
+ * as I2CSensors depends on it: one-shot/continuous conversions and their
+ * timing, sub-address auto-increment, FIFO stream mode with the 0x2D ->
+ * 0x28 read rollover, and FIFO_SRC (FSS/EMPTY/OVRN).
+ */
+
+#include "drivers/i2c_sim.h"
+#include "core/metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <linux/i2c.h>
+
+namespace cinepi {
+
+// ─── SensorTrace ────────────────────────────────────────────────────
+
+bool SensorTrace::load_csv(const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "[I2CSim] Cannot open trace %s\n", path);
+        return false;
+    }
+    pts_.clear();
+    char line[256];
+    while (fgets(line, sizeof(line), f)) {
+        Point p;
+        if (line[0] == '#') continue;
+        if (sscanf(line, "%lf,%f,%f,%f,%f", &p.t_s, &p.rate[0], &p.rate[1], &p.rate[2], &p.lux) != 5)
+            continue;
+        if (!pts_.empty() && p.t_s <= pts_.back().t_s) continue;
+        pts_.push_back(p);
+    }
+    fclose(f);
+    if (pts_.size() < 2) {
+        fprintf(stderr, "[I2CSim] %s: need at least two samples\n", path);
+        return false;
+    }
+    return true;
+}
+
+SensorTrace SensorTrace::synthetic(double seconds) {
+    SensorTrace tr;
+    const double two_pi = 2.0 * M_PI;
+    for (double t = 0.0; t <= seconds; t += 0.005) {
+        Point p;
+        p.t_s = t;
+        p.rate[0] = p.rate[1] = p.rate[2] = 0.0f;
+        p.lux = 300.0f;
+        if (t >= 2.0) {
+            // Hand tremor, a few deg/s around 4-6 Hz
+            p.rate[0] = static_cast<float>(0.8 * std::sin(two_pi * 4.3 * t));
+            p.rate[1] = static_cast<float>(1.2 * std::sin(two_pi * 6.1 * t + 1.0));
+            p.rate[2] = static_cast<float>(1.5 * std::sin(two_pi * 3.7 * t + 2.0));
+            // A 30 deg/s pan, eased in and out
+            double u = (t - 5.0) / 2.0;
+            if (u > 0.0 && u < 1.0) p.rate[2] += static_cast<float>(30.0 * std::sin(M_PI * u));
+        }
+        if (t >= 4.0 && t < 8.0) p.lux = 20.0f;       // indoors, dim
+        if (t >= 8.0) p.lux = 5000.0f;                // outside
+        tr.pts_.push_back(p);
+    }
+    return tr;
+}
+
+void SensorTrace::sample(double t_s, float rate[3], float* lux) const {
+    if (pts_.empty()) {
+        rate[0] = rate[1] = rate[2] = 0.0f;
+        *lux = 0.0f;
+        return;
+    }
+    double span = duration();
+    if (span > 0.0) t_s = std::fmod(std::max(t_s, 0.0), span);
+    auto it = std::upper_bound(pts_.begin(), pts_.end(), t_s,
+                               [](double t, const Point& p) { return t < p.t_s; });
+    if (it == pts_.begin() || it == pts_.end()) {
+        const Point& p = it == pts_.end() ? pts_.back() : pts_.front();
+        for (int a = 0; a < 3; a++) rate[a] = p.rate[a];
+        *lux = p.lux;
+        return;
+    }
+    const Point& b = *it;
+    const Point& a = *(it - 1);
+    float w = static_cast<float>((t_s - a.t_s) / (b.t_s - a.t_s));
+    for (int i = 0; i < 3; i++) rate[i] = a.rate[i] + (b.rate[i] - a.rate[i]) * w;
+    *lux = a.lux + (b.lux - a.lux) * w;
+}
+
+// ─── BH1750 ─────────────────────────────────────────────────────────
+
+static constexpr uint64_t BH_HIRES_US = 120000;   // typical conversion times
+static constexpr uint64_t BH_LORES_US = 16000;
+
+SimBH1750::SimBH1750(uint8_t addr, const SensorTrace& trace, uint64_t t0_us)
+    : SimDevice(addr), trace_(trace), t0_us_(t0_us) {}
+
+void SimBH1750::update(uint64_t now_us) {
+    uint64_t conv = lores_ ? BH_LORES_US : BH_HIRES_US;
+    while (measuring_ && now_us >= meas_start_us_ + conv) {
+        float rate[3], lux;
+        trace_.sample((meas_start_us_ + conv / 2 - t0_us_) / 1e6, rate, &lux);
+        if (lores_) lux = std::floor(lux / 4.0f) * 4.0f;   // 4 lx resolution
+        result_ = static_cast<uint16_t>(std::min(lux * 1.2f, 65535.0f));
+        if (continuous_) {
+            meas_start_us_ += conv;
+        } else {
+            measuring_ = false;
+            powered_ = false;   // one-time modes power down after the result
+        }
+    }
+}
+
+bool SimBH1750::write(const uint8_t* data, int len, uint64_t now_us) {
+    if (len != 1) return false;
+    update(now_us);
+    uint8_t op = data[0];
+    switch (op) {
+    case 0x00: powered_ = false; measuring_ = false; break;
+    case 0x01: powered_ = true; break;
+    case 0x07: if (powered_) result_ = 0; break;
+    case 0x10: case 0x11: case 0x13:
+    case 0x20: case 0x21: case 0x23:
+        powered_ = measuring_ = true;
+        continuous_ = op < 0x20;
+        lores_ = (op & 0x03) == 0x03;
+        meas_start_us_ = now_us;
+        break;
+    default:
+        break;   // measurement time register: accepted, not modelled
+    }
+    return true;
+}
+
+bool SimBH1750::read(uint8_t* buf, int len, uint64_t now_us) {
+    update(now_us);
+    for (int i = 0; i < len; i++) buf[i] = 0xFF;
+    if (len > 0) buf[0] = static_cast<uint8_t>(result_ >> 8);
+    if (len > 1) buf[1] = static_cast<uint8_t>(result_ & 0xFF);
+    return true;
+}
+
+// ─── L3G4200D ───────────────────────────────────────────────────────
+
+static constexpr uint8_t L3G_WHO_AM_I = 0x0F, L3G_CTRL_REG1 = 0x20, L3G_CTRL_REG4 = 0x23;
+static constexpr uint8_t L3G_CTRL_REG5 = 0x24, L3G_OUT_X_L = 0x28, L3G_OUT_Z_H = 0x2D;
+static constexpr uint8_t L3G_FIFO_CTRL = 0x2E, L3G_FIFO_SRC = 0x2F;
+static constexpr int     L3G_FIFO_DEPTH = 32;
+
+SimL3G4200D::SimL3G4200D(uint8_t addr, const SensorTrace& trace, uint64_t t0_us,
+                         float odr_error, float bias_dps, float noise_dps)
+    : SimDevice(addr), trace_(trace), t0_us_(t0_us), odr_error_(odr_error),
+      bias_dps_(bias_dps), noise_(0.0f, noise_dps) {
+    regs_[L3G_WHO_AM_I] = 0xD3;
+    regs_[L3G_CTRL_REG1] = 0x07;   // power-down, axes enabled
+}
+
+bool SimL3G4200D::fifo_enabled() const {
+    return (regs_[L3G_CTRL_REG5] & 0x40) && (regs_[L3G_FIFO_CTRL] >> 5) != 0;
+}
+
+void SimL3G4200D::update(uint64_t now_us) {
+    uint8_t r1 = regs_[L3G_CTRL_REG1];
+    static const float odr_hz[4] = {100.0f, 200.0f, 400.0f, 800.0f};
+    uint64_t period = static_cast<uint64_t>(1e6f / (odr_hz[r1 >> 6] * (1.0f + odr_error_)));
+    if (!(r1 & 0x08)) {          // PD: powered down
+        next_sample_us_ = now_us + period;
+        return;
+    }
+    static const float sens[4] = {8.75e-3f, 17.5e-3f, 70e-3f, 70e-3f};
+    float dps_per_lsb = sens[(regs_[L3G_CTRL_REG4] >> 4) & 3];
+    int mode = regs_[L3G_FIFO_CTRL] >> 5;
+
+    for (; next_sample_us_ <= now_us; next_sample_us_ += period) {
+        float rate[3], lux;
+        trace_.sample((next_sample_us_ - t0_us_) / 1e6, rate, &lux);
+        for (int a = 0; a < 3; a++) {
+            float v = (rate[a] + bias_dps_ + noise_(rng_)) / dps_per_lsb;
+            latest_[a] = static_cast<int16_t>(std::lround(std::clamp(v, -32768.0f, 32767.0f)));
+        }
+        generated_++;
+        if (!fifo_enabled()) continue;
+        if (fifo_count_ == L3G_FIFO_DEPTH) {
+            if (mode == 1) continue;                            // FIFO mode: stop when full
+            fifo_head_ = (fifo_head_ + 1) % L3G_FIFO_DEPTH;     // stream: drop the oldest
+            fifo_count_--;
+            overwritten_++;
+        }
+        int slot = (fifo_head_ + fifo_count_) % L3G_FIFO_DEPTH;
+        std::copy(latest_, latest_ + 3, fifo_[slot]);
+        fifo_count_++;
+        if (fifo_count_ == L3G_FIFO_DEPTH) overrun_ = true;
+    }
+}
+
+uint8_t SimL3G4200D::reg(uint8_t r) const {
+    if (r >= L3G_OUT_X_L && r <= L3G_OUT_Z_H) {
+        const int16_t* s = fifo_enabled() && fifo_count_ > 0 ? fifo_[fifo_head_] : latest_;
+        uint16_t v = static_cast<uint16_t>(s[(r - L3G_OUT_X_L) / 2]);
+        return (r & 1) ? static_cast<uint8_t>(v >> 8) : static_cast<uint8_t>(v & 0xFF);
+    }
+    if (r == L3G_FIFO_SRC) {
+        uint8_t src = static_cast<uint8_t>(std::min(fifo_count_, L3G_FIFO_DEPTH - 1));
+        if (fifo_count_ == 0) src |= 0x20;
+        if (overrun_) src |= 0x40;
+        return src;
+    }
+    return regs_[r & 0x3F];
+}
+
+bool SimL3G4200D::write(const uint8_t* data, int len, uint64_t now_us) {
+    if (len < 1) return false;
+    update(now_us);
+    ptr_ = data[0] & 0x7F;
+    auto_inc_ = data[0] & 0x80;
+    for (int i = 1; i < len; i++) {
+        bool writable = (ptr_ >= L3G_CTRL_REG1 && ptr_ <= 0x25) || ptr_ == L3G_FIFO_CTRL ||
+                        (ptr_ >= 0x30 && ptr_ <= 0x38);
+        if (!writable) return false;
+        regs_[ptr_] = data[i];
+        if (ptr_ == L3G_FIFO_CTRL && (data[i] >> 5) == 0) {
+            fifo_count_ = 0;   // bypass mode resets the FIFO
+            overrun_ = false;
+        }
+        if (auto_inc_) ptr_ = (ptr_ + 1) & 0x3F;
+    }
+    return true;
+}
+
+bool SimL3G4200D::read(uint8_t* buf, int len, uint64_t now_us) {
+    update(now_us);
+    for (int i = 0; i < len; i++) {
+        buf[i] = reg(ptr_);
+        bool rollover = fifo_enabled() && ptr_ == L3G_OUT_Z_H;
+        if (rollover && fifo_count_ > 0) {
+            fifo_head_ = (fifo_head_ + 1) % L3G_FIFO_DEPTH;
+            fifo_count_--;
+            overrun_ = false;
+        }
+        if (auto_inc_) ptr_ = rollover ? L3G_OUT_X_L : (ptr_ + 1) & 0x3F;
+    }
+    return true;
+}
+
+// ─── Bus ────────────────────────────────────────────────────────────
+
+SimDevice* SimI2CBus::add(std::unique_ptr<SimDevice> dev) {
+    devices_.push_back(std::move(dev));
+    return devices_.back().get();
+}
+
+SimDevice* SimI2CBus::find(uint16_t addr) const {
+    for (const auto& d : devices_) {
+        if (d->addr() == addr) return d.get();
+    }
+    return nullptr;
+}
+
+bool SimI2CBus::transfer(i2c_msg* msgs, int n) {
+    uint64_t now = metrics_now_us();
+    transfers_++;
+    SimDevice* last = nullptr;
+    for (int i = 0; i < n; i++) {
+        wire_bits_ += 1 + 9 + 9ULL * msgs[i].len;   // (repeated) start, address, data
+        SimDevice* dev = find(msgs[i].addr);
+        if (!dev) {
+            nacks_++;
+            return false;
+        }
+        if (dev != last) dev->access_us.push_back(now);
+        last = dev;
+        bytes_ += msgs[i].len;
+        bool ok = (msgs[i].flags & I2C_M_RD) ? dev->read(msgs[i].buf, msgs[i].len, now)
+                                             : dev->write(msgs[i].buf, msgs[i].len, now);
+        if (!ok) {
+            nacks_++;
+            return false;
+        }
+    }
+    wire_bits_ += 1;   // stop
+    return true;
+}
+
+} // namespace cinepi
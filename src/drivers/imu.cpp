@@ -0,0 +1,264 @@
+/**
+ * CinePi Camera - IMU Drivers
+ * All three FIFOs are read with one burst from a non-incrementing (or
+ * rolling-over) data register.  A drain never reads more than
+ * IMU_MAX_BURST samples; anything beyond that is flushed and reported as
+ * an overrun, so sample timestamps stay anchored to the drain time.
+ */
+
+#include "drivers/imu.h"
+#include "drivers/i2c_bus.h"
+#include "core/constants.h"
+
+#include <algorithm>
+
+namespace cinepi {
+
+// ─── L3G4200D ──────────────────────────────────────────────────────
+static constexpr uint8_t L3G_WHO_AM_I          = 0x0F;
+static constexpr uint8_t L3G_ID                = 0xD3;
+static constexpr uint8_t L3G_CTRL_REG1         = 0x20;
+static constexpr uint8_t L3G_CTRL_REG4         = 0x23;
+static constexpr uint8_t L3G_CTRL_REG5         = 0x24;
+static constexpr uint8_t L3G_OUT_X_L           = 0x28;
+static constexpr uint8_t L3G_FIFO_CTRL         = 0x2E;
+static constexpr uint8_t L3G_FIFO_SRC          = 0x2F;
+static constexpr uint8_t L3G_AUTO_INC          = 0x80;  // register address MSB
+static constexpr uint8_t L3G_ODR_200HZ         = 0x4F;  // CTRL_REG1: DR=01, BW=00, PD, XYZ
+static constexpr uint8_t L3G_FIFO_EN           = 0x40;  // CTRL_REG5
+static constexpr uint8_t L3G_FIFO_STREAM       = 0x40;  // FIFO_CTRL FM=010
+static constexpr uint8_t L3G_FIFO_OVRN         = 0x40;  // FIFO_SRC
+static constexpr uint8_t L3G_FIFO_EMPTY        = 0x20;
+static constexpr uint8_t L3G_FIFO_FSS          = 0x1F;
+static constexpr int     L3G_FIFO_DEPTH        = 32;    // 160 ms at 200 Hz, > GYRO_READ_MS
+static constexpr float   L3G_SENSITIVITY_250   = 8.75f / 1000.0f;  // deg/s per digit at 250dps
+
+// ─── MPU-6050 ──────────────────────────────────────────────────────
+static constexpr uint8_t MPU_SMPLRT_DIV        = 0x19;
+static constexpr uint8_t MPU_CONFIG            = 0x1A;
+static constexpr uint8_t MPU_GYRO_CONFIG       = 0x1B;
+static constexpr uint8_t MPU_ACCEL_CONFIG      = 0x1C;
+static constexpr uint8_t MPU_FIFO_EN           = 0x23;
+static constexpr uint8_t MPU_USER_CTRL         = 0x6A;
+static constexpr uint8_t MPU_PWR_MGMT_1        = 0x6B;
+static constexpr uint8_t MPU_FIFO_COUNTH       = 0x72;
+static constexpr uint8_t MPU_FIFO_R_W          = 0x74;
+static constexpr uint8_t MPU_WHO_AM_I          = 0x75;
+static constexpr uint8_t MPU_ID                = 0x68;
+static constexpr uint8_t MPU_CLK_PLL_XGYRO     = 0x01;  // PWR_MGMT_1: awake, gyro clock
+static constexpr uint8_t MPU_DLPF_44HZ         = 0x03;  // CONFIG: 1 kHz internal rate
+static constexpr uint8_t MPU_DIV_200HZ         = 4;     // 1 kHz / (1 + 4)
+static constexpr uint8_t MPU_FIFO_ACCEL_GYRO   = 0x78;  // FIFO_EN: XG, YG, ZG, ACCEL
+static constexpr uint8_t MPU_USER_FIFO_EN      = 0x40;
+static constexpr uint8_t MPU_USER_FIFO_RESET   = 0x04;
+static constexpr int     MPU_FIFO_BYTES        = 1024;
+static constexpr int     MPU_FRAME             = 12;    // accel xyz, gyro xyz, big-endian
+static constexpr float   MPU_GYRO_250          = 1.0f / 131.0f;    // deg/s per digit
+static constexpr float   MPU_ACCEL_2G          = 1.0f / 16384.0f;  // g per digit
+
+// ─── LSM6DS3 ───────────────────────────────────────────────────────
+static constexpr uint8_t LSM_FIFO_CTRL3        = 0x08;
+static constexpr uint8_t LSM_FIFO_CTRL5        = 0x0A;
+static constexpr uint8_t LSM_WHO_AM_I          = 0x0F;
+static constexpr uint8_t LSM_ID                = 0x69;
+static constexpr uint8_t LSM_CTRL1_XL          = 0x10;
+static constexpr uint8_t LSM_CTRL2_G           = 0x11;
+static constexpr uint8_t LSM_CTRL3_C           = 0x12;
+static constexpr uint8_t LSM_FIFO_STATUS1      = 0x3A;
+static constexpr uint8_t LSM_FIFO_DATA_OUT_L   = 0x3E;
+static constexpr uint8_t LSM_ODR_208HZ         = 0x50;  // CTRL1_XL ±2 g / CTRL2_G 245 dps
+static constexpr uint8_t LSM_BDU_IF_INC        = 0x44;  // CTRL3_C
+static constexpr uint8_t LSM_FIFO_NO_DECIM     = 0x09;  // FIFO_CTRL3: gyro and accel, every sample
+static constexpr uint8_t LSM_FIFO_BYPASS       = 0x00;  // FIFO_CTRL5 (also empties it)
+static constexpr uint8_t LSM_FIFO_CONT_208HZ   = 0x2E;  // ODR_FIFO=0101, continuous mode
+static constexpr uint8_t LSM_FIFO_OVER_RUN     = 0x40;  // FIFO_STATUS2
+static constexpr uint8_t LSM_FIFO_EMPTY        = 0x10;
+static constexpr int     LSM_PATTERN           = 6;     // words per sample: G xyz, XL xyz
+static constexpr float   LSM_GYRO_245          = 8.75f / 1000.0f;   // deg/s per digit
+static constexpr float   LSM_ACCEL_2G          = 0.061f / 1000.0f;  // g per digit
+
+static inline int16_t le16(const uint8_t* p) { return static_cast<int16_t>(p[1] << 8 | p[0]); }
+static inline int16_t be16(const uint8_t* p) { return static_cast<int16_t>(p[0] << 8 | p[1]); }
+
+class L3G4200D : public ImuDriver {
+public:
+    L3G4200D(I2CBus& bus, int dev) : ImuDriver(bus, dev) {}
+    const char* name() const override { return "L3G4200D"; }
+    bool  has_accel() const override { return false; }
+    float nominal_period_us() const override { return 5000.0f; }
+    uint8_t  status_reg() const override { return L3G_FIFO_SRC; }
+    uint16_t status_len() const override { return 1; }
+
+    bool init() override {
+        uint8_t who = 0;
+        if (!bus_.read(dev_, L3G_WHO_AM_I, &who, 1) || who != L3G_ID) return false;
+        // Normal mode, all axes, 200 Hz ODR, 250 dps full scale
+        bus_.write_reg(dev_, L3G_CTRL_REG1, L3G_ODR_200HZ);
+        bus_.write_reg(dev_, L3G_CTRL_REG4, 0x00);
+        // 32-sample FIFO in stream mode: drained in one burst per poll
+        bus_.write_reg(dev_, L3G_CTRL_REG5, L3G_FIFO_EN);
+        return bus_.write_reg(dev_, L3G_FIFO_CTRL, L3G_FIFO_STREAM);
+    }
+
+    int drain(const uint8_t* status, ImuSample* out, bool* overrun) override {
+        uint8_t src = status[0];
+        *overrun = src & L3G_FIFO_OVRN;
+        if (src & L3G_FIFO_EMPTY) return 0;
+        // FSS counts 0..31; a full FIFO reports overrun instead of 32
+        int n = *overrun ? L3G_FIFO_DEPTH : (src & L3G_FIFO_FSS);
+        if (n == 0) return 0;
+
+        // With the FIFO enabled the auto-increment address wraps from OUT_Z_H
+        // back to OUT_X_L, so n samples are one n*6 byte read.
+        uint8_t buf[L3G_FIFO_DEPTH * 6];
+        if (!bus_.read(dev_, L3G_OUT_X_L | L3G_AUTO_INC, buf, n * 6)) return -1;
+        for (int i = 0; i < n; i++) {
+            for (int a = 0; a < 3; a++) {
+                out[i].gyro[a] = le16(buf + i * 6 + a * 2) * L3G_SENSITIVITY_250;
+                out[i].accel[a] = 0.0f;
+            }
+        }
+        return n;
+    }
+};
+
+class MPU6050 : public ImuDriver {
+public:
+    MPU6050(I2CBus& bus, int dev) : ImuDriver(bus, dev) {}
+    const char* name() const override { return "MPU-6050"; }
+    bool  has_accel() const override { return true; }
+    float nominal_period_us() const override { return 5000.0f; }
+    uint8_t  status_reg() const override { return MPU_FIFO_COUNTH; }
+    uint16_t status_len() const override { return 2; }
+
+    bool init() override {
+        uint8_t who = 0;
+        if (!bus_.read(dev_, MPU_WHO_AM_I, &who, 1) || who != MPU_ID) return false;
+        bus_.write_reg(dev_, MPU_PWR_MGMT_1, MPU_CLK_PLL_XGYRO);
+        bus_.write_reg(dev_, MPU_CONFIG, MPU_DLPF_44HZ);
+        bus_.write_reg(dev_, MPU_SMPLRT_DIV, MPU_DIV_200HZ);
+        bus_.write_reg(dev_, MPU_GYRO_CONFIG, 0x00);    // ±250 dps
+        bus_.write_reg(dev_, MPU_ACCEL_CONFIG, 0x00);   // ±2 g
+        bus_.write_reg(dev_, MPU_FIFO_EN, MPU_FIFO_ACCEL_GYRO);
+        return reset_fifo();
+    }
+
+    int drain(const uint8_t* status, ImuSample* out, bool* overrun) override {
+        int count = (status[0] << 8) | status[1];
+        // The FIFO is not a whole number of frames, so once it has filled
+        // up the frame boundary is lost: start again from empty.
+        *overrun = count > MPU_FIFO_BYTES - MPU_FRAME;
+        if (*overrun) {
+            reset_fifo();
+            return 0;
+        }
+        int n = std::min(count / MPU_FRAME, IMU_MAX_BURST);
+        if (n == 0) return 0;
+
+        // FIFO_R_W does not auto-increment: one burst reads n frames
+        uint8_t buf[IMU_MAX_BURST * MPU_FRAME];
+        if (!bus_.read(dev_, MPU_FIFO_R_W, buf, n * MPU_FRAME)) return -1;
+        for (int i = 0; i < n; i++) {
+            const uint8_t* p = buf + i * MPU_FRAME;
+            for (int a = 0; a < 3; a++) {
+                out[i].accel[a] = be16(p + a * 2) * MPU_ACCEL_2G;
+                out[i].gyro[a]  = be16(p + 6 + a * 2) * MPU_GYRO_250;
+            }
+        }
+        if (count / MPU_FRAME > n) {
+            *overrun = true;
+            reset_fifo();
+        }
+        return n;
+    }
+
+private:
+    bool reset_fifo() {
+        bus_.write_reg(dev_, MPU_USER_CTRL, MPU_USER_FIFO_RESET);
+        return bus_.write_reg(dev_, MPU_USER_CTRL, MPU_USER_FIFO_EN);
+    }
+};
+
+class LSM6DS3 : public ImuDriver {
+public:
+    LSM6DS3(I2CBus& bus, int dev) : ImuDriver(bus, dev) {}
+    const char* name() const override { return "LSM6DS3"; }
+    bool  has_accel() const override { return true; }
+    float nominal_period_us() const override { return 1e6f / 208.0f; }
+    // FIFO_STATUS1..4: unread words, flags, pattern position
+    uint8_t  status_reg() const override { return LSM_FIFO_STATUS1; }
+    uint16_t status_len() const override { return 4; }
+
+    bool init() override {
+        uint8_t who = 0;
+        if (!bus_.read(dev_, LSM_WHO_AM_I, &who, 1) || who != LSM_ID) return false;
+        bus_.write_reg(dev_, LSM_CTRL3_C, LSM_BDU_IF_INC);
+        bus_.write_reg(dev_, LSM_CTRL1_XL, LSM_ODR_208HZ);
+        bus_.write_reg(dev_, LSM_CTRL2_G, LSM_ODR_208HZ);
+        bus_.write_reg(dev_, LSM_FIFO_CTRL3, LSM_FIFO_NO_DECIM);
+        return restart_fifo();
+    }
+
+    int drain(const uint8_t* status, ImuSample* out, bool* overrun) override {
+        int words = status[0] | ((status[1] & 0x0F) << 8);
+        int pattern = status[2] | ((status[3] & 0x03) << 8);
+        *overrun = status[1] & LSM_FIFO_OVER_RUN;
+        if (status[1] & LSM_FIFO_EMPTY) return 0;
+
+        // Whole samples only, starting at the next gyro X word
+        int skip = (LSM_PATTERN - pattern % LSM_PATTERN) % LSM_PATTERN;
+        int queued = words > skip ? (words - skip) / LSM_PATTERN : 0;
+        int n = std::min(queued, IMU_MAX_BURST);
+        if (n == 0) return 0;
+
+        // FIFO_DATA_OUT_H rolls over to _L, so this is one burst too
+        uint8_t buf[(IMU_MAX_BURST + 1) * LSM_PATTERN * 2];
+        if (!bus_.read(dev_, LSM_FIFO_DATA_OUT_L, buf, (skip + n * LSM_PATTERN) * 2)) return -1;
+        for (int i = 0; i < n; i++) {
+            const uint8_t* p = buf + (skip + i * LSM_PATTERN) * 2;
+            for (int a = 0; a < 3; a++) {
+                out[i].gyro[a]  = le16(p + a * 2) * LSM_GYRO_245;
+                out[i].accel[a] = le16(p + 6 + a * 2) * LSM_ACCEL_2G;
+            }
+        }
+        if (queued > n) {
+            *overrun = true;
+            restart_fifo();
+        }
+        return n;
+    }
+
+private:
+    bool restart_fifo() {
+        bus_.write_reg(dev_, LSM_FIFO_CTRL5, LSM_FIFO_BYPASS);
+        return bus_.write_reg(dev_, LSM_FIFO_CTRL5, LSM_FIFO_CONT_208HZ);
+    }
+};
+
+template <typename T>
+static std::unique_ptr<ImuDriver> make_imu(I2CBus& bus, int dev) {
+    return std::make_unique<T>(bus, dev);
+}
+
+std::unique_ptr<ImuDriver> ImuDriver::probe(I2CBus& bus) {
+    // The L3G4200D and a MPU-6050 with AD0 high share 0x69; WHO_AM_I
+    // tells them apart.
+    static const struct {
+        const char* dev;
+        uint8_t     addr;
+        std::unique_ptr<ImuDriver> (*make)(I2CBus&, int);
+    } parts[] = {
+        {"l3g4200d", I2C_ADDR_GYRO,         make_imu<L3G4200D>},
+        {"lsm6ds3",  I2C_ADDR_LSM6DS3,      make_imu<LSM6DS3>},
+        {"lsm6ds3",  I2C_ADDR_LSM6DS3 + 1,  make_imu<LSM6DS3>},
+        {"mpu6050",  I2C_ADDR_MPU6050,      make_imu<MPU6050>},
+        {"mpu6050",  I2C_ADDR_MPU6050 + 1,  make_imu<MPU6050>},
+    };
+    for (const auto& p : parts) {
+        std::unique_ptr<ImuDriver> imu = p.make(bus, bus.add_device(p.dev, p.addr));
+        if (imu->init()) return imu;
+    }
+    return nullptr;
+}
+
+} // namespace cinepi
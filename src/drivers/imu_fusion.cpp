@@ -0,0 +1,99 @@
+/**
+ * CinePi Camera - IMU Fusion
+ * Scalar float throughout: the A53 has hardware single precision, and one
+ * step is ~60 flops plus a square root, i.e. negligible at 200 Hz.
+ * Trigonometry only runs for the initial alignment and attitude().
+ */
+
+#include "drivers/imu_fusion.h"
+
+#include <cmath>
+
+namespace cinepi {
+
+static constexpr float DEG2RAD = 3.14159265f / 180.0f;
+static constexpr float RAD2DEG = 180.0f / 3.14159265f;
+
+// ~1 s to pull in a tilt error: the level follows the gyro at once and
+// settles on gravity without showing hand shake or walking bounce.
+static constexpr float FUSION_KP          = 1.0f;
+static constexpr float FUSION_KI          = 0.02f;
+static constexpr float FUSION_BIAS_MAX    = 2.0f * DEG2RAD;   // rad/s, integral clamp
+// Accelerometer readings further than this from 1 g carry linear
+// acceleration, not just gravity, and are ignored.
+static constexpr float FUSION_GRAVITY_TOL = 0.15f;
+
+void ImuFusion::reset() {
+    q_[0] = 1.0f;
+    q_[1] = q_[2] = q_[3] = 0.0f;
+    bias_[0] = bias_[1] = bias_[2] = 0.0f;
+    aligned_ = false;
+}
+
+// Start from the accelerometer's roll/pitch instead of converging from level
+void ImuFusion::align(const float a[3]) {
+    float roll = std::atan2(a[1], a[2]);
+    float pitch = std::atan2(-a[0], std::sqrt(a[1] * a[1] + a[2] * a[2]));
+    float cr = std::cos(roll * 0.5f), sr = std::sin(roll * 0.5f);
+    float cp = std::cos(pitch * 0.5f), sp = std::sin(pitch * 0.5f);
+    q_[0] = cr * cp;
+    q_[1] = sr * cp;
+    q_[2] = cr * sp;
+    q_[3] = -sr * sp;
+    aligned_ = true;
+}
+
+void ImuFusion::update(const float gyro_dps[3], const float* accel_g, float dt) {
+    float gx = gyro_dps[0] * DEG2RAD;
+    float gy = gyro_dps[1] * DEG2RAD;
+    float gz = gyro_dps[2] * DEG2RAD;
+    float q0 = q_[0], q1 = q_[1], q2 = q_[2], q3 = q_[3];
+
+    if (accel_g) {
+        float ax = accel_g[0], ay = accel_g[1], az = accel_g[2];
+        float norm2 = ax * ax + ay * ay + az * az;
+        float lo = 1.0f - FUSION_GRAVITY_TOL, hi = 1.0f + FUSION_GRAVITY_TOL;
+        if (norm2 > lo * lo && norm2 < hi * hi) {
+            if (!aligned_) {
+                align(accel_g);
+                return;
+            }
+            float inv = 1.0f / std::sqrt(norm2);
+            ax *= inv;
+            ay *= inv;
+            az *= inv;
+            // Gravity as the current estimate expects to see it
+            float vx = 2.0f * (q1 * q3 - q0 * q2);
+            float vy = 2.0f * (q0 * q1 + q2 * q3);
+            float vz = q0 * q0 - q1 * q1 - q2 * q2 + q3 * q3;
+            // Rotation that takes it onto the measurement (small-angle)
+            float ex = ay * vz - az * vy;
+            float ey = az * vx - ax * vz;
+            float ez = ax * vy - ay * vx;
+            bias_[0] = std::fmax(-FUSION_BIAS_MAX, std::fmin(FUSION_BIAS_MAX, bias_[0] + FUSION_KI * ex * dt));
+            bias_[1] = std::fmax(-FUSION_BIAS_MAX, std::fmin(FUSION_BIAS_MAX, bias_[1] + FUSION_KI * ey * dt));
+            bias_[2] = std::fmax(-FUSION_BIAS_MAX, std::fmin(FUSION_BIAS_MAX, bias_[2] + FUSION_KI * ez * dt));
+            gx += FUSION_KP * ex + bias_[0];
+            gy += FUSION_KP * ey + bias_[1];
+            gz += FUSION_KP * ez + bias_[2];
+        }
+    }
+
+    // q += 0.5 * q ⊗ (0, ω) * dt, renormalised
+    float h = 0.5f * dt;
+    q_[0] = q0 + (-q1 * gx - q2 * gy - q3 * gz) * h;
+    q_[1] = q1 + ( q0 * gx + q2 * gz - q3 * gy) * h;
+    q_[2] = q2 + ( q0 * gy - q1 * gz + q3 * gx) * h;
+    q_[3] = q3 + ( q0 * gz + q1 * gy - q2 * gx) * h;
+    float inv = 1.0f / std::sqrt(q_[0] * q_[0] + q_[1] * q_[1] + q_[2] * q_[2] + q_[3] * q_[3]);
+    for (float& c : q_) c *= inv;
+}
+
+void ImuFusion::attitude(float* roll_deg, float* pitch_deg) const {
+    float q0 = q_[0], q1 = q_[1], q2 = q_[2], q3 = q_[3];
+    *roll_deg = std::atan2(2.0f * (q0 * q1 + q2 * q3), 1.0f - 2.0f * (q1 * q1 + q2 * q2)) * RAD2DEG;
+    float s = 2.0f * (q0 * q2 - q1 * q3);
+    *pitch_deg = std::asin(std::fmax(-1.0f, std::fmin(1.0f, s))) * RAD2DEG;
+}
+
+} // namespace cinepi
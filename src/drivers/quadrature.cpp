@@ -0,0 +1,75 @@
+/**
+ * CinePi Camera - Quadrature Decoder
+ */
+
+#include "drivers/quadrature.h"
+#include "core/constants.h"
+
+#include <algorithm>
+
+namespace cinepi {
+
+static constexpr int8_t QUAD_INVALID = 2;
+
+// [prev << 2 | cur], state = (a << 1) | b.  a closing first is +1:
+// 00 -> 10 -> 11 -> 01 -> 00
+static constexpr int8_t kQuadTable[16] = {
+     0, -1, +1, QUAD_INVALID,
+    +1,  0, QUAD_INVALID, -1,
+    -1, QUAD_INVALID,  0, +1,
+    QUAD_INVALID, +1, -1,  0,
+};
+
+// Detents further apart than this, or a reversal, restart the rate estimate
+static constexpr uint64_t ENCODER_ACCEL_RESET_NS = 300000000ULL;
+
+void QuadratureDecoder::reset(bool a, bool b) {
+    state_ = static_cast<uint8_t>((a << 1) | b);
+    quarters_ = 0;
+    last_dir_ = 0;
+    rate_hz_ = 0.0f;
+    carry_ = 0.0f;
+}
+
+int QuadratureDecoder::update(bool a, bool b, uint64_t t_ns) {
+    uint8_t cur = static_cast<uint8_t>((a << 1) | b);
+    // An edge that leaves the state as it was is a duplicate: its
+    // opposite edge was lost
+    int8_t q = cur == state_ ? QUAD_INVALID : kQuadTable[(state_ << 2) | cur];
+    state_ = cur;
+    if (q == QUAD_INVALID) {
+        invalid_++;
+        return 0;
+    }
+    quarters_ += q;
+    if (cur != 0) return 0;
+
+    // At rest: half a cycle or more of net travel is one detent
+    int dir = quarters_ >= 2 ? 1 : quarters_ <= -2 ? -1 : 0;
+    quarters_ = 0;
+    if (dir == 0) return 0;
+    detents_++;
+    return steps_for_detent(dir, t_ns);
+}
+
+int QuadratureDecoder::steps_for_detent(int dir, uint64_t t_ns) {
+    uint64_t interval = t_ns - last_detent_ns_;
+    if (dir != last_dir_ || last_detent_ns_ == 0 || interval > ENCODER_ACCEL_RESET_NS) {
+        rate_hz_ = 0.0f;
+        carry_ = 0.0f;
+    } else if (interval > 0) {
+        float inst = 1e9f / static_cast<float>(interval);
+        rate_hz_ = rate_hz_ > 0.0f ? rate_hz_ * 0.6f + inst * 0.4f : inst;
+    }
+    last_dir_ = dir;
+    last_detent_ns_ = t_ns;
+
+    float speed = (rate_hz_ - ENCODER_ACCEL_MIN_HZ) / (ENCODER_ACCEL_MAX_HZ - ENCODER_ACCEL_MIN_HZ);
+    float mult = 1.0f + (ENCODER_ACCEL_MAX_STEPS - 1) * std::min(std::max(speed, 0.0f), 1.0f);
+    carry_ += mult;
+    int steps = static_cast<int>(carry_);
+    carry_ -= steps;
+    return dir * steps;
+}
+
+} // namespace cinepi
@@ -97,15 +97,11 @@ bool TouchInput::init() {
 
     query_abs_ranges();
 
-    running_ = true;
-    thread_ = std::thread(&TouchInput::reader_thread, this);
     fprintf(stderr, "[Touch] Initialized on %s\n", dev.c_str());
     return true;
 }
 
 void TouchInput::deinit() {
-    running_ = false;
-    if (thread_.joinable()) thread_.join();
     if (fd_ >= 0) {
         ioctl(fd_, EVIOCGRAB, 0);
         close(fd_);
@@ -180,36 +176,38 @@ uint64_t TouchInput::last_activity_ms() const {
     return last_activity_.load();
 }
 
-void TouchInput::reader_thread() {
-    struct input_event ev;
-    int cur_x = 0, cur_y = 0;
-    bool touching = false;
-
-    while (running_) {
-        ssize_t n = ::read(fd_, &ev, sizeof(ev));
-        if (n < (ssize_t)sizeof(ev)) {
-            usleep(5000);
-            continue;
-        }
+bool TouchInput::process_events() {
+    if (fd_ < 0) return false;
 
-        if (ev.type == EV_ABS) {
-            if (ev.code == ABS_MT_POSITION_X || ev.code == ABS_X) {
-                cur_x = ev.value;
-                raw_x_.store(cur_x, std::memory_order_release);
-            } else if (ev.code == ABS_MT_POSITION_Y || ev.code == ABS_Y) {
-                cur_y = ev.value;
-                raw_y_.store(cur_y, std::memory_order_release);
-            } else if (ev.code == ABS_MT_TRACKING_ID) {
-                touching = (ev.value >= 0);
-                pressed_.store(touching);
+    // Batch-read: one syscall per wakeup instead of one per input_event.
+    struct input_event evs[32];
+    bool activity = false;
+
+    for (;;) {
+        ssize_t n = ::read(fd_, evs, sizeof(evs));
+        if (n < (ssize_t)sizeof(evs[0])) break;   // EAGAIN or short read
+
+        int count = static_cast<int>(n / sizeof(evs[0]));
+        for (int i = 0; i < count; i++) {
+            const input_event& ev = evs[i];
+            if (ev.type == EV_ABS) {
+                if (ev.code == ABS_MT_POSITION_X || ev.code == ABS_X) {
+                    raw_x_.store(ev.value, std::memory_order_release);
+                } else if (ev.code == ABS_MT_POSITION_Y || ev.code == ABS_Y) {
+                    raw_y_.store(ev.value, std::memory_order_release);
+                } else if (ev.code == ABS_MT_TRACKING_ID) {
+                    pressed_.store(ev.value >= 0);
+                }
+                activity = true;
+            } else if (ev.type == EV_KEY && ev.code == BTN_TOUCH) {
+                pressed_.store(ev.value > 0);
+                activity = true;
             }
-            last_activity_.store(now_ms());
-        } else if (ev.type == EV_KEY && ev.code == BTN_TOUCH) {
-            touching = (ev.value > 0);
-            pressed_.store(touching);
-            last_activity_.store(now_ms());
         }
     }
+
+    if (activity) last_activity_.store(now_ms());
+    return activity;
 }
 
 } // namespace cinepi
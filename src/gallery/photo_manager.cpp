@@ -2,10 +2,9 @@
  * CinePi Camera - Photo Manager
  * Orchestrates the capture pipeline:
  * 1. Check flash requirement
- * 2. Fire flash if needed
- * 3. Trigger capture
- * 4. Save JPEG
- * 5. Haptic feedback
+ * 2. Trigger capture (the pipeline times the flash to the captured frame)
+ * 3. Save JPEG
+ * 4. Haptic feedback
  */
 
 #include "gallery/photo_manager.h"
@@ -14,11 +13,29 @@
 #include "drivers/gpio_driver.h"
 #include "drivers/i2c_sensors.h"
 #include "core/config.h"
+#include "core/constants.h"
+#include "core/metrics.h"
 
+#include <cmath>
 #include <cstdio>
 
 namespace cinepi {
 
+static Histogram& g_steady_delay = Metrics::instance().histogram(
+    "cinepi_steady_shutter_delay_seconds", "Capture delay added waiting for a still frame");
+static Counter& g_steady_timeouts = Metrics::instance().counter(
+    "cinepi_steady_shutter_timeouts_total", "Shake-aware captures that fell back to the stillest frame");
+static Histogram& g_flash_error = Metrics::instance().histogram(
+    "cinepi_flash_alignment_error_seconds", "Flash on edge vs the captured frame's exposure start (abs)");
+static Counter& g_flash_missed = Metrics::instance().counter(
+    "cinepi_flash_missed_total", "Flash captures whose pulse did not cover the frame's exposure");
+
+// Motion blur across the saved image (preview width) for a swept angle
+static float blur_px(float swept_deg) {
+    float focal = (PREVIEW_W / 2.0f) / std::tan(CAMERA_HFOV_DEG * static_cast<float>(M_PI) / 360.0f);
+    return focal * std::tan(swept_deg * static_cast<float>(M_PI) / 180.0f);
+}
+
 PhotoManager::PhotoManager() = default;
 PhotoManager::~PhotoManager() = default;
 
@@ -28,21 +45,29 @@ void PhotoManager::init(CameraPipeline& cam, GpioDriver& gpio, I2CSensors* senso
     sensors_ = sensors;
 
     // Register shutter button callback
-    gpio.on_shutter([this]() {
-        trigger_capture();
+    gpio.on_shutter([this](uint64_t pressed_us) {
+        trigger_capture(pressed_us);
+    });
+    gpio.on_shutter_half([this](bool held, uint64_t) {
+        half_press(held);
+    });
+    cam.set_flash_trigger([&gpio](uint64_t on_ns, uint64_t off_ns) {
+        return gpio.schedule_flash(on_ns, off_ns);
     });
 
     fprintf(stderr, "[PhotoManager] Initialized\n");
 }
 
-void PhotoManager::trigger_capture() {
+void PhotoManager::trigger_capture(uint64_t pressed_us) {
     if (capturing_) return;
     capturing_ = true;
 
     auto& cfg = ConfigManager::instance().get();
 
-    // Generate filename
-    std::string path = PhotoCapture::generate_filename(cfg.photo_dir);
+    // Use the file a half-press prepared, else generate one
+    std::string path = prepared_path_.empty() ? PhotoCapture::generate_filename(cfg.photo_dir)
+                                              : prepared_path_;
+    prepared_path_.clear();
 
     // Check flash
     CaptureParams params;
@@ -50,28 +75,37 @@ void PhotoManager::trigger_capture() {
     params.shutter_us = cfg.camera.shutter_us;
     params.wb_mode = cfg.camera.wb_mode;
     params.flash_mode = cfg.camera.flash_mode;
-    params.ambient_lux = sensors_->cached_lux();
+    // No sensors: 0 lx, as with a BH1750 that never reported
+    params.ambient_lux = sensors_ ? sensors_->cached_lux() : 0.0f;
 
     bool use_flash = PhotoCapture::should_flash(params);
-    if (use_flash && gpio_) {
-        gpio_->set_flash(true);
+
+    SteadyCapture steady;
+    if (cfg.camera.steady_wait_ms > 0 && sensors_ && sensors_->gyro_calibrated()) {
+        steady.max_wait_us = static_cast<uint32_t>(cfg.camera.steady_wait_ms) * 1000;
+        steady.max_dps = cfg.camera.steady_max_dps;
+        I2CSensors* s = sensors_;
+        steady.shake = [s](const FrameTiming& t, bool* covered) {
+            FrameMotion m = s->motion_during(t.sensor_ts_ns, t.exposure_us * 1000ULL);
+            *covered = m.covered;
+            return m.samples > 0 ? m.peak_dps : -1.0f;
+        };
     }
 
     // Trigger capture
-    cam_->capture_photo(path, [this, path, use_flash](const std::string& saved_path, bool success) {
-        // Turn off flash
-        if (use_flash && gpio_) {
-            gpio_->set_flash(false);
-        }
-
+    cam_->capture_photo(path, [this, path](const std::string& saved_path, bool success) {
         if (success) {
             last_path_ = saved_path;
             // Haptic feedback
             if (gpio_) {
-                gpio_->vibrate(50);
+                gpio_->vibrate(Haptic::Saved);
             }
             fprintf(stderr, "[PhotoManager] Captured: %s\n", saved_path.c_str());
+            log_exposure_motion();
+            log_steady_selection();
+            log_flash_alignment();
         } else {
+            if (gpio_) gpio_->vibrate(Haptic::Error);
             fprintf(stderr, "[PhotoManager] Capture failed\n");
         }
 
@@ -80,15 +114,78 @@ void PhotoManager::trigger_capture() {
         if (done_cb_) {
             done_cb_(success, saved_path);
         }
-    });
+    }, std::move(steady), pressed_us, use_flash);
 
-    // For synchronous mode (when capture_photo doesn't call callback immediately),
-    // we do an immediate vibrate as feedback that the capture was initiated
+    // Immediate feedback that the capture was initiated; the pattern plays
+    // on the GPIO output thread, so this returns at once
     if (gpio_) {
-        gpio_->vibrate(30);
+        gpio_->vibrate(Haptic::Shutter);
     }
 }
 
+void PhotoManager::half_press(bool held) {
+    if (!held) {
+        // Ends the AE/AWB lock; an unused prepared file is removed
+        prepared_path_.clear();
+        cam_->release_capture();
+        return;
+    }
+    if (capturing_ || !prepared_path_.empty()) return;
+    std::string path = PhotoCapture::generate_filename(ConfigManager::instance().get().photo_dir);
+    if (cam_->prepare_capture(path)) prepared_path_ = path;
+}
+
+void PhotoManager::log_exposure_motion() const {
+    FrameTiming t = cam_->last_capture_timing();
+    if (!sensors_ || t.sensor_ts_ns == 0) return;
+    FrameMotion m = sensors_->motion_during(t.sensor_ts_ns, t.exposure_us * 1000ULL);
+    if (!m.covered) return;
+    fprintf(stderr, "[PhotoManager] Frame %u: %u us exposure, swept %.3f deg "
+                    "(peak %.1f dps), roll %.1f deg, %.0f lux\n",
+            t.sequence, t.exposure_us, m.swept_deg, m.peak_dps, m.roll_deg,
+            sensors_->lux_at(t.sensor_ts_ns));
+}
+
+void PhotoManager::log_steady_selection() const {
+    CaptureSelection sel = cam_->last_capture_selection();
+    FrameTiming chosen = cam_->last_capture_timing();
+    if (!sensors_ || sel.frames <= 1 || chosen.sensor_ts_ns < sel.first.sensor_ts_ns) return;
+
+    uint64_t delay_ns = chosen.sensor_ts_ns - sel.first.sensor_ts_ns;
+    g_steady_delay.record_us(delay_ns / 1000);
+    if (!sel.still) g_steady_timeouts.inc();
+
+    FrameMotion first = sensors_->motion_during(sel.first.sensor_ts_ns, sel.first.exposure_us * 1000ULL);
+    FrameMotion used = sensors_->motion_during(chosen.sensor_ts_ns, chosen.exposure_us * 1000ULL);
+    fprintf(stderr, "[PhotoManager] Steady shutter: +%.0f ms over %d frames (%s), "
+                    "blur %.2f px instead of %.2f px\n",
+            delay_ns / 1e6, sel.frames, sel.still ? "still" : "stillest on timeout",
+            blur_px(used.swept_deg), blur_px(first.swept_deg));
+}
+
+void PhotoManager::log_flash_alignment() const {
+    CaptureSelection sel = cam_->last_capture_selection();
+    FrameTiming t = cam_->last_capture_timing();
+    if (!gpio_ || sel.flash_start_ns == 0 || t.sensor_ts_ns == 0) return;
+    FlashPulse p = gpio_->last_flash();
+    if (p.on_ns == 0 || p.off_ns == 0) return;
+
+    // The pulse should open FLASH_PRE_US before the first row and stay lit
+    // past the first row's exposure end
+    int64_t on_err_us = (static_cast<int64_t>(p.on_ns) - static_cast<int64_t>(t.sensor_ts_ns)) / 1000
+                      + FLASH_PRE_US;
+    uint64_t first_row_end = t.sensor_ts_ns + t.exposure_us * 1000ULL;
+    bool covered = p.on_ns <= t.sensor_ts_ns && p.off_ns >= first_row_end;
+    g_flash_error.record_us(static_cast<uint64_t>(on_err_us < 0 ? -on_err_us : on_err_us));
+    if (!covered) g_flash_missed.inc();
+    fprintf(stderr, "[PhotoManager] Flash: frame %u exposure start %+.2f ms from prediction, "
+                    "on edge %+lld us (switch %+lld us), lit %.1f ms, %s\n",
+            t.sequence, (static_cast<int64_t>(t.sensor_ts_ns) - static_cast<int64_t>(sel.flash_start_ns)) / 1e6,
+            static_cast<long long>(on_err_us),
+            static_cast<long long>((static_cast<int64_t>(p.on_ns) - static_cast<int64_t>(p.target_on_ns)) / 1000),
+            (p.off_ns - p.on_ns) / 1e6, covered ? "covers exposure" : "MISSED exposure");
+}
+
 void PhotoManager::on_capture_done(DoneCallback cb) {
     done_cb_ = std::move(cb);
 }
@@ -6,13 +6,23 @@
 #include "core/config.h"
 #include "core/constants.h"
 #include "core/hardware_health.h"
+#include "core/event_loop.h"
+#include "core/thread_registry.h"
+#include "core/metrics.h"
+#include "core/trace.h"
+#include "core/memory_accounting.h"
+#include "core/jank_detector.h"
+#include "core/init_graph.h"
 #include "drivers/drm_display.h"
 #include "drivers/touch_input.h"
 #include "drivers/gpio_driver.h"
 #include "drivers/i2c_sensors.h"
+#include "drivers/backlight.h"
 #include "camera/camera_pipeline.h"
 #include "camera/photo_capture.h"
 #include "ui/lvgl_driver.h"
+#include "ui/asset_pack.h"
+#include "ui/screen_lifecycle.h"
 #include "ui/scene_manager.h"
 #include "ui/camera_scene.h"
 #include "ui/gallery_scene.h"
@@ -27,44 +37,58 @@
 #include <cstring>
 #include <unistd.h>
 #include <chrono>
-#include <thread>
 #include <atomic>
 #include <ctime>
 #include <sys/stat.h>
 #include <memory>
+#include <thread>
+#include <sys/epoll.h>
+#include <sys/signalfd.h>
 
 using namespace cinepi;
 
 static std::atomic<bool> g_running{true};
+static EventLoop* g_loop = nullptr;
 
 static void signal_handler(int sig) {
     fprintf(stderr, "\n[Main] Signal %d received, graceful shutdown...\n", sig);
     g_running = false;
+    // The signal may land on a libcamera thread; kick the reactor awake.
+    if (g_loop) g_loop->wake();
 }
 
 class AppComponentManager {
 public:
     AppComponentManager() = default;
     
-    bool init_all(const HardwareHealth& hw) {
+    // Bring-up runs as a dependency graph: camera, display, touch, GPIO and
+    // I2C are independent; LVGL needs display + touch, the UI needs LVGL.
+    // Each driver init doubles as its health probe.
+    bool init_all(HardwareHealth& hw) {
         hw_ = &hw;
-        
-        if (!init_camera()) {
+
+        InitGraph graph;
+        graph.add("camera",  {}, [this]() { return init_camera(); });
+        graph.add("display", {}, [this]() { return init_display(); });
+        graph.add("touch",   {}, [this]() { return init_touch(); });
+        graph.add("gpio",    {}, [this]() { return init_gpio(); });
+        graph.add("i2c",     {}, [this]() { return init_sensors(); });
+        graph.add("lvgl",    {"display", "touch"}, [this]() { return init_lvgl(); });
+        graph.add("ui",      {"lvgl"}, [this]() { return init_ui(); });
+
+        if (!graph.run()) return false;
+        graph.print_timeline();
+        hw.log_status();
+
+        if (!camera_) {
             fprintf(stderr, "[AppInit] FATAL: Camera init failed\n");
             return false;
         }
-        
-        if (!init_display()) {
+        if (!display_ || !lvgl_) {
             fprintf(stderr, "[AppInit] FATAL: Display init failed\n");
             return false;
         }
-        
-        init_touch();
-        init_gpio();
-        init_sensors();
-        init_lvgl();
-        init_ui();
-        
+
         return true;
     }
     
@@ -80,7 +104,7 @@ public:
     bool has_sensors() const { return sensors_ != nullptr; }
 
 private:
-    const HardwareHealth* hw_ = nullptr;
+    HardwareHealth* hw_ = nullptr;
     std::unique_ptr<CameraPipeline> camera_;
     std::unique_ptr<DrmDisplay> display_;
     std::unique_ptr<TouchInput> touch_;
@@ -89,11 +113,6 @@ private:
     std::unique_ptr<LvglDriver> lvgl_;
     
     bool init_camera() {
-        if (!hw_->is_available(HardwareComponent::Camera)) {
-            fprintf(stderr, "[AppInit] Camera unavailable\n");
-            return false;
-        }
-        
         try {
             camera_ = std::make_unique<CameraPipeline>();
             if (!camera_ || !camera_->init()) {
@@ -111,16 +130,12 @@ private:
             return false;
         }
         
+        hw_->set_status(HardwareComponent::Camera, HardwareStatus::OK);
         fprintf(stderr, "[AppInit] ✓ Camera initialized\n");
         return true;
     }
     
     bool init_display() {
-        if (!hw_->is_available(HardwareComponent::Display)) {
-            fprintf(stderr, "[AppInit] Display unavailable\n");
-            return false;
-        }
-        
         try {
             display_ = std::make_unique<DrmDisplay>();
             if (!display_ || !display_->init()) {
@@ -138,58 +153,48 @@ private:
             return false;
         }
         
+        hw_->set_status(HardwareComponent::Display, HardwareStatus::OK);
         fprintf(stderr, "[AppInit] ✓ Display initialized\n");
         return true;
     }
     
     bool init_touch() {
-        if (!hw_->is_available(HardwareComponent::TouchInput)) {
-            fprintf(stderr, "[AppInit] ⚠ Touch unavailable (will use GPIO)\n");
-            return false;
-        }
-        
         touch_ = std::make_unique<TouchInput>();
         if (!touch_->init()) {
-            fprintf(stderr, "[AppInit] ⚠ Touch init failed\n");
+            fprintf(stderr, "[AppInit] ⚠ Touch unavailable (will use GPIO)\n");
+            hw_->set_status(HardwareComponent::TouchInput, HardwareStatus::Degraded);
             touch_.reset();
             return false;
         }
         
+        hw_->set_status(HardwareComponent::TouchInput, HardwareStatus::OK);
         fprintf(stderr, "[AppInit] ✓ Touch initialized\n");
         return true;
     }
     
     bool init_gpio() {
-        if (!hw_->is_available(HardwareComponent::GPIOButtons)) {
-            fprintf(stderr, "[AppInit] ⚠ GPIO unavailable (will use touch)\n");
-            return false;
-        }
-        
         gpio_ = std::make_unique<GpioDriver>();
         if (!gpio_->init()) {
-            fprintf(stderr, "[AppInit] ⚠ GPIO init failed\n");
+            fprintf(stderr, "[AppInit] ⚠ GPIO unavailable (will use touch)\n");
+            hw_->set_status(HardwareComponent::GPIOButtons, HardwareStatus::Failed);
             gpio_.reset();
             return false;
         }
         
+        hw_->set_status(HardwareComponent::GPIOButtons, HardwareStatus::OK);
         fprintf(stderr, "[AppInit] ✓ GPIO initialized\n");
         return true;
     }
     
     bool init_sensors() {
-        if (!hw_->is_available(HardwareComponent::I2CSensors)) {
-            fprintf(stderr, "[AppInit] ⚠ Sensors unavailable\n");
-            return false;
-        }
-        
         sensors_ = std::make_unique<I2CSensors>();
         if (!sensors_->init()) {
-            fprintf(stderr, "[AppInit] ⚠ Sensors init failed\n");
+            fprintf(stderr, "[AppInit] ⚠ Sensors unavailable\n");
             sensors_.reset();
             return false;
         }
         
-        sensors_->start_polling();
+        hw_->set_status(HardwareComponent::I2CSensors, HardwareStatus::OK);
         fprintf(stderr, "[AppInit] ✓ Sensors initialized\n");
         return true;
     }
@@ -224,13 +229,14 @@ private:
     }
     
     bool init_ui() {
-        // Initialize SquareLine generated UI once LVGL is ready
-        ui_init();
+        if (!lvgl_) return false;
 
-        // Ensure the main camera UI is the active screen
-        if (ui_main) {
-            lv_scr_load(ui_main);
-        }
+        // Fonts/images must be bound before the screens reference them
+        AssetPack::instance().load(ASSET_PACK_PATH);
+
+        // Home screen only; gallery/settings are built on first visit
+        ScreenLifecycle::instance().init_home();
+        AssetPack::instance().apply_fixups();
 
         // Force full redraw so UI buffer is populated immediately
         lv_obj_invalidate(lv_scr_act());
@@ -251,24 +257,29 @@ int main(int argc, char* argv[]) {
     signal(SIGTERM, signal_handler);
     signal(SIGQUIT, signal_handler);
 
+    // SIGUSR1 (trace dump) is read from a signalfd in the event loop; block
+    // it before any thread exists so every thread inherits the mask.
+    sigset_t usr1_mask;
+    sigemptyset(&usr1_mask);
+    sigaddset(&usr1_mask, SIGUSR1);
+    sigprocmask(SIG_BLOCK, &usr1_mask, nullptr);
+
     auto& config = ConfigManager::instance();
     config.load();
     
     mkdir(config.get().photo_dir.c_str(), 0755);
+
+    // Threads spawned from here on pick up their affinity/priority at creation
+    ThreadRegistry::instance().set_plan(config.get().threads);
+    Tracer::instance().set_enabled(config.get().debug.trace);
     
     fprintf(stderr, "[Main] Config loaded (ISO=%d, Shutter=%dus)\n",
             config.get().camera.iso, config.get().camera.shutter_us);
 
     HardwareHealth hw;
-    if (!hw.init()) {
-        fprintf(stderr, "[Main] FATAL: Critical hardware missing\n");
-        fprintf(stderr, "%s\n", hw.get_full_status().c_str());
-        return 1;
-    }
-
     AppComponentManager app;
     if (!app.init_all(hw)) {
-        fprintf(stderr, "[Main] FATAL: Critical app initialization failed\n");
+        fprintf(stderr, "[Main] FATAL: Critical hardware missing\n");
         return 1;
     }
 
@@ -277,6 +288,13 @@ int main(int argc, char* argv[]) {
         display->set_camera_dmabuf(dmabuf_fd, w, h, stride, fmt);
     });
 
+    if (app.has_sensors() && config.get().camera.eis) {
+        I2CSensors* sensors = app.sensors();
+        app.camera()->set_stabilization(true, [sensors](uint64_t window_ns, GyroSample* g) {
+            return sensors->recent_gyro(window_ns, g);
+        });
+    }
+
     CameraScene camera_scene;
     camera_scene.init();
     
@@ -286,6 +304,14 @@ int main(int argc, char* argv[]) {
     SettingsScene settings_scene;
     settings_scene.init();
 
+    auto& screens = ScreenLifecycle::instance();
+    screens.set_lvgl(app.lvgl());
+    screens.add("main", &ui_main, ui_main_screen_destroy, true);
+    screens.add("gallery", &ui_Gallery1, ui_Gallery1_screen_destroy, false,
+                [&gallery_scene]() { gallery_scene.release(); });
+    screens.add("settings", &ui_settings1, ui_settings1_screen_destroy, false,
+                [&settings_scene]() { settings_scene.release(); });
+
     Scene current_scene = Scene::Camera;
     Scene last_scene = Scene::Camera;
 
@@ -307,131 +333,293 @@ int main(int argc, char* argv[]) {
         fprintf(stderr, "[Main] ⚠ Power manager disabled (needs GPIO)\n");
     }
 
+    // Encoder: zoom on the camera screen, photo position in the gallery
+    if (app.has_gpio()) {
+        app.gpio()->on_encoder_rotate([&app, &current_scene, &gallery_scene](int steps) {
+            if (current_scene == Scene::Gallery) {
+                gallery_scene.step(steps);
+            } else if (current_scene == Scene::Camera) {
+                CameraPipeline* cam = app.camera();
+                cam->set_digital_zoom(cam->digital_zoom() + steps * ENCODER_ZOOM_STEP);
+            }
+        });
+    }
+
     if (!app.camera()->start_preview()) {
         fprintf(stderr, "[Main] FATAL: Camera preview start failed\n");
         return 1;
     }
 
-    {
-        FILE* fp = fopen(BACKLIGHT_BRIGHTNESS, "w");
-        if (fp) {
-            fprintf(fp, "%d", config.get().display.brightness);
-            fclose(fp);
-        }
+    auto& backlight = Backlight::instance();
+    backlight.open();
+    backlight.set_auto(config.get().display.auto_brightness && app.has_sensors());
+    backlight.set_level(config.get().display.brightness, 0);
+
+    // ─── Event loop: every driver fd in one epoll set ───────────────────
+    EventLoop loop;
+    if (!loop.init()) {
+        fprintf(stderr, "[Main] FATAL: Event loop init failed\n");
+        return 1;
+    }
+    g_loop = &loop;
+    app.camera()->set_event_loop(&loop);
+
+    // Telemetry endpoint: curl --unix-socket METRICS_SOCKET http://cinepi/metrics
+    MetricsServer metrics_server;
+    metrics_server.init(loop, METRICS_SOCKET);
+    Histogram& ui_frame_hist = Metrics::instance().histogram(
+        "cinepi_ui_frame_seconds", "Main loop UI step: lv_timer_handler + commit");
+
+    // Per-subsystem memory sources (process totals come from smaps_rollup)
+    auto& mem = MemoryAccounting::instance();
+    mem.add_source("lvgl_heap",      [&app]() -> uint64_t { return app.lvgl()->heap_used(); });
+    mem.add_source("lvgl_draw_bufs", [&app]() -> uint64_t { return app.lvgl()->draw_buf_bytes(); });
+    mem.add_source("asset_pack",     []() -> uint64_t { return AssetPack::instance().resident_bytes(); });
+    mem.add_source("gallery_image",  [&gallery_scene]() -> uint64_t { return gallery_scene.image_bytes(); });
+    mem.add_source("encoder_frames", [&app]() -> uint64_t { return app.camera()->encoder_bytes(); });
+    mem.add_source("camera_buffers", [&app]() -> uint64_t { return app.camera()->dmabuf_bytes(); }, true);
+    mem.add_source("drm_dumb_bufs",  [&app]() -> uint64_t { return app.display()->dumb_bytes(); }, true);
+    // Startup time and RSS with the UI up: compare CINEPI_ASSET_PACK builds
+    InitGraph::report_ready();
+    mem.report();
+
+    // kill -USR1 <pid>: dump the trace window, or start tracing if it was off
+    int usr1_fd = signalfd(-1, &usr1_mask, SFD_NONBLOCK | SFD_CLOEXEC);
+    if (usr1_fd >= 0) {
+        loop.add_fd(usr1_fd, EPOLLIN, [usr1_fd, &config](uint32_t) {
+            struct signalfd_siginfo si;
+            while (read(usr1_fd, &si, sizeof(si)) == sizeof(si)) {}
+
+            if (!Tracer::instance().enabled()) {
+                Tracer::instance().set_enabled(true);
+                fprintf(stderr, "[Trace] Enabled, send SIGUSR1 again to dump\n");
+                return;
+            }
+            char path[128];
+            snprintf(path, sizeof(path), "%s/cinepi-trace-%ld.json",
+                     TRACE_DUMP_DIR, static_cast<long>(time(nullptr)));
+            Tracer::instance().dump(path, config.get().debug.trace_window_sec);
+        });
     }
 
-    fprintf(stderr, "[Main] ═══════════════════════════════════════════\n");
-    fprintf(stderr, "[Main] App ready! Running with:\n");
-    fprintf(stderr, "%s\n", hw.get_full_status().c_str());
-    fprintf(stderr, "[Main] Entering main loop (30 FPS target)\n");
-    fprintf(stderr, "[Main] ═══════════════════════════════════════════\n\n");
+    if (app.has_sensors()) {
+        app.sensors()->start_polling();
+    }
+    backlight.attach(loop);
+    loop.add_fd(app.display()->get_drm_fd(), EPOLLIN, [&app](uint32_t) {
+        app.display()->handle_events();
+    });
 
-    using clock = std::chrono::steady_clock;
-    auto target_frame_duration = std::chrono::milliseconds(33);  // 30 FPS
-    uint32_t frame_count = 0;
-    uint32_t frame_drops = 0;
-    auto last_fps_time = clock::now();
-    auto last_render_time = clock::now();
-
-    while (g_running) {
-        auto frame_start = clock::now();
-
-        // Scene detection and lifecycle handling
-        if (lv_scr_act() == ui_Gallery1) {
-            current_scene = Scene::Gallery;
-        } else if (lv_scr_act() == ui_settings1) {
-            current_scene = Scene::Settings;
-        } else {
-            current_scene = Scene::Camera;
-        }
+    const bool power_enabled = app.has_gpio() && app.has_sensors();
 
-        if (current_scene != last_scene) {
-            if (last_scene == Scene::Gallery) gallery_scene.leave();
-            if (last_scene == Scene::Settings) settings_scene.leave();
+    uint64_t camera_frames = 0;
+    int frame_wakes = 0;   // frame eventfd dispatches in the current run_once()
+    int cam_efd = app.camera()->frame_event_fd();
+    loop.add_fd(cam_efd, EPOLLIN, [cam_efd, &camera_frames, &frame_wakes, &power, power_enabled](uint32_t) {
+        uint64_t n = 0;
+        if (read(cam_efd, &n, sizeof(n)) == sizeof(n)) camera_frames += n;
+        frame_wakes++;
+        if (power_enabled) power.on_frame();
+    });
 
-            if (current_scene == Scene::Gallery) gallery_scene.enter();
-            if (current_scene == Scene::Settings) settings_scene.enter();
+    // Input wakes LVGL's read timer immediately and is the power wake trigger
+    if (app.has_touch()) {
+        loop.add_fd(app.touch()->fd(), EPOLLIN, [&app, &power, power_enabled](uint32_t) {
+            if (app.touch()->process_events()) app.lvgl()->notify_input();
+            if (power_enabled) power.update();
+        });
+    }
+    if (app.has_gpio() && app.gpio()->event_fd() >= 0) {
+        loop.add_fd(app.gpio()->event_fd(), EPOLLIN, [&app, &power, power_enabled](uint32_t) {
+            app.gpio()->process_events();
+            if (power_enabled) power.update();
+        });
+    }
 
-            last_scene = current_scene;
+    // Clock overlay + idle timeout: 1 Hz, and only redraws when the text changes
+    char clock_text[32] = "";
+    loop.add_timer(1000, [&](uint64_t) {
+        if (power_enabled) power.update();
+        if (app.has_sensors()) {
+            backlight.set_auto(config.get().display.auto_brightness);
+            backlight.update_ambient(app.sensors()->cached_lux());
         }
+        if (!ui_INFOSONSCREEN) return;
 
-        // Scene updates
-        if (current_scene == Scene::Camera && app.has_sensors()) {
-            camera_scene.update(*app.camera(), *app.sensors());
+        bool show = config.get().display.show_clock;
+        if (show == lv_obj_has_flag(ui_INFOSONSCREEN, LV_OBJ_FLAG_HIDDEN)) {
+            if (show) lv_obj_clear_flag(ui_INFOSONSCREEN, LV_OBJ_FLAG_HIDDEN);
+            else      lv_obj_add_flag(ui_INFOSONSCREEN, LV_OBJ_FLAG_HIDDEN);
         }
+        if (!show) return;
 
-        // Apply runtime camera look settings from config
-        app.camera()->set_white_balance(config.get().camera.wb_mode);
-
-        // Clock/status overlay update (once per second)
-        static time_t last_clock = 0;
         time_t now = time(nullptr);
-        if (now != last_clock) {
-            last_clock = now;
-            if (ui_INFOSONSCREEN) {
-                if (config.get().display.show_clock) {
-                    lv_obj_clear_flag(ui_INFOSONSCREEN, LV_OBJ_FLAG_HIDDEN);
-                    struct tm* t = localtime(&now);
-                    if (t) {
-                        char buf[32];
-                        snprintf(buf, sizeof(buf), "%02d:%02d", t->tm_hour, t->tm_min);
-                        lv_obj_t* label = lv_obj_get_child(ui_INFOSONSCREEN, 0);
-                        if (!label || !lv_obj_check_type(label, &lv_label_class)) {
-                            label = lv_label_create(ui_INFOSONSCREEN);
-                            lv_obj_center(label);
-                        }
-                        lv_label_set_text(label, buf);
-                    }
-                } else {
-                    lv_obj_add_flag(ui_INFOSONSCREEN, LV_OBJ_FLAG_HIDDEN);
-                }
-            }
+        struct tm* t = localtime(&now);
+        if (!t) return;
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%02d:%02d", t->tm_hour, t->tm_min);
+        if (strcmp(buf, clock_text) == 0) return;
+        memcpy(clock_text, buf, sizeof(clock_text));
+
+        lv_obj_t* label = lv_obj_get_child(ui_INFOSONSCREEN, 0);
+        if (!label || !lv_obj_check_type(label, &lv_label_class)) {
+            label = lv_label_create(ui_INFOSONSCREEN);
+            lv_obj_center(label);
         }
+        lv_label_set_text(label, clock_text);
+    }, 0);
 
-        // Power management update (optional hardware)
-        if (app.has_gpio() && app.has_sensors()) {
-            power.update();
-        }
+    using clock = std::chrono::steady_clock;
+    auto slow_frame = std::chrono::milliseconds(33);
+    uint64_t ui_ticks = 0;
+    uint32_t frame_drops = 0;
 
-        // Smart rendering: skip frames if behind
-        bool should_render = true;
-        if (app.has_gpio() && app.has_sensors()) {
-            should_render = !power.is_standby();
-        }
+    // Per-minute pacing report: a static screen should show ~1 wakeup/s
+    // (clock) plus sensor timers, and near-zero flips.
+    struct {
+        uint64_t wakeups = 0, ticks = 0, flips = 0, cam = 0;
+        double   ui_cpu_ms = 0, proc_cpu_ms = 0;
+    } last_stats;
+    auto cpu_ms = [](clockid_t id) {
+        struct timespec ts;
+        clock_gettime(id, &ts);
+        return ts.tv_sec * 1000.0 + ts.tv_nsec / 1e6;
+    };
+    last_stats.ui_cpu_ms   = 0;   // the timer runs on the ui thread, started below
+    last_stats.proc_cpu_ms = cpu_ms(CLOCK_PROCESS_CPUTIME_ID);
+    loop.add_timer(60000, [&](uint64_t) {
+        uint64_t wakeups = loop.wakeups();
+        uint64_t flips   = app.display()->flip_count();
+        double ui_cpu    = cpu_ms(CLOCK_THREAD_CPUTIME_ID);
+        double proc_cpu  = cpu_ms(CLOCK_PROCESS_CPUTIME_ID);
+        fprintf(stderr, "[Main] Last min: wakeups %llu | UI ticks %llu | flips %llu "
+                        "(%.1f fps) | cam %.1f fps | UI CPU %.0f ms | proc CPU %.0f ms | slow %u\n",
+                (unsigned long long)(wakeups - last_stats.wakeups),
+                (unsigned long long)(ui_ticks - last_stats.ticks),
+                (unsigned long long)(flips - last_stats.flips),
+                (flips - last_stats.flips) / 60.0,
+                (camera_frames - last_stats.cam) / 60.0,
+                ui_cpu - last_stats.ui_cpu_ms, proc_cpu - last_stats.proc_cpu_ms,
+                frame_drops);
+        last_stats.wakeups = wakeups;
+        last_stats.ticks   = ui_ticks;
+        last_stats.flips   = flips;
+        last_stats.cam     = camera_frames;
+        last_stats.ui_cpu_ms   = ui_cpu;
+        last_stats.proc_cpu_ms = proc_cpu;
+        ThreadRegistry::instance().report();
+        MemoryAccounting::instance().report();
+        screens.report();
+    });
 
-        if (should_render) {
-            app.lvgl()->tick();
-            app.display()->commit();
-            last_render_time = frame_start;
-        }
+    app.lvgl()->set_panel_rate(app.display()->refresh_hz());
 
-        auto frame_end = clock::now();
-        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-            frame_end - frame_start);
-        
-        // Adaptive frame-rate: don't sleep if we're behind
-        if (elapsed < target_frame_duration) {
-            std::this_thread::sleep_for(target_frame_duration - elapsed);
-        } else {
-            frame_drops++;
-        }
+    fprintf(stderr, "[Main] ═══════════════════════════════════════════\n");
+    fprintf(stderr, "[Main] App ready! Running with:\n");
+    fprintf(stderr, "%s\n", hw.get_full_status().c_str());
+    fprintf(stderr, "[Main] Entering event loop (invalidation-driven UI, %d Hz panel)\n",
+            app.display()->refresh_hz());
+    fprintf(stderr, "[Main] ═══════════════════════════════════════════\n\n");
+
+    auto& jank = JankDetector::instance();
+    jank.set_threshold_ms(JANK_THRESHOLD_MS);
+    jank.set_log_path(JANK_LOG_PATH);
+    static const char* const kSceneNames[] = {"camera", "gallery", "settings"};
+
+    // The UI loop runs on its own "ui" thread, so the ui plan applies to it
+    // alone: the main thread keeps the process name and default scheduling
+    // (threads created later do not inherit core 1 / nice -5) and waits.
+    std::thread ui_thread = ThreadRegistry::instance().spawn("ui", [&]() {
+        int ui_timeout_ms = 0;
+        uint64_t ui_deadline_us = 0;   // LVGL's next timer, 0 = none scheduled
+        int applied_wb = -1;
+        while (g_running) {
+            // Sleep until a driver fd, a loop timer or LVGL's next timer is due.
+            // With a static screen LVGL has no timer ready and we block on fds.
+            frame_wakes = 0;
+            int woken = loop.run_once(ui_timeout_ms);
+
+            if (power_enabled && power.is_standby()) {
+                ui_timeout_ms = -1;  // LVGL paused; input fds wake us
+                continue;
+            }
+
+            // Preview frames only bump the frame counter: unless LVGL's timer
+            // is due, go back to sleep for the rest of its timeout
+            uint64_t now_us = metrics_now_us();
+            bool lvgl_due = ui_deadline_us && now_us >= ui_deadline_us;
+            if (woken > 0 && woken == frame_wakes && !lvgl_due) {
+                ui_timeout_ms = ui_deadline_us ? static_cast<int>((ui_deadline_us - now_us + 999) / 1000) : -1;
+                continue;
+            }
+
+            TRACE_SCOPE("main.ui_step");
+            jank.begin_frame();
+            jank.add_phase("loop.dispatch", loop.last_dispatch_us());
+
+            // Scene detection and lifecycle handling
+            if (lv_scr_act() == ui_Gallery1) {
+                current_scene = Scene::Gallery;
+            } else if (lv_scr_act() == ui_settings1) {
+                current_scene = Scene::Settings;
+            } else {
+                current_scene = Scene::Camera;
+            }
 
-        frame_count++;
-
-        // FPS monitoring (only every 150 frames to reduce overhead)
-        if (frame_count % 150 == 0) {
-            auto now = clock::now();
-            auto seconds = std::chrono::duration_cast<std::chrono::seconds>(
-                now - last_fps_time).count();
-            if (seconds > 0) {
-                double fps = 150.0 / seconds;
-                fprintf(stderr, "[Main] FPS: %.1f | Drops: %u/%u | RAM: ~%uMB\n",
-                        fps, frame_drops, frame_count, 
-                        static_cast<unsigned>(frame_count / 30));  // Rough estimate
-                last_fps_time = now;
+            jank.set_scene(static_cast<int>(current_scene),
+                           kSceneNames[static_cast<int>(current_scene)]);
+
+            if (current_scene != last_scene) {
+                JANK_PHASE("scene.switch");
+                if (last_scene == Scene::Gallery) gallery_scene.leave();
+                if (last_scene == Scene::Settings) settings_scene.leave();
+
+                screens.begin_enter();
+                if (current_scene == Scene::Gallery) gallery_scene.enter();
+                if (current_scene == Scene::Settings) settings_scene.enter();
+                screens.end_enter(lv_scr_act());
+
+                last_scene = current_scene;
+            }
+            screens.update(metrics_now_us());
+
+            // Scene updates (only invalidate on change)
+            if (current_scene == Scene::Camera && app.has_sensors()) {
+                JANK_PHASE("camera_scene.update");
+                camera_scene.update(*app.camera(), *app.sensors());
+            }
+
+            // Apply runtime camera look settings when the config changes
+            if (config.get().camera.wb_mode != applied_wb) {
+                applied_wb = config.get().camera.wb_mode;
+                app.camera()->set_white_balance(applied_wb);
+            }
+
+            auto tick_start = clock::now();
+            uint32_t next;
+            {
+                TRACE_SCOPE("main.lvgl_tick");
+                JANK_PHASE("lvgl.tick");
+                screens.begin_tick();
+                next = app.lvgl()->tick();
+                screens.end_tick(metrics_now_us());
             }
+            {
+                JANK_PHASE("drm.commit");
+                app.display()->commit();   // no-op unless LVGL flushed something
+            }
+            ui_ticks++;
+            auto tick_time = clock::now() - tick_start;
+            ui_frame_hist.record_us(
+                std::chrono::duration_cast<std::chrono::microseconds>(tick_time).count());
+            if (tick_time > slow_frame) frame_drops++;
+            jank.end_frame();
+
+            ui_timeout_ms = (next == UINT32_MAX) ? -1 : static_cast<int>(next);
+            ui_deadline_us = (next == UINT32_MAX) ? 0 : metrics_now_us() + next * 1000ULL;
         }
-    }
+    });
+    ui_thread.join();
 
     fprintf(stderr, "\n[Main] Initiating safe shutdown...\n");
     auto shutdown_start = clock::now();
@@ -456,12 +644,19 @@ int main(int argc, char* argv[]) {
     }
     app.lvgl()->deinit();
     app.display()->deinit();
+    metrics_server.deinit();
+    backlight.close();
+    g_loop = nullptr;
+    loop.deinit();
+    if (usr1_fd >= 0) close(usr1_fd);
 
     auto shutdown_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
         clock::now() - shutdown_start);
 
     fprintf(stderr, "[Main] Shutdown completed in %ldms\n", shutdown_elapsed.count());
-    fprintf(stderr, "[Main] Total frames: %u (drops: %u)\n", frame_count, frame_drops);
+    fprintf(stderr, "[Main] UI ticks: %llu, flips: %llu (slow: %u)\n",
+            (unsigned long long)ui_ticks,
+            (unsigned long long)app.display()->flip_count(), frame_drops);
     fprintf(stderr, "[Main] Goodbye.\n\n");
 
     return 0;
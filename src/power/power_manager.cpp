@@ -1,11 +1,14 @@
 /**
  * CinePi Camera - Power Manager
- * Standby when idle: screen off, camera paused, LVGL paused, CPU powersave.
- * Wake on touch, shutter, or encoder input.
+ * Tiered standby when idle: dim, UI paused, camera at a low frame rate,
+ * camera stopped.  Wake on touch, shutter, or encoder input; gyro motion
+ * holds the camera warm (at most dimmed) while it is being handled.
+ * Wake cost per tier is measured to the first camera frame.
  */
 
 #include "power/power_manager.h"
 #include "drivers/drm_display.h"
+#include "drivers/backlight.h"
 #include "camera/camera_pipeline.h"
 #include "drivers/touch_input.h"
 #include "drivers/gpio_driver.h"
@@ -13,6 +16,7 @@
 #include "ui/lvgl_driver.h"
 #include "core/config.h"
 #include "core/constants.h"
+#include "core/metrics.h"
 
 #include <cstdio>
 #include <cstring>
@@ -22,6 +26,18 @@
 
 namespace cinepi {
 
+static const char* const kTierNames[] = {"active", "dim", "ui-paused", "camera-low", "stopped"};
+
+static Gauge& g_tier = Metrics::instance().gauge(
+    "cinepi_power_tier", "Standby tier: 0 active, 1 dim, 2 UI paused, 3 camera low, 4 stopped");
+static Histogram* const g_wake_latency[] = {
+    nullptr,
+    &Metrics::instance().histogram("cinepi_wake_dim_seconds", "Wake from dim to first camera frame"),
+    &Metrics::instance().histogram("cinepi_wake_ui_paused_seconds", "Wake from UI paused to first camera frame"),
+    &Metrics::instance().histogram("cinepi_wake_camera_low_seconds", "Wake from low frame rate to first camera frame"),
+    &Metrics::instance().histogram("cinepi_wake_stopped_seconds", "Wake from camera stopped to first camera frame"),
+};
+
 static uint64_t now_ms() {
     using namespace std::chrono;
     return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
@@ -55,7 +71,6 @@ void PowerManager::init(DrmDisplay& display, CameraPipeline& cam,
     lvgl_ = &lvgl;
 
     timeout_sec_ = ConfigManager::instance().get().display.standby_sec;
-    saved_brightness_ = ConfigManager::instance().get().display.brightness;
 
     fprintf(stderr, "[Power] Initialized (timeout=%ds)\n", timeout_sec_);
 }
@@ -67,63 +82,128 @@ void PowerManager::update() {
     uint64_t last = last_activity_ms();
     uint64_t idle_ms = (last > 0) ? (now - last) : 0;
 
-    if (standby_.load()) {
-        // Check for wake triggers
-        if (idle_ms < 500) {  // Activity detected recently
-            wake();
-        }
-    } else {
-        // Check for idle timeout
-        uint64_t timeout_ms = static_cast<uint64_t>(timeout_sec_) * 1000;
-        bool gyro_still = !sensors_->has_movement(5.0f);
-
-        if (idle_ms > timeout_ms && gyro_still) {
-            sleep();
-        }
+    // Wake trigger: input activity detected recently
+    if (idle_ms < 500) {
+        wake();
+        return;
     }
-}
-
-void PowerManager::sleep() {
-    if (standby_.load()) return;
-    standby_ = true;
-
-    fprintf(stderr, "[Power] Entering standby\n");
 
-    // Save current brightness
-    saved_brightness_ = ConfigManager::instance().get().display.brightness;
-
-    // 1. Screen off
-    display_->set_blank(true);
+    uint64_t timeout_ms = static_cast<uint64_t>(timeout_sec_) * 1000;
+    PowerTier target = PowerTier::Active;
+    if (idle_ms > timeout_ms) {
+        uint64_t over_s = (idle_ms - timeout_ms) / 1000;
+        target = over_s >= STANDBY_STOP_SEC       ? PowerTier::Stopped
+               : over_s >= STANDBY_CAMERA_LOW_SEC ? PowerTier::CameraLow
+               : over_s >= STANDBY_UI_PAUSE_SEC   ? PowerTier::UiPaused
+               : PowerTier::Dim;
+    }
 
-    // 2. Pause camera
-    cam_->stop_preview();
+    // Handled but not touched: stay (or come back) no deeper than dim, so
+    // the first press finds the camera streaming.  A stopped camera stays
+    // stopped; motion in a bag should not restart it.
+    if (sensors_ && sensors_->has_movement(STANDBY_MOTION_DEG)) last_motion_ms_ = now;
+    bool handled = last_motion_ms_ && now - last_motion_ms_ < timeout_ms;
+    if (handled && target > PowerTier::Dim) {
+        target = tier_.load() == PowerTier::Stopped ? PowerTier::Stopped : PowerTier::Dim;
+    }
 
-    // 3. Pause LVGL rendering
-    lvgl_->pause();
+    if (target == PowerTier::Active) return;   // only input wakes fully
+    enter(target);
+}
 
-    // 4. CPU powersave
-    set_cpu_governor("powersave");
+void PowerManager::sleep() {
+    enter(PowerTier::Stopped);
 }
 
 void PowerManager::wake() {
-    if (!standby_.load()) return;
-    standby_ = false;
-
-    fprintf(stderr, "[Power] Waking up\n");
+    enter(PowerTier::Active);
+}
 
-    // 1. CPU performance
-    set_cpu_governor("performance");
+void PowerManager::enter(PowerTier tier) {
+    PowerTier from = tier_.load();
+    if (tier == from) return;
+    bool down = tier > from;
+    fprintf(stderr, "[Power] %s -> %s\n", kTierNames[static_cast<int>(from)],
+            kTierNames[static_cast<int>(tier)]);
 
-    // 2. Resume LVGL
-    lvgl_->resume();
+    // Clock up before undoing anything, so the camera restarts at speed
+    if (!down && from >= PowerTier::CameraLow && tier < PowerTier::CameraLow) {
+        set_cpu_governor("performance");
+    }
+    if (down) {
+        for (int t = static_cast<int>(from) + 1; t <= static_cast<int>(tier); t++) {
+            step(static_cast<PowerTier>(t), true);
+        }
+    } else {
+        for (int t = static_cast<int>(from); t > static_cast<int>(tier); t--) {
+            step(static_cast<PowerTier>(t), false);
+        }
+    }
+    if (down && from < PowerTier::CameraLow && tier >= PowerTier::CameraLow) {
+        set_cpu_governor("powersave");
+    }
 
-    // 3. Resume camera
-    cam_->start_preview();
+    tier_ = tier;
+    g_tier.set(static_cast<double>(tier));
+    if (tier == PowerTier::Active) {
+        wake_from_ = from;
+        wake_us_ = metrics_now_us();
+        wait_full_rate_ = false;
+    }
+}
 
-    // 4. Screen on
+// Enters (down) or leaves one tier; tiers are applied in order
+void PowerManager::step(PowerTier tier, bool down) {
     auto& cfg = ConfigManager::instance().get();
-    cfg.display.brightness = saved_brightness_;
-    display_->set_blank(false);
+    switch (tier) {
+    case PowerTier::Dim:
+        if (down) Backlight::instance().set_level(std::min(STANDBY_DIM_LEVEL, cfg.display.brightness));
+        else      Backlight::instance().set_level(cfg.display.brightness, BACKLIGHT_WAKE_FADE_MS);
+        break;
+    case PowerTier::UiPaused:
+        if (down) lvgl_->pause();
+        else      lvgl_->resume();
+        break;
+    case PowerTier::CameraLow:
+        display_->set_blank(down);
+        cam_->set_frame_rate_limit(down ? STANDBY_LOW_FPS : 0);
+        break;
+    case PowerTier::Stopped:
+        if (down) {
+            cam_->stop_preview();
+            cam_->set_frame_rate_limit(0);   // restart at the normal rate
+        } else {
+            cam_->start_preview();
+        }
+        break;
+    case PowerTier::Active:
+        break;
+    }
+}
+
+void PowerManager::on_frame() {
+    if (!wake_us_) return;
+    uint64_t now = metrics_now_us();
+    int from = static_cast<int>(wake_from_);
+
+    if (!wait_full_rate_) {
+        uint64_t lat_us = now - wake_us_;
+        if (g_wake_latency[from]) g_wake_latency[from]->record_us(lat_us);
+        fprintf(stderr, "[Power] Wake from %s: first frame after %.1f ms\n",
+                kTierNames[from], lat_us / 1000.0);
+        // Frames already queued at the low rate still have to come back
+        wait_full_rate_ = wake_from_ == PowerTier::CameraLow;
+        if (!wait_full_rate_) wake_us_ = 0;
+        return;
+    }
+
+    FrameTiming t = cam_->last_frame_timing();
+    if (t.frame_duration_us && t.frame_duration_us < 1000000 / STANDBY_LOW_FPS) {
+        fprintf(stderr, "[Power] Wake from %s: full frame rate after %.1f ms\n",
+                kTierNames[from], (now - wake_us_) / 1000.0);
+        wake_us_ = 0;
+        wait_full_rate_ = false;
+    }
 }
 
 void PowerManager::set_timeout(int seconds) {
@@ -0,0 +1,147 @@
+/**
+ * CinePi Camera - Encoder Replay
+ * Feeds a recorded (or synthetic) CLK/DT edge stream through
+ * QuadratureDecoder exactly as GpioDriver does, and prints the decoded
+ * detents and accelerated steps.  With --expect-* it exits non-zero on a
+ * mismatch, so recorded streams can be checked after decoder changes.
+ *
+ * Build: cmake -DCINEPI_SENSOR_BENCH=ON  (ctest replays the CSVs in tests/data)
+ * Usage: cinepi_encoder_replay [--stream file.csv | --synthetic] [--verbose]
+ *                              [--expect-detents N] [--expect-steps N]
+ *                              [--expect-invalid N]
+ * CSV: t_us,line,active  (line = GPIO offset, active 1 = contact closed,
+ *      i.e. the rising edges of the active-low line request); '#' = comment
+ */
+
+#include "drivers/quadrature.h"
+#include "core/constants.h"
+
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+using namespace cinepi;
+
+struct Edge {
+    uint64_t t_us;
+    int line;
+    bool active;
+};
+
+static bool load_csv(const char* path, std::vector<Edge>* out) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+    char line[128];
+    while (fgets(line, sizeof(line), f)) {
+        if (line[0] == '#' || line[0] == '\n') continue;
+        unsigned long long t;
+        int l, a;
+        if (sscanf(line, "%llu,%d,%d", &t, &l, &a) == 3) out->push_back({t, l, a != 0});
+    }
+    fclose(f);
+    return true;
+}
+
+// Full quadrature cycles, CLK leading = +1, plus contact bounce the kernel
+// debounce lets through and one lost edge.  Returns the expected detents.
+static int synthetic(std::vector<Edge>* out) {
+    uint64_t t = 0;
+    auto cycles = [&](int n, int dir, double hz) {
+        uint64_t quarter = static_cast<uint64_t>(1e6 / hz / 4.0);
+        int a = dir > 0 ? GPIO_ENCODER_CLK : GPIO_ENCODER_DT;
+        int b = dir > 0 ? GPIO_ENCODER_DT : GPIO_ENCODER_CLK;
+        for (int i = 0; i < n; i++) {
+            out->push_back({t += quarter, a, true});
+            out->push_back({t += quarter, b, true});
+            out->push_back({t += quarter, a, false});
+            out->push_back({t += quarter, b, false});
+        }
+    };
+    cycles(10, +1, 4.0);            // slow, deliberate clicks
+    t += 500000;
+    cycles(40, -1, 60.0);           // fast spin back
+    t += 500000;
+    // Bounce: CLK touches and lets go without DT moving
+    out->push_back({t += 2000, GPIO_ENCODER_CLK, true});
+    out->push_back({t += 2000, GPIO_ENCODER_CLK, false});
+    t += 500000;
+    // A detent whose DT closing edge was lost: DT's opening edge arrives
+    // as a duplicate, and that detent is dropped rather than guessed
+    out->push_back({t += 20000, GPIO_ENCODER_CLK, true});
+    out->push_back({t += 20000, GPIO_ENCODER_CLK, false});
+    out->push_back({t += 20000, GPIO_ENCODER_DT, false});
+    t += 500000;
+    cycles(5, +1, 20.0);
+    return 10 + 40 + 5;
+}
+
+int main(int argc, char** argv) {
+    const char* stream = nullptr;
+    bool verbose = false;
+    long expect_detents = -1, expect_steps = LONG_MIN, expect_invalid = -1;
+    for (int i = 1; i < argc; i++) {
+        bool has_arg = i + 1 < argc;
+        if (!strcmp(argv[i], "--stream") && has_arg) stream = argv[++i];
+        else if (!strcmp(argv[i], "--synthetic")) stream = nullptr;
+        else if (!strcmp(argv[i], "--verbose")) verbose = true;
+        else if (!strcmp(argv[i], "--expect-detents") && has_arg) expect_detents = atol(argv[++i]);
+        else if (!strcmp(argv[i], "--expect-steps") && has_arg) expect_steps = atol(argv[++i]);
+        else if (!strcmp(argv[i], "--expect-invalid") && has_arg) expect_invalid = atol(argv[++i]);
+        else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    std::vector<Edge> edges;
+    if (stream) {
+        if (!load_csv(stream, &edges)) return 1;
+    } else {
+        long want = synthetic(&edges);
+        if (expect_detents < 0) expect_detents = want;
+        if (expect_invalid < 0) expect_invalid = 1;
+    }
+
+    // Both contacts open at rest, as GpioDriver reads them at init
+    bool clk = false, dt = false;
+    QuadratureDecoder dec;
+    dec.reset(clk, dt);
+    long steps = 0, forward = 0, back = 0, max_burst = 0;
+    for (const Edge& e : edges) {
+        if (e.line == GPIO_ENCODER_CLK) clk = e.active;
+        else if (e.line == GPIO_ENCODER_DT) dt = e.active;
+        else continue;
+        int s = dec.update(clk, dt, e.t_us * 1000);
+        if (s == 0) continue;
+        steps += s;
+        (s > 0 ? forward : back) += s > 0 ? s : -s;
+        if (labs(s) > max_burst) max_burst = labs(s);
+        if (verbose) printf("  %10.3f s  %+3d  (total %+ld)\n", e.t_us / 1e6, s, steps);
+    }
+
+    printf("Encoder replay: %zu edges, %s\n", edges.size(), stream ? stream : "synthetic");
+    printf("  detents %llu, invalid transitions %llu\n",
+           (unsigned long long)dec.detents(), (unsigned long long)dec.invalid());
+    printf("  steps %+ld (forward %ld, back %ld), largest per detent %ld\n",
+           steps, forward, back, max_burst);
+
+    int rc = 0;
+    if (expect_detents >= 0 && static_cast<long>(dec.detents()) != expect_detents) {
+        printf("FAIL: expected %ld detents\n", expect_detents);
+        rc = 1;
+    }
+    if (expect_invalid >= 0 && static_cast<long>(dec.invalid()) != expect_invalid) {
+        printf("FAIL: expected %ld invalid transitions\n", expect_invalid);
+        rc = 1;
+    }
+    if (expect_steps != LONG_MIN && steps != expect_steps) {
+        printf("FAIL: expected %+ld steps\n", expect_steps);
+        rc = 1;
+    }
+    return rc;
+}
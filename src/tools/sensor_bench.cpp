@@ -0,0 +1,189 @@
+/**
+ * CinePi Camera - Sensor Bench
+ * Runs I2CSensors against the simulated bus on a build host, in real time
+ * on its real polling thread, and reports polling cadence, FIFO behaviour,
+ * fusion error against the trace, lux tracking and CPU cost.
+ *
+ * Build: cmake -DCINEPI_SENSOR_BENCH=ON (needs no camera/display libraries)
+ * Usage: cinepi_sensor_bench [--trace file.csv] [--seconds N] [--odr-error PCT]
+ *                            [--bias DPS] [--noise DPS] [--bus-hz HZ]
+ */
+
+#include "drivers/i2c_sensors.h"
+#include "drivers/i2c_sim.h"
+#include "core/constants.h"
+#include "core/metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <sys/resource.h>
+#include <unistd.h>
+
+using namespace cinepi;
+
+static double cpu_seconds() {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_utime.tv_sec + ru.ru_stime.tv_sec + (ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+static void report_cadence(const char* name, const std::vector<uint64_t>& t, int period_ms) {
+    // A poll may take several transfers (FIFO_SRC, then the drain); keep
+    // the first of each, and skip the bring-up burst before the first poll
+    std::vector<uint64_t> polls;
+    for (size_t i = 1; i < t.size(); i++) {
+        if (t[i] - t[i - 1] > period_ms * 500ULL) polls.push_back(t[i]);
+    }
+    if (polls.size() < 3) {
+        printf("  %-9s %zu polls\n", name, polls.size());
+        return;
+    }
+    double sum = 0.0, worst = 0.0;
+    for (size_t i = 1; i < polls.size(); i++) {
+        double d = (polls[i] - polls[i - 1]) / 1000.0 - period_ms;
+        sum += d;
+        worst = std::max(worst, std::fabs(d));
+    }
+    size_t n = polls.size() - 1;
+    // The schedule is an absolute grid, so per-poll jitter must not accumulate
+    double drift = (polls.back() - polls.front()) / 1000.0 - static_cast<double>(n) * period_ms;
+    printf("  %-9s %zu polls every %d ms: mean error %+.3f ms, worst %.3f ms, drift %+.3f ms\n",
+           name, n + 1, period_ms, sum / n, worst, drift);
+}
+
+int main(int argc, char** argv) {
+    const char* trace_path = nullptr;
+    double seconds = 12.0;
+    float odr_error = 0.02f, bias = 0.6f, noise = 0.15f;
+    uint32_t bus_hz = 100000;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--trace")) trace_path = argv[i + 1];
+        else if (!strcmp(argv[i], "--seconds")) seconds = atof(argv[i + 1]);
+        else if (!strcmp(argv[i], "--odr-error")) odr_error = static_cast<float>(atof(argv[i + 1]) / 100.0);
+        else if (!strcmp(argv[i], "--bias")) bias = static_cast<float>(atof(argv[i + 1]));
+        else if (!strcmp(argv[i], "--noise")) noise = static_cast<float>(atof(argv[i + 1]));
+        else if (!strcmp(argv[i], "--bus-hz")) bus_hz = static_cast<uint32_t>(atoi(argv[i + 1]));
+        else {
+            fprintf(stderr, "unknown option %s\n", argv[i]);
+            return 2;
+        }
+    }
+
+    SensorTrace trace;
+    if (trace_path) {
+        if (!trace.load_csv(trace_path)) return 1;
+    } else {
+        trace = SensorTrace::synthetic(seconds);
+    }
+
+    uint64_t t0 = metrics_now_us();
+    auto bus = std::make_unique<SimI2CBus>(bus_hz);
+    SimI2CBus* sim = bus.get();
+    SimDevice* light = sim->add(std::make_unique<SimBH1750>(I2C_ADDR_LIGHT, trace, t0));
+    auto* gyro = static_cast<SimL3G4200D*>(sim->add(std::make_unique<SimL3G4200D>(
+        I2C_ADDR_GYRO, trace, t0, odr_error, bias, noise)));
+
+    I2CSensors sensors;
+    if (!sensors.init(std::move(bus))) return 1;
+    if (!sensors.start_polling()) return 1;
+
+    // BOOTTIME (sample stamps) vs MONOTONIC (trace time) offset
+    const int64_t boot_offset_ns = static_cast<int64_t>(sensor_clock_ns()) -
+                                   static_cast<int64_t>(metrics_now_us()) * 1000;
+
+    struct Check { double t_s; float est[3]; float rate[3]; };
+    std::vector<Check> checks;
+    std::vector<float> lux_err;
+    double cpu0 = cpu_seconds();
+    uint64_t end = t0 + static_cast<uint64_t>(seconds * 1e6);
+    uint64_t next_check = t0;
+    while (metrics_now_us() < end) {
+        usleep(10000);
+        uint64_t now = metrics_now_us();
+        if (now < next_check) continue;
+        next_check += 50000;
+
+        GyroSample g;
+        if (sensors.gyro_calibrated() && sensors.recent_gyro(0, &g)) {
+            Check c;
+            c.t_s = ((static_cast<int64_t>(g.t_ns) - boot_offset_ns) / 1000 - static_cast<int64_t>(t0)) / 1e6;
+            std::copy(g.angle, g.angle + 3, c.est);
+            std::copy(g.rate, g.rate + 3, c.rate);
+            if (checks.empty() || c.t_s > checks.back().t_s) checks.push_back(c);
+        }
+        float rate[3], lux;
+        trace.sample((now - t0) / 1e6, rate, &lux);
+        if (lux > 0.0f && now - t0 > 1000000) lux_err.push_back(std::fabs(sensors.cached_lux() - lux) / lux);
+    }
+    double cpu = cpu_seconds() - cpu0;
+    double wall = (metrics_now_us() - t0) / 1e6;
+    sensors.stop_polling();
+
+    printf("Sensor bench: %.1f s %s trace, gyro ODR %+.1f%%, bias %.2f dps, noise %.2f dps\n",
+           wall, trace_path ? trace_path : "synthetic", odr_error * 100.0f, bias, noise);
+
+    printf("Cadence\n");
+    report_cadence("gyro", gyro->access_us, GYRO_READ_MS);
+    report_cadence("light", light->access_us, LIGHT_READ_MS);
+
+    auto& m = Metrics::instance();
+    uint64_t drained = m.counter("cinepi_gyro_samples_total", "").value();
+    printf("Gyro FIFO\n");
+    printf("  generated %llu, drained %llu, overwritten %llu, overrun drains %llu\n",
+           (unsigned long long)gyro->samples_generated(), (unsigned long long)drained,
+           (unsigned long long)gyro->samples_overwritten(),
+           (unsigned long long)m.counter("cinepi_gyro_fifo_overruns_total", "").value());
+    printf("  rate: measured %.1f Hz, true %.1f Hz\n", sensors.gyro_rate_hz(), 200.0f * (1.0f + odr_error));
+
+    printf("Fusion (integrated angle vs trace, from calibration on)\n");
+    if (checks.size() < 2) {
+        printf("  gyro never calibrated (trace must start still)\n");
+    } else {
+        // Integrate the trace between checks at 1 ms
+        double truth[3] = {}, sq[3] = {}, rate_sq[3] = {};
+        double t = checks.front().t_s;
+        for (size_t i = 1; i < checks.size(); i++) {
+            for (; t < checks[i].t_s; t += 0.001) {
+                float r[3], lux;
+                trace.sample(t, r, &lux);
+                double step = std::min(0.001, checks[i].t_s - t);
+                for (int a = 0; a < 3; a++) truth[a] += r[a] * step;
+            }
+            float r[3], lux;
+            trace.sample(checks[i].t_s, r, &lux);
+            for (int a = 0; a < 3; a++) {
+                double err = (checks[i].est[a] - checks.front().est[a]) - truth[a];
+                sq[a] += err * err;
+                rate_sq[a] += (checks[i].rate[a] - r[a]) * (checks[i].rate[a] - r[a]);
+            }
+        }
+        const Check& last = checks.back();
+        static const char* axis[3] = {"roll", "pitch", "yaw"};
+        for (int a = 0; a < 3; a++) {
+            double n = static_cast<double>(checks.size() - 1);
+            printf("  %-5s angle rms %.3f deg, final %+.3f deg; rate rms %.3f dps\n", axis[a],
+                   std::sqrt(sq[a] / n), (last.est[a] - checks.front().est[a]) - truth[a],
+                   std::sqrt(rate_sq[a] / n));
+        }
+    }
+
+    if (!lux_err.empty()) {
+        std::sort(lux_err.begin(), lux_err.end());
+        printf("Lux tracking: median error %.1f%%, p90 %.1f%%\n",
+               lux_err[lux_err.size() / 2] * 100.0f, lux_err[lux_err.size() * 9 / 10] * 100.0f);
+    }
+
+    printf("Cost\n");
+    printf("  CPU %.3f s in %.1f s (%.2f%% of a core), %llu poll loop wakeups\n",
+           cpu, wall, cpu / wall * 100.0, (unsigned long long)sensors.poll_loop().wakeups());
+    printf("  bus: %llu transfers, %llu bytes, %.2f%% busy at %u Hz, %llu NACKs\n",
+           (unsigned long long)sim->transfers(), (unsigned long long)sim->bytes(),
+           sim->wire_us() / (wall * 1e4), bus_hz, (unsigned long long)sim->nacks());
+
+    sensors.deinit();
+    return 0;
+}
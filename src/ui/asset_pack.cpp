@@ -0,0 +1,221 @@
+/**
+ * CinePi Camera - UI Asset Pack
+ * Glyph descriptors and bitmaps are used in place from the mapping; only
+ * the cmap and kerning headers (they hold pointers) are rebuilt on the heap.
+ */
+
+#include "ui/asset_pack.h"
+#include "core/metrics.h"
+
+#include "lvgl/lvgl.h"
+
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <vector>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#if CINEPI_ASSET_PACK
+// Generated by scripts/pack_assets.py (build/ui_assets.c)
+extern "C" {
+extern const uint32_t ui_asset_pack_crc;
+extern lv_font_fmt_txt_dsc_t* const ui_asset_font_dsc[];
+extern const char* const ui_asset_font_names[];
+extern const int ui_asset_font_count;
+extern lv_img_dsc_t* const ui_asset_img_dsc[];
+extern const char* const ui_asset_img_names[];
+extern const int ui_asset_img_count;
+extern lv_obj_t** const ui_asset_fixup_obj[];
+extern lv_img_dsc_t* const ui_asset_fixup_img[];
+extern const int ui_asset_fixup_count;
+}
+#endif
+
+namespace cinepi {
+
+static_assert(sizeof(lv_font_fmt_txt_glyph_dsc_t) == 8,
+              "pack stores glyph descriptors for LV_FONT_FMT_TXT_LARGE == 0");
+
+// Rebuilt headers; reserved up front so the pointers handed to LVGL stay put
+static std::vector<lv_font_fmt_txt_cmap_t>      g_cmaps;
+static std::vector<lv_font_fmt_txt_kern_pair_t> g_kerns;
+
+AssetPack& AssetPack::instance() {
+    static AssetPack inst;
+    return inst;
+}
+
+uint64_t AssetPack::resident_bytes() const {
+    if (!map_) return 0;
+    long page = sysconf(_SC_PAGESIZE);
+    std::vector<unsigned char> vec((size_ + page - 1) / page);
+    if (mincore(const_cast<uint8_t*>(map_), size_, vec.data()) != 0) return 0;
+    uint64_t pages = 0;
+    for (unsigned char v : vec) pages += v & 1;
+    return pages * page;
+}
+
+#if CINEPI_ASSET_PACK
+
+template <typename T>
+static const T* at(const uint8_t* base, size_t size, uint32_t off, size_t count = 1) {
+    if (off == 0 || off % alignof(T) != 0 || off + count * sizeof(T) > size) return nullptr;
+    return reinterpret_cast<const T*>(base + off);
+}
+
+static int find_name(const char* const* names, int count, const char* name, size_t len) {
+    for (int i = 0; i < count; i++) {
+        if (strncmp(names[i], name, len) == 0) return i;
+    }
+    return -1;
+}
+
+bool AssetPack::load(const char* path) {
+    if (map_) return true;
+    uint64_t t0 = metrics_now_us();
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        fprintf(stderr, "[Assets] Cannot open %s: %s (using default font)\n", path, strerror(errno));
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(PackHeader)) {
+        close(fd);
+        return false;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    // No MAP_POPULATE: glyph pages fault in on first draw
+    void* m = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (m == MAP_FAILED) {
+        fprintf(stderr, "[Assets] mmap %s failed: %s\n", path, strerror(errno));
+        return false;
+    }
+    const uint8_t* base = static_cast<const uint8_t*>(m);
+
+    const PackHeader* hdr = reinterpret_cast<const PackHeader*>(base);
+    size_t tables = sizeof(PackHeader) + hdr->n_fonts * sizeof(PackFont)
+                  + hdr->n_images * sizeof(PackImage);
+    if (hdr->magic != ASSET_PACK_MAGIC || hdr->version != ASSET_PACK_VERSION || tables > size) {
+        fprintf(stderr, "[Assets] %s: bad header\n", path);
+        munmap(m, size);
+        return false;
+    }
+    // The binary's symbols were generated together with one specific pack
+    if (hdr->crc != ui_asset_pack_crc) {
+        fprintf(stderr, "[Assets] %s does not match this build (crc %08x, want %08x)\n",
+                path, hdr->crc, ui_asset_pack_crc);
+        munmap(m, size);
+        return false;
+    }
+
+    const PackFont* fonts = reinterpret_cast<const PackFont*>(base + sizeof(PackHeader));
+    const PackImage* images = reinterpret_cast<const PackImage*>(fonts + hdr->n_fonts);
+
+    size_t n_cmaps = 0;
+    for (int i = 0; i < hdr->n_fonts; i++) n_cmaps += fonts[i].cmap_num;
+    g_cmaps.reserve(n_cmaps);
+    g_kerns.reserve(hdr->n_fonts);
+
+    int bound_fonts = 0;
+    for (int i = 0; i < hdr->n_fonts; i++) {
+        const PackFont& pf = fonts[i];
+        int slot = find_name(ui_asset_font_names, ui_asset_font_count, pf.name, sizeof(pf.name));
+        const auto* glyphs = at<lv_font_fmt_txt_glyph_dsc_t>(base, size, pf.glyph_off, pf.glyph_cnt);
+        const auto* bitmap = at<uint8_t>(base, size, pf.bitmap_off, pf.bitmap_size);
+        const auto* cmaps = at<PackCmap>(base, size, pf.cmap_off, pf.cmap_num);
+        if (slot < 0 || !glyphs || !bitmap || !cmaps) {
+            fprintf(stderr, "[Assets] Skipping font %.32s\n", pf.name);
+            continue;
+        }
+
+        size_t first_cmap = g_cmaps.size();
+        for (int c = 0; c < pf.cmap_num; c++) {
+            const PackCmap& pc = cmaps[c];
+            lv_font_fmt_txt_cmap_t cm = {};
+            cm.range_start    = pc.range_start;
+            cm.range_length   = pc.range_length;
+            cm.glyph_id_start = pc.glyph_id_start;
+            cm.unicode_list   = pc.unicode_list_off
+                ? at<uint16_t>(base, size, pc.unicode_list_off, pc.list_length) : nullptr;
+            cm.glyph_id_ofs_list = pc.glyph_id_ofs_off ? base + pc.glyph_id_ofs_off : nullptr;
+            cm.list_length    = pc.list_length;
+            cm.type           = static_cast<lv_font_fmt_txt_cmap_type_t>(pc.type);
+            g_cmaps.push_back(cm);
+        }
+
+        lv_font_fmt_txt_dsc_t* dsc = ui_asset_font_dsc[slot];
+        dsc->glyph_bitmap  = bitmap;
+        dsc->glyph_dsc     = glyphs;
+        dsc->cmaps         = &g_cmaps[first_cmap];
+        dsc->kern_scale    = pf.kern_scale;
+        dsc->bpp           = pf.bpp;
+        dsc->kern_classes  = 0;
+        dsc->bitmap_format = pf.bitmap_format;
+        dsc->kern_dsc      = nullptr;
+        if (pf.kern_ids_off && pf.kern_values_off) {
+            lv_font_fmt_txt_kern_pair_t kp = {};
+            kp.glyph_ids      = base + pf.kern_ids_off;
+            kp.values         = reinterpret_cast<const int8_t*>(base + pf.kern_values_off);
+            kp.pair_cnt       = pf.kern_pair_cnt;
+            kp.glyph_ids_size = pf.kern_ids_size;
+            g_kerns.push_back(kp);
+            dsc->kern_dsc = &g_kerns.back();
+        }
+        // Last: a non-zero cmap_num is what makes LVGL use the tables
+        dsc->cmap_num      = pf.cmap_num;
+        bound_fonts++;
+    }
+
+    int bound_images = 0;
+    for (int i = 0; i < hdr->n_images; i++) {
+        const PackImage& pi = images[i];
+        int slot = find_name(ui_asset_img_names, ui_asset_img_count, pi.name, sizeof(pi.name));
+        const auto* data = at<uint8_t>(base, size, pi.data_off, pi.data_size);
+        if (slot < 0 || !data) continue;
+        ui_asset_img_dsc[slot]->data = data;
+        ui_asset_img_dsc[slot]->data_size = pi.data_size;
+        bound_images++;
+    }
+
+    map_ = base;
+    size_ = size;
+    fprintf(stderr, "[Assets] Mapped %s: %zu KB, %d/%d fonts, %d/%d images in %.1f ms\n",
+            path, size / 1024, bound_fonts, ui_asset_font_count,
+            bound_images, ui_asset_img_count, (metrics_now_us() - t0) / 1000.0);
+    return true;
+}
+
+int AssetPack::apply_fixups() {
+    int applied = 0;
+    for (int i = 0; i < ui_asset_fixup_count; i++) {
+        lv_obj_t* obj = *ui_asset_fixup_obj[i];
+        const lv_img_dsc_t* img = ui_asset_fixup_img[i];
+        // Without the pack the variant has no pixels; LVGL keeps transforming
+        if (!obj || !img->data || lv_img_get_src(obj) == img) continue;
+        lv_img_set_zoom(obj, LV_IMG_ZOOM_NONE);
+        lv_img_set_angle(obj, 0);
+        lv_img_set_src(obj, img);   // content-sized: shrinks about its centre
+        applied++;
+    }
+    if (applied > 0) fprintf(stderr, "[Assets] %d image widgets use pre-transformed variants\n", applied);
+    return applied;
+}
+
+#else
+
+bool AssetPack::load(const char*) {
+    return true;   // fonts and images are linked into the binary
+}
+
+int AssetPack::apply_fixups() {
+    return 0;
+}
+
+#endif
+
+} // namespace cinepi
@@ -112,15 +112,25 @@ void CameraScene::draw_level(float roll_deg) {
 
     // Map roll to y offset (pixels)
     int y_offset = static_cast<int>(roll_deg * 2.0f);
-    lv_obj_set_y(level_bar, y_offset);
 
     // Color: green when level (<2 degrees), yellow when slightly off, red when way off
+    uint32_t color;
     if (roll_deg > -2.0f && roll_deg < 2.0f) {
-        lv_obj_set_style_bg_color(level_bar, lv_color_hex(0x00FF00), 0);
+        color = 0x00FF00;
     } else if (roll_deg > -10.0f && roll_deg < 10.0f) {
-        lv_obj_set_style_bg_color(level_bar, lv_color_hex(0xFFFF00), 0);
+        color = 0xFFFF00;
     } else {
-        lv_obj_set_style_bg_color(level_bar, lv_color_hex(0xFF0000), 0);
+        color = 0xFF0000;
+    }
+
+    // Only touch LVGL on change so a steady camera does not force redraws
+    if (y_offset != level_y_) {
+        lv_obj_set_y(level_bar, y_offset);
+        level_y_ = y_offset;
+    }
+    if (color != level_color_) {
+        lv_obj_set_style_bg_color(level_bar, lv_color_hex(color), 0);
+        level_color_ = color;
     }
 }
 
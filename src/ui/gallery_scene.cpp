@@ -7,6 +7,9 @@
 #include "ui/gallery_scene.h"
 #include "core/config.h"
 #include "core/constants.h"
+#include "core/trace.h"
+#include "core/jank_detector.h"
+#include "core/metrics.h"
 
 #include "ui.h"
 #include "lvgl/lvgl.h"
@@ -38,12 +41,15 @@ void GalleryScene::init() {
 }
 
 void GalleryScene::enter() {
+    JANK_PHASE("gallery.enter");
     active_ = true;
     load_photo_list();
 
     if (ui_Gallery1 && ui_imagepreview) {
-        // Create image object inside the preview container
-        if (!gallery_img_obj) {
+        // Create image object inside the preview container; the gesture
+        // handler is added once per screen instance
+        bool fresh = !gallery_img_obj;
+        if (fresh) {
             gallery_img_obj = lv_img_create(ui_imagepreview);
             lv_obj_set_align(gallery_img_obj, LV_ALIGN_CENTER);
         }
@@ -58,17 +64,19 @@ void GalleryScene::enter() {
         }
 
         // Add swipe gesture for navigation
-        lv_obj_add_flag(ui_imagepreview, LV_OBJ_FLAG_CLICKABLE);
-        lv_obj_clear_flag(ui_imagepreview, LV_OBJ_FLAG_SCROLLABLE);
-        lv_obj_add_event_cb(ui_imagepreview, [](lv_event_t* e) {
-            auto* self = static_cast<GalleryScene*>(lv_event_get_user_data(e));
-            lv_dir_t dir = lv_indev_get_gesture_dir(lv_indev_get_act());
-            if (dir == LV_DIR_LEFT) {
-                self->next();
-            } else if (dir == LV_DIR_RIGHT) {
-                self->prev();
-            }
-        }, LV_EVENT_GESTURE, this);
+        if (fresh) {
+            lv_obj_add_flag(ui_imagepreview, LV_OBJ_FLAG_CLICKABLE);
+            lv_obj_clear_flag(ui_imagepreview, LV_OBJ_FLAG_SCROLLABLE);
+            lv_obj_add_event_cb(ui_imagepreview, [](lv_event_t* e) {
+                auto* self = static_cast<GalleryScene*>(lv_event_get_user_data(e));
+                lv_dir_t dir = lv_indev_get_gesture_dir(lv_indev_get_act());
+                if (dir == LV_DIR_LEFT) {
+                    self->next();
+                } else if (dir == LV_DIR_RIGHT) {
+                    self->prev();
+                }
+            }, LV_EVENT_GESTURE, this);
+        }
     }
 
     // Start with newest photo
@@ -80,9 +88,17 @@ void GalleryScene::enter() {
 
 void GalleryScene::leave() {
     active_ = false;
+    // The hidden widget must not keep pointing at the freed pixels
+    if (gallery_img_obj) lv_img_set_src(gallery_img_obj, nullptr);
     free_image();
 }
 
+void GalleryScene::release() {
+    free_image();
+    gallery_img_obj = nullptr;
+    gallery_label = nullptr;
+}
+
 void GalleryScene::load_photo_list() {
     photos_.clear();
     auto& cfg = ConfigManager::instance().get();
@@ -119,6 +135,7 @@ void GalleryScene::load_photo_list() {
 }
 
 void GalleryScene::show_current() {
+    JANK_PHASE("gallery.show");
     if (photos_.empty() || current_idx_ >= (int)photos_.size()) {
         if (gallery_label) lv_label_set_text(gallery_label, "No photos");
         return;
@@ -129,7 +146,12 @@ void GalleryScene::show_current() {
     uint8_t* buf = nullptr;
     int w = 0, h = 0;
 
-    if (decode_jpeg_scaled(photos_[current_idx_], GALLERY_THUMB_W, &buf, &w, &h)) {
+    uint64_t t0 = metrics_now_us();
+    bool decoded = decode_jpeg_scaled(photos_[current_idx_], GALLERY_THUMB_W, &buf, &w, &h);
+    JankDetector::instance().note("gallery.decode", photos_[current_idx_].c_str(),
+                                  metrics_now_us() - t0);
+
+    if (decoded) {
         img_buf_ = buf;
         img_w_ = w;
         img_h_ = h;
@@ -172,6 +194,14 @@ void GalleryScene::prev() {
     }
 }
 
+void GalleryScene::step(int n) {
+    if (photos_.empty()) return;
+    int idx = std::min(std::max(current_idx_ + n, 0), (int)photos_.size() - 1);
+    if (idx == current_idx_) return;
+    current_idx_ = idx;
+    show_current();
+}
+
 void GalleryScene::delete_current() {
     if (photos_.empty() || current_idx_ >= (int)photos_.size()) return;
 
@@ -190,6 +220,7 @@ void GalleryScene::delete_current() {
 
 bool GalleryScene::decode_jpeg_scaled(const std::string& path, int target_w,
                                        uint8_t** out_buf, int* out_w, int* out_h) {
+    TRACE_SCOPE("gallery.decode_jpeg_scaled");
     FILE* fp = fopen(path.c_str(), "rb");
     if (!fp) return false;
 
@@ -301,6 +332,10 @@ bool GalleryScene::decode_jpeg_scaled(const std::string& path, int target_w,
     return true;
 }
 
+size_t GalleryScene::image_bytes() const {
+    return img_buf_ ? static_cast<size_t>(img_w_) * img_h_ * sizeof(lv_color_t) : 0;
+}
+
 void GalleryScene::free_image() {
     if (img_buf_) {
         free(img_buf_);
@@ -7,6 +7,8 @@
 #include "drivers/drm_display.h"
 #include "drivers/touch_input.h"
 #include "core/constants.h"
+#include "core/metrics.h"
+#include "core/trace.h"
 
 #include "lvgl/lvgl.h"
 
@@ -14,6 +16,7 @@
 #include <cstdio>
 #include <cstdlib>
 #include <chrono>
+#include <cstdint>
 
 namespace cinepi {
 
@@ -23,6 +26,13 @@ static TouchInput* g_touch = nullptr;
 
 static uint64_t g_start_ms = 0;
 
+// Keep reading the touch panel for this long after the last evdev event so
+// LVGL sees the release and can finish scroll throws / gesture detection.
+static constexpr uint64_t kInputTailMs = 300;
+
+static Histogram& g_flush_time = Metrics::instance().histogram(
+    "cinepi_lvgl_flush_seconds", "LVGL flush_cb: convert + copy into the UI buffer");
+
 static uint64_t get_ms() {
     using namespace std::chrono;
     return duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
@@ -58,6 +68,7 @@ bool LvglDriver::init(DrmDisplay& display, TouchInput* touch) {
     // Display driver
     static lv_disp_draw_buf_t draw_buf;
     lv_disp_draw_buf_init(&draw_buf, buf1_, buf2_, buf_size);
+    draw_buf_bytes_ = 2 * buf_size * sizeof(lv_color_t);
 
     static lv_disp_drv_t disp_drv;
     lv_disp_drv_init(&disp_drv);
@@ -67,7 +78,7 @@ bool LvglDriver::init(DrmDisplay& display, TouchInput* touch) {
     // Use reinterpret_cast to handle void* -> typedef* conversion
     disp_drv.flush_cb = reinterpret_cast<decltype(disp_drv.flush_cb)>(LvglDriver::flush_cb);
     disp_drv.user_data = this;
-    lv_disp_drv_register(&disp_drv);
+    disp_ = lv_disp_drv_register(&disp_drv);
 
     // Input driver (touch)
     static lv_indev_drv_t indev_drv;
@@ -75,7 +86,14 @@ bool LvglDriver::init(DrmDisplay& display, TouchInput* touch) {
     indev_drv.type = LV_INDEV_TYPE_POINTER;
     indev_drv.read_cb = reinterpret_cast<decltype(indev_drv.read_cb)>(LvglDriver::input_read_cb);
     indev_drv.user_data = this;
-    lv_indev_drv_register(&indev_drv);
+    lv_indev_t* indev = lv_indev_drv_register(&indev_drv);
+    indev_ = indev;
+
+    // Event-driven input: the read timer only runs while the evdev fd
+    // reports activity (see notify_input()), not every 30 ms forever.
+    if (indev && indev->driver->read_timer) {
+        lv_timer_pause(indev->driver->read_timer);
+    }
 
     initialized_ = true;
     fprintf(stderr, "[LVGL] Initialized (%dx%d, buf=%d lines)\n",
@@ -88,12 +106,80 @@ void LvglDriver::deinit() {
     if (buf2_) { free(buf2_); buf2_ = nullptr; }
     g_display = nullptr;
     g_touch = nullptr;
+    disp_ = nullptr;
+    indev_ = nullptr;
     initialized_ = false;
 }
 
-void LvglDriver::tick() {
-    if (!initialized_ || paused_) return;
-    lv_timer_handler();
+uint32_t LvglDriver::tick() {
+    if (!initialized_ || paused_) return UINT32_MAX;
+
+    update_activity(get_ms());
+    tick_count_++;
+
+    // LVGL 8.3 pauses its display refresh timer when nothing is invalidated
+    // and resumes it from _lv_inv_area(), so with the read timer parked the
+    // return value is "ms until the next animation/refresh step" or
+    // LV_NO_TIMER_READY for a fully static screen.
+    uint32_t next = lv_timer_handler();
+    return next == LV_NO_TIMER_READY ? UINT32_MAX : next;
+}
+
+size_t LvglDriver::heap_used() const {
+    if (!initialized_) return 0;
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    return mon.total_size - mon.free_size;
+}
+
+size_t LvglDriver::heap_total() const {
+    if (!initialized_) return 0;
+    lv_mem_monitor_t mon;
+    lv_mem_monitor(&mon);
+    return mon.total_size;
+}
+
+void LvglDriver::notify_input() {
+    if (!initialized_) return;
+    last_input_ms_ = get_ms();
+
+    auto* indev = static_cast<lv_indev_t*>(indev_);
+    if (!input_polling_ && indev && indev->driver->read_timer) {
+        lv_timer_resume(indev->driver->read_timer);
+        lv_timer_ready(indev->driver->read_timer);
+        input_polling_ = true;
+    }
+}
+
+void LvglDriver::set_panel_rate(int hz) {
+    if (hz <= 0) return;
+    panel_period_ms_ = 1000 / hz;
+    if (panel_period_ms_ < 1) panel_period_ms_ = 1;
+}
+
+void LvglDriver::update_activity(uint64_t now) {
+    auto* disp  = static_cast<lv_disp_t*>(disp_);
+    auto* indev = static_cast<lv_indev_t*>(indev_);
+
+    bool touching = touch_ && touch_->read().pressed;
+    bool input_tail = (now - last_input_ms_) < kInputTailMs;
+
+    // Park the read timer once the finger is gone and LVGL has seen it
+    if (input_polling_ && !touching && !input_tail && indev && indev->driver->read_timer) {
+        lv_timer_pause(indev->driver->read_timer);
+        input_polling_ = false;
+    }
+
+    bool active = touching || input_tail || lv_anim_count_running() > 0;
+    if (active == active_) return;
+    active_ = active;
+
+    // Panel rate only while something moves; otherwise the configured
+    // LV_DISP_DEF_REFR_PERIOD applies to the (mostly paused) refresh timer.
+    uint32_t refr = active ? panel_period_ms_ : LV_DISP_DEF_REFR_PERIOD;
+    uint32_t read = active ? panel_period_ms_ : LV_INDEV_DEF_READ_PERIOD;
+    if (disp && disp->refr_timer) lv_timer_set_period(disp->refr_timer, refr);
+    if (indev && indev->driver->read_timer) lv_timer_set_period(indev->driver->read_timer, read);
 }
 
 void LvglDriver::pause() {
@@ -108,6 +194,8 @@ void LvglDriver::flush_cb(void* drv_void, const void* area_void, void* color_p_v
     auto* drv = reinterpret_cast<lv_disp_drv_t*>(drv_void);
     auto* area = reinterpret_cast<const lv_area_t*>(area_void);
     auto* color_p = reinterpret_cast<lv_color_t*>(color_p_void);
+    ScopedLatency flush_timer(g_flush_time);
+    TRACE_SCOPE("lvgl.flush_cb");
     if (!g_display) {
         lv_disp_flush_ready(drv);
         return;
@@ -155,6 +243,7 @@ void LvglDriver::flush_cb(void* drv_void, const void* area_void, void* color_p_v
         }
     }
 
+    g_display->mark_ui_dirty(area->x1, area->y1, area->x2, area->y2);
     lv_disp_flush_ready(drv);
 }
 
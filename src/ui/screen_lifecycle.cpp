@@ -0,0 +1,155 @@
+/**
+ * CinePi Camera - Screen Lifecycle
+ * Screen creation happens inside SquareLine's click handlers, so it is
+ * noticed here right after that LVGL tick; a screen load animates for 50 ms,
+ * which leaves time to apply the asset fixups before its first frame.
+ */
+
+#include "ui/screen_lifecycle.h"
+#include "ui/lvgl_driver.h"
+#include "ui/asset_pack.h"
+#include "core/constants.h"
+#include "core/metrics.h"
+
+#include "ui.h"
+#include "lvgl/lvgl.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+namespace cinepi {
+
+static Counter& g_screen_builds = Metrics::instance().counter(
+    "cinepi_ui_screen_builds_total", "SquareLine screens created (first visit or rebuilt)");
+static Counter& g_screen_destroys = Metrics::instance().counter(
+    "cinepi_ui_screen_destroys_total", "Hidden screens destroyed to free LVGL heap");
+
+ScreenLifecycle& ScreenLifecycle::instance() {
+    static ScreenLifecycle inst;
+    return inst;
+}
+
+void ScreenLifecycle::init_home() {
+    // ui_init() minus the screens that are not shown at boot
+    lv_disp_t* disp = lv_disp_get_default();
+    lv_theme_t* theme = lv_theme_default_init(disp, lv_palette_main(LV_PALETTE_BLUE),
+                                              lv_palette_main(LV_PALETTE_RED), true,
+                                              LV_FONT_DEFAULT);
+    lv_disp_set_theme(disp, theme);
+    lv_mem_monitor_t before, after;
+    lv_mem_monitor(&before);
+    ui_main_screen_init();
+    lv_mem_monitor(&after);
+    size_t used_before = before.total_size - before.free_size;
+    size_t used_after = after.total_size - after.free_size;
+    home_heap_ = used_after > used_before ? used_after - used_before : 0;
+    ui____initial_actions0 = lv_obj_create(NULL);
+    lv_disp_load_scr(ui_main);
+}
+
+void ScreenLifecycle::add(const char* name, _lv_obj_t** obj, void (*destroy)(), bool resident,
+                          std::function<void()> on_destroy) {
+    Screen s;
+    s.name = name;
+    s.obj = obj;
+    s.destroy = destroy;
+    s.resident = resident;
+    s.on_destroy = std::move(on_destroy);
+    s.live = *obj != nullptr;
+    s.builds = s.live ? 1 : 0;
+    s.entered = s.live;
+    if (obj == &ui_main) s.heap_bytes = home_heap_;
+    s.heap_gauge = &Metrics::instance().gauge(
+        std::string("cinepi_ui_screen_heap_bytes{screen=\"") + name + "\"}",
+        "LVGL heap taken by the screen's last build");
+    s.heap_gauge->set(static_cast<double>(s.heap_bytes));
+    screens_.push_back(std::move(s));
+}
+
+void ScreenLifecycle::update(uint64_t now_us) {
+    if (!lvgl_) return;
+    lv_disp_t* disp = lv_disp_get_default();
+    lv_obj_t* act = lv_scr_act();
+    size_t used = lvgl_->heap_used();
+
+    for (auto& s : screens_) {
+        lv_obj_t* obj = *s.obj;
+        if (!obj) s.live = false;
+        if (obj && (obj == act || obj == disp->scr_to_load)) s.last_active_us = now_us;
+    }
+
+    bool pressure = used * 100 > lvgl_->heap_total() * UI_HEAP_PRESSURE_PCT;
+    const uint64_t idle_us = static_cast<uint64_t>(SCREEN_IDLE_DESTROY_SEC) * 1000000;
+    for (auto& s : screens_) {
+        lv_obj_t* obj = *s.obj;
+        if (s.resident || !obj) continue;
+        // Never pull a screen out from under a load animation
+        if (obj == act || obj == disp->scr_to_load || obj == disp->prev_scr) continue;
+        if (pressure) destroy(s, "heap pressure");
+        else if (now_us - s.last_active_us > idle_us) destroy(s, "idle");
+    }
+}
+
+void ScreenLifecycle::begin_tick() {
+    if (lvgl_) tick_heap_ = lvgl_->heap_used();
+}
+
+void ScreenLifecycle::end_tick(uint64_t now_us) {
+    if (!lvgl_) return;
+    size_t used = 0;
+    for (auto& s : screens_) {
+        if (!*s.obj || s.live) continue;
+        if (!used) used = lvgl_->heap_used();
+        s.live = true;
+        s.entered = false;
+        s.builds++;
+        s.last_active_us = now_us;
+        s.heap_bytes = used > tick_heap_ ? used - tick_heap_ : 0;
+        s.heap_gauge->set(static_cast<double>(s.heap_bytes));
+        g_screen_builds.inc();
+        AssetPack::instance().apply_fixups();
+        fprintf(stderr, "[Screens] Built %s (%zu KB LVGL heap)\n", s.name, s.heap_bytes / 1024);
+    }
+}
+
+void ScreenLifecycle::begin_enter() {
+    if (lvgl_) enter_heap_ = lvgl_->heap_used();
+}
+
+void ScreenLifecycle::end_enter(lv_obj_t* screen) {
+    if (!lvgl_ || !screen) return;
+    for (auto& s : screens_) {
+        if (*s.obj != screen || s.entered) continue;
+        s.entered = true;
+        size_t used = lvgl_->heap_used();
+        size_t grown = used > enter_heap_ ? used - enter_heap_ : 0;
+        if (grown == 0) return;
+        s.heap_bytes += grown;
+        s.heap_gauge->set(static_cast<double>(s.heap_bytes));
+        fprintf(stderr, "[Screens] Entered %s (+%zu KB, %zu KB LVGL heap)\n", s.name,
+                grown / 1024, s.heap_bytes / 1024);
+        return;
+    }
+}
+
+void ScreenLifecycle::destroy(Screen& s, const char* why) {
+    size_t before = lvgl_->heap_used();
+    if (s.on_destroy) s.on_destroy();
+    s.destroy();
+    s.live = false;
+    g_screen_destroys.inc();
+    size_t after = lvgl_->heap_used();
+    fprintf(stderr, "[Screens] Destroyed %s (%s): freed %zu KB, built %zu KB\n", s.name, why,
+            before > after ? (before - after) / 1024 : 0, s.heap_bytes / 1024);
+}
+
+void ScreenLifecycle::report() const {
+    for (const auto& s : screens_) {
+        fprintf(stderr, "[Screens]   %-9s %-9s built %u x, heap %zu KB\n", s.name,
+                s.resident ? "resident" : (s.live ? "live" : "released"),
+                s.builds, s.heap_bytes / 1024);
+    }
+}
+
+} // namespace cinepi
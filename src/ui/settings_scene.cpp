@@ -5,8 +5,10 @@
 
 #include "ui/settings_scene.h"
 #include "drivers/drm_display.h"
+#include "drivers/backlight.h"
 #include "core/config.h"
 #include "core/constants.h"
+#include "core/jank_detector.h"
 
 #include "ui.h"
 #include "lvgl/lvgl.h"
@@ -31,13 +33,7 @@ static void brightness_changed_cb(lv_event_t* e) {
     int val = lv_slider_get_value(static_cast<lv_obj_t*>(lv_event_get_target(e)));
     auto& cfg = ConfigManager::instance().get();
     cfg.display.brightness = val;
-
-    // Write to backlight immediately
-    FILE* fp = fopen(BACKLIGHT_BRIGHTNESS, "w");
-    if (fp) {
-        fprintf(fp, "%d", val);
-        fclose(fp);
-    }
+    Backlight::instance().set_level(val);   // coalesced, faded
 }
 
 static void standby_changed_cb(lv_event_t* e) {
@@ -99,6 +95,7 @@ void SettingsScene::init() {
 }
 
 void SettingsScene::enter() {
+    JANK_PHASE("settings.enter");
     if (!initialized_ && ui_settings1) {
         create_settings_ui();
         initialized_ = true;
@@ -127,6 +124,12 @@ void SettingsScene::leave() {
     ConfigManager::instance().save();
 }
 
+void SettingsScene::release() {
+    settings_list = brightness_slider = standby_dropdown = nullptr;
+    used_label = free_label = wb_dropdown = colour_slider = clock_switch = nullptr;
+    initialized_ = false;
+}
+
 void SettingsScene::create_settings_ui() {
     auto& cfg = ConfigManager::instance().get();
 